@@ -4,10 +4,13 @@
 #include "target.h"
 
 extern const unsigned char EditorFont_sparse_font_data[];
+static_assert(object::ID_sparse_font >= 0x80 &&
+              object::ID_sparse_font < 0x4000,
+              "Font type ID must be encoded on two bytes");
 const unsigned char EditorFont_sparse_font_data[73676] FONT_QSPI =
 {
 
-    0x96, 0x02, 0xC7, 0xBF, 0x04, 0x36, 0x00, 0x01, 0x00, 0x2C, 0x01, 0x01, 0x00, 0x00, 0x0D, 0x01,
+    FONT_TYPE_ID(object::ID_sparse_font), 0xC7, 0xBF, 0x04, 0x36, 0x00, 0x01, 0x00, 0x2C, 0x01, 0x01, 0x00, 0x00, 0x0D, 0x01,
     0x00, 0x2C, 0x01, 0x01, 0x08, 0x00, 0x20, 0x5F, 0x00, 0x2C, 0x01, 0x01, 0x08, 0x00, 0x02, 0x0B,
     0x05, 0x21, 0x09, 0xEF, 0xBD, 0xF7, 0xDE, 0x7B, 0xEF, 0xBD, 0xF7, 0xDE, 0x7B, 0xEF, 0xBD, 0xF7,
     0x1E, 0x00, 0x00, 0xB8, 0xFF, 0xFF, 0xFF, 0x0E, 0x03, 0x0B, 0x0B, 0x0F, 0x11, 0x8F, 0x7F, 0xFC,
@@ -4613,3 +4616,244 @@ const unsigned char EditorFont_sparse_font_data[73676] FONT_QSPI =
     0x03, 0x1E, 0xE0, 0xF1, 0x01, 0x00, 0x00, 0x78, 0x00, 0x00, 0x00, 0x18, 0x00, 0x00, 0x00, 0x00,
     0x00, 0x0A, 0x45, 0x64, 0x69, 0x74, 0x6F, 0x72, 0x46, 0x6F, 0x6E, 0x74,
 };
+
+static const font_offsets::range EditorFont_sparse_font_ranges[119] FONT_QSPI =
+{
+    { 0, 1, 0 },
+    { 13, 1, 1 },
+    { 32, 95, 2 },
+    { 160, 224, 97 },
+    { 402, 1, 321 },
+    { 416, 2, 322 },
+    { 431, 2, 324 },
+    { 461, 16, 326 },
+    { 506, 6, 342 },
+    { 536, 4, 348 },
+    { 567, 1, 352 },
+    { 704, 1, 353 },
+    { 710, 2, 354 },
+    { 713, 1, 356 },
+    { 728, 6, 357 },
+    { 768, 5, 363 },
+    { 774, 5, 368 },
+    { 780, 1, 373 },
+    { 803, 1, 374 },
+    { 884, 2, 375 },
+    { 894, 1, 377 },
+    { 900, 7, 378 },
+    { 908, 1, 385 },
+    { 910, 20, 386 },
+    { 931, 44, 406 },
+    { 1024, 96, 450 },
+    { 1168, 2, 546 },
+    { 7808, 6, 548 },
+    { 7838, 1, 554 },
+    { 7840, 90, 555 },
+    { 8194, 6, 645 },
+    { 8208, 1, 651 },
+    { 8211, 3, 652 },
+    { 8215, 8, 655 },
+    { 8224, 3, 663 },
+    { 8230, 1, 666 },
+    { 8240, 1, 667 },
+    { 8242, 2, 668 },
+    { 8249, 2, 670 },
+    { 8252, 3, 672 },
+    { 8260, 1, 675 },
+    { 8287, 1, 676 },
+    { 8304, 1, 677 },
+    { 8307, 7, 678 },
+    { 8315, 1, 685 },
+    { 8319, 11, 686 },
+    { 8355, 2, 697 },
+    { 8359, 1, 699 },
+    { 8363, 2, 700 },
+    { 8377, 2, 702 },
+    { 8381, 1, 704 },
+    { 8450, 1, 705 },
+    { 8453, 1, 706 },
+    { 8467, 1, 707 },
+    { 8470, 1, 708 },
+    { 8481, 2, 709 },
+    { 8486, 1, 711 },
+    { 8494, 1, 712 },
+    { 8520, 1, 713 },
+    { 8539, 4, 714 },
+    { 8544, 16, 718 },
+    { 8592, 6, 734 },
+    { 8616, 1, 740 },
+    { 8644, 1, 741 },
+    { 8706, 1, 742 },
+    { 8710, 1, 743 },
+    { 8719, 1, 744 },
+    { 8721, 2, 745 },
+    { 8725, 1, 747 },
+    { 8729, 4, 748 },
+    { 8734, 4, 752 },
+    { 8745, 1, 756 },
+    { 8747, 1, 757 },
+    { 8776, 1, 758 },
+    { 8800, 2, 759 },
+    { 8804, 2, 761 },
+    { 8895, 1, 763 },
+    { 8962, 1, 764 },
+    { 8976, 1, 765 },
+    { 8992, 2, 766 },
+    { 9472, 1, 768 },
+    { 9474, 1, 769 },
+    { 9484, 1, 770 },
+    { 9488, 1, 771 },
+    { 9492, 1, 772 },
+    { 9496, 1, 773 },
+    { 9500, 1, 774 },
+    { 9508, 1, 775 },
+    { 9516, 1, 776 },
+    { 9524, 1, 777 },
+    { 9532, 1, 778 },
+    { 9552, 29, 779 },
+    { 9600, 1, 808 },
+    { 9604, 1, 809 },
+    { 9608, 1, 810 },
+    { 9612, 1, 811 },
+    { 9616, 4, 812 },
+    { 9632, 2, 816 },
+    { 9642, 3, 818 },
+    { 9650, 1, 821 },
+    { 9654, 1, 822 },
+    { 9658, 1, 823 },
+    { 9660, 1, 824 },
+    { 9664, 1, 825 },
+    { 9668, 1, 826 },
+    { 9674, 2, 827 },
+    { 9679, 1, 829 },
+    { 9688, 2, 830 },
+    { 9698, 5, 832 },
+    { 9786, 3, 837 },
+    { 9792, 1, 840 },
+    { 9794, 1, 841 },
+    { 9824, 1, 842 },
+    { 9827, 1, 843 },
+    { 9829, 2, 844 },
+    { 9834, 2, 846 },
+    { 61441, 2, 848 },
+    { 63171, 1, 850 },
+    { 64256, 5, 851 },
+};
+
+static const uint32_t EditorFont_sparse_font_glyphs[856] FONT_QSPI =
+{
+    8, 16, 24, 30, 56, 82, 174, 258,
+    416, 518, 531, 592, 653, 694, 769, 785,
+    799, 809, 897, 981, 1028, 1106, 1186, 1274,
+    1354, 1434, 1514, 1598, 1678, 1699, 1724, 1799,
+    1847, 1922, 2000, 2163, 2259, 2339, 2432, 2516,
+    2587, 2658, 2751, 2835, 2886, 2947, 3031, 3098,
+    3198, 3282, 3375, 3451, 3564, 3644, 3728, 3812,
+    3902, 3994, 4123, 4215, 4307, 4383, 4433, 4508,
+    4554, 4602, 4612, 4626, 4685, 4764, 4820, 4899,
+    4958, 5019, 5096, 5173, 5201, 5264, 5337, 5374,
+    5464, 5521, 5584, 5661, 5738, 5779, 5832, 5888,
+    5945, 6004, 6091, 6153, 6237, 6286, 6358, 6382,
+    6449, 6480, 6486, 6514, 6591, 6677, 6733, 6825,
+    6853, 6946, 6961, 7099, 7126, 7195, 7245, 7259,
+    7397, 7409, 7435, 7533, 7573, 7610, 7624, 7699,
+    7802, 7812, 7830, 7856, 7886, 7955, 8109, 8263,
+    8417, 8499, 8631, 8763, 8895, 9027, 9156, 9291,
+    9416, 9531, 9628, 9725, 9822, 9913, 9982, 10051,
+    10120, 10190, 10286, 10398, 10521, 10644, 10767, 10890,
+    11008, 11083, 11191, 11314, 11437, 11560, 11678, 11804,
+    11880, 11961, 12044, 12127, 12210, 12293, 12372, 12457,
+    12554, 12631, 12714, 12797, 12880, 12959, 12993, 13036,
+    13089, 13148, 13234, 13315, 13403, 13491, 13579, 13667,
+    13751, 13826, 13895, 13978, 14061, 14144, 14223, 14328,
+    14425, 14534, 14652, 14729, 14858, 14939, 15063, 15140,
+    15263, 15342, 15465, 15544, 15662, 15737, 15860, 15939,
+    16054, 16166, 16262, 16355, 16446, 16523, 16618, 16699,
+    16790, 16869, 16960, 17037, 17134, 17217, 17340, 17441,
+    17561, 17658, 17776, 17873, 17996, 18101, 18216, 18313,
+    18417, 18503, 18589, 18651, 18716, 18765, 18838, 18894,
+    18959, 19005, 19070, 19088, 19200, 19292, 19397, 19462,
+    19579, 19684, 19738, 19830, 19891, 19985, 20040, 20107,
+    20166, 20233, 20297, 20377, 20427, 20542, 20623, 20740,
+    20825, 20940, 21021, 21124, 21232, 21309, 21424, 21506,
+    21626, 21712, 21835, 21928, 22065, 22168, 22277, 22335,
+    22446, 22516, 22625, 22687, 22798, 22872, 22983, 23057,
+    23161, 23229, 23340, 23414, 23522, 23585, 23700, 23770,
+    23854, 23910, 24033, 24116, 24231, 24308, 24428, 24509,
+    24634, 24719, 24842, 24935, 25048, 25123, 25301, 25430,
+    25556, 25663, 25781, 25884, 25956, 26053, 26121, 26224,
+    26296, 26360, 26472, 26594, 26682, 26804, 26892, 27024,
+    27107, 27176, 27229, 27352, 27440, 27563, 27646, 27776,
+    27865, 28000, 28093, 28228, 28321, 28456, 28552, 28686,
+    28791, 28963, 29100, 29234, 29327, 29438, 29512, 29629,
+    29706, 29741, 29817, 29836, 29858, 29873, 29890, 29899,
+    29915, 29932, 29951, 29975, 29983, 29994, 30005, 30017,
+    30029, 30040, 30048, 30059, 30069, 30081, 30095, 30107,
+    30118, 30132, 30160, 30174, 30197, 30297, 30307, 30407,
+    30520, 30603, 30725, 30842, 30958, 31027, 31123, 31203,
+    31274, 31366, 31437, 31513, 31597, 31699, 31750, 31834,
+    31926, 32026, 32110, 32177, 32270, 32354, 32433, 32509,
+    32593, 32685, 32797, 32889, 32984, 33074, 33144, 33262,
+    33367, 33448, 33547, 33600, 33683, 33759, 33862, 33940,
+    34031, 34090, 34176, 34251, 34335, 34370, 34425, 34518,
+    34591, 34653, 34739, 34802, 34879, 34959, 35030, 35100,
+    35161, 35218, 35342, 35431, 35560, 35653, 35712, 35789,
+    35875, 35956, 36088, 36185, 36276, 36372, 36469, 36562,
+    36646, 36697, 36767, 36829, 36979, 37112, 37204, 37313,
+    37428, 37552, 37647, 37746, 37826, 37906, 37977, 38090,
+    38161, 38282, 38366, 38450, 38560, 38640, 38739, 38839,
+    38923, 39016, 39102, 39178, 39271, 39355, 39448, 39558,
+    39650, 39760, 39840, 39960, 40115, 40224, 40337, 40419,
+    40512, 40644, 40724, 40783, 40874, 40929, 40975, 41058,
+    41117, 41201, 41257, 41312, 41389, 41444, 41505, 41570,
+    41625, 41688, 41743, 41818, 41874, 41933, 42011, 42135,
+    42197, 42272, 42327, 42407, 42513, 42584, 42658, 42710,
+    42766, 42859, 42914, 42997, 43074, 43192, 43259, 43315,
+    43368, 43395, 43453, 43492, 43588, 43675, 43766, 43847,
+    43928, 44029, 44101, 44176, 44238, 44416, 44545, 44723,
+    44852, 45024, 45154, 45259, 45388, 45465, 45594, 45675,
+    45818, 45928, 46059, 46148, 46285, 46382, 46530, 46625,
+    46782, 46881, 47024, 47117, 47260, 47353, 47504, 47603,
+    47754, 47851, 48005, 48102, 48193, 48270, 48365, 48446,
+    48543, 48626, 48751, 48861, 48974, 49069, 49181, 49283,
+    49392, 49487, 49602, 49701, 49768, 49806, 49871, 49905,
+    50020, 50102, 50222, 50308, 50451, 50561, 50698, 50798,
+    50931, 51033, 51171, 51272, 51415, 51520, 51678, 51791,
+    51949, 52062, 52217, 52327, 52485, 52598, 52746, 52853,
+    52966, 53041, 53161, 53242, 53400, 53513, 53671, 53784,
+    53939, 54049, 54207, 54320, 54468, 54575, 54701, 54806,
+    54924, 55004, 55122, 55233, 55348, 55462, 55468, 55474,
+    55480, 55486, 55492, 55501, 55518, 55534, 55561, 55591,
+    55612, 55628, 55645, 55661, 55676, 55706, 55738, 55771,
+    55880, 55977, 56003, 56036, 56260, 56275, 56310, 56350,
+    56396, 56467, 56551, 56564, 56617, 56626, 56669, 56776,
+    56818, 56858, 56898, 56938, 56978, 57021, 57034, 57063,
+    57103, 57129, 57169, 57206, 57248, 57288, 57328, 57368,
+    57408, 57451, 57531, 57620, 57807, 57907, 58012, 58094,
+    58175, 58262, 58362, 58513, 58586, 58747, 58947, 59011,
+    59104, 59196, 59257, 59411, 59565, 59719, 59876, 59927,
+    60027, 60173, 60306, 60398, 60531, 60714, 60942, 61084,
+    61176, 61313, 61500, 61567, 61660, 61744, 61847, 61915,
+    61985, 62053, 62123, 62191, 62264, 62341, 62458, 62554,
+    62652, 62762, 62865, 62886, 62960, 62970, 63063, 63156,
+    63257, 63320, 63475, 63638, 63798, 63890, 63972, 64033,
+    64123, 64196, 64284, 64375, 64550, 64611, 64662, 64702,
+    64753, 64774, 64805, 64869, 64929, 64993, 65053, 65166,
+    65272, 65380, 65488, 65684, 65733, 65813, 65885, 65962,
+    66053, 66120, 66197, 66283, 66353, 66430, 66519, 66585,
+    66662, 66746, 66856, 66996, 67136, 67239, 67372, 67505,
+    67629, 67734, 67858, 67979, 68084, 68205, 68398, 68591,
+    68790, 68892, 68994, 69190, 69288, 69391, 69560, 69744,
+    69940, 69991, 70045, 70061, 70077, 70111, 70224, 70307,
+    70428, 70541, 70624, 70745, 70829, 70879, 70927, 70983,
+    71058, 71212, 71379, 71542, 71705, 71726, 71817, 71904,
+    72092, 72206, 72344, 72416, 72503, 72582, 72649, 72727,
+    72846, 72935, 73044, 73062, 73174, 73263, 73363, 73503,
+};
+
+extern const font_offsets EditorFont_sparse_font_offsets;
+const font_offsets EditorFont_sparse_font_offsets =
+{
+    EditorFont_sparse_font_ranges, 119,
+    EditorFont_sparse_font_glyphs, 856
+};
@@ -4,10 +4,13 @@
 #include "target.h"
 
 extern const unsigned char HelpFont_sparse_font_data[];
+static_assert(object::ID_sparse_font >= 0x80 &&
+              object::ID_sparse_font < 0x4000,
+              "Font type ID must be encoded on two bytes");
 const unsigned char HelpFont_sparse_font_data[15010] FONT_QSPI =
 {
 
-    0x96, 0x02, 0x9E, 0x75, 0x14, 0x00, 0x01, 0x00, 0x11, 0x01, 0x01, 0x00, 0x00, 0x0D, 0x01, 0x00,
+    FONT_TYPE_ID(object::ID_sparse_font), 0x9E, 0x75, 0x14, 0x00, 0x01, 0x00, 0x11, 0x01, 0x01, 0x00, 0x00, 0x0D, 0x01, 0x00,
     0x11, 0x01, 0x01, 0x03, 0x00, 0x20, 0x5F, 0x00, 0x11, 0x01, 0x01, 0x03, 0x00, 0x01, 0x04, 0x02,
     0x0D, 0x04, 0xFF, 0xFF, 0xF3, 0x03, 0x01, 0x04, 0x04, 0x05, 0x06, 0xFF, 0xFF, 0x0F, 0x01, 0x04,
     0x08, 0x0D, 0x0A, 0x12, 0x12, 0x14, 0x7F, 0x7F, 0x24, 0x24, 0x24, 0xFE, 0xFE, 0x28, 0x48, 0x48,
@@ -947,3 +950,244 @@ const unsigned char HelpFont_sparse_font_data[15010] FONT_QSPI =
     0x66, 0x66, 0x66, 0x76, 0x66, 0x02, 0x00, 0x00, 0x00, 0x08, 0x48, 0x65, 0x6C, 0x70, 0x46, 0x6F,
     0x6E, 0x74,
 };
+
+static const font_offsets::range HelpFont_sparse_font_ranges[119] FONT_QSPI =
+{
+    { 0, 1, 0 },
+    { 13, 1, 1 },
+    { 32, 95, 2 },
+    { 160, 224, 97 },
+    { 402, 1, 321 },
+    { 416, 2, 322 },
+    { 431, 2, 324 },
+    { 461, 16, 326 },
+    { 506, 6, 342 },
+    { 536, 4, 348 },
+    { 567, 1, 352 },
+    { 704, 1, 353 },
+    { 710, 2, 354 },
+    { 713, 1, 356 },
+    { 728, 6, 357 },
+    { 768, 5, 363 },
+    { 774, 5, 368 },
+    { 780, 1, 373 },
+    { 803, 1, 374 },
+    { 884, 2, 375 },
+    { 894, 1, 377 },
+    { 900, 7, 378 },
+    { 908, 1, 385 },
+    { 910, 20, 386 },
+    { 931, 44, 406 },
+    { 1024, 96, 450 },
+    { 1168, 2, 546 },
+    { 7808, 6, 548 },
+    { 7838, 1, 554 },
+    { 7840, 90, 555 },
+    { 8194, 6, 645 },
+    { 8208, 1, 651 },
+    { 8211, 3, 652 },
+    { 8215, 8, 655 },
+    { 8224, 3, 663 },
+    { 8230, 1, 666 },
+    { 8240, 1, 667 },
+    { 8242, 2, 668 },
+    { 8249, 2, 670 },
+    { 8252, 3, 672 },
+    { 8260, 1, 675 },
+    { 8287, 1, 676 },
+    { 8304, 1, 677 },
+    { 8307, 7, 678 },
+    { 8315, 1, 685 },
+    { 8319, 11, 686 },
+    { 8355, 2, 697 },
+    { 8359, 1, 699 },
+    { 8363, 2, 700 },
+    { 8377, 2, 702 },
+    { 8381, 1, 704 },
+    { 8450, 1, 705 },
+    { 8453, 1, 706 },
+    { 8467, 1, 707 },
+    { 8470, 1, 708 },
+    { 8481, 2, 709 },
+    { 8486, 1, 711 },
+    { 8494, 1, 712 },
+    { 8520, 1, 713 },
+    { 8539, 4, 714 },
+    { 8544, 16, 718 },
+    { 8592, 6, 734 },
+    { 8616, 1, 740 },
+    { 8644, 1, 741 },
+    { 8706, 1, 742 },
+    { 8710, 1, 743 },
+    { 8719, 1, 744 },
+    { 8721, 2, 745 },
+    { 8725, 1, 747 },
+    { 8729, 4, 748 },
+    { 8734, 4, 752 },
+    { 8745, 1, 756 },
+    { 8747, 1, 757 },
+    { 8776, 1, 758 },
+    { 8800, 2, 759 },
+    { 8804, 2, 761 },
+    { 8895, 1, 763 },
+    { 8962, 1, 764 },
+    { 8976, 1, 765 },
+    { 8992, 2, 766 },
+    { 9472, 1, 768 },
+    { 9474, 1, 769 },
+    { 9484, 1, 770 },
+    { 9488, 1, 771 },
+    { 9492, 1, 772 },
+    { 9496, 1, 773 },
+    { 9500, 1, 774 },
+    { 9508, 1, 775 },
+    { 9516, 1, 776 },
+    { 9524, 1, 777 },
+    { 9532, 1, 778 },
+    { 9552, 29, 779 },
+    { 9600, 1, 808 },
+    { 9604, 1, 809 },
+    { 9608, 1, 810 },
+    { 9612, 1, 811 },
+    { 9616, 4, 812 },
+    { 9632, 2, 816 },
+    { 9642, 3, 818 },
+    { 9650, 1, 821 },
+    { 9654, 1, 822 },
+    { 9658, 1, 823 },
+    { 9660, 1, 824 },
+    { 9664, 1, 825 },
+    { 9668, 1, 826 },
+    { 9674, 2, 827 },
+    { 9679, 1, 829 },
+    { 9688, 2, 830 },
+    { 9698, 5, 832 },
+    { 9786, 3, 837 },
+    { 9792, 1, 840 },
+    { 9794, 1, 841 },
+    { 9824, 1, 842 },
+    { 9827, 1, 843 },
+    { 9829, 2, 844 },
+    { 9834, 2, 846 },
+    { 61441, 2, 848 },
+    { 63171, 1, 850 },
+    { 64256, 5, 851 },
+};
+
+static const uint32_t HelpFont_sparse_font_glyphs[856] FONT_QSPI =
+{
+    7, 15, 23, 29, 38, 46, 64, 82,
+    109, 127, 134, 148, 162, 171, 186, 193,
+    199, 205, 221, 238, 250, 265, 282, 300,
+    317, 334, 351, 368, 385, 393, 401, 417,
+    429, 445, 460, 487, 505, 522, 540, 557,
+    572, 587, 605, 622, 634, 648, 665, 680,
+    700, 717, 735, 752, 774, 792, 809, 826,
+    843, 861, 884, 902, 920, 935, 948, 964,
+    977, 989, 995, 1002, 1015, 1031, 1044, 1060,
+    1073, 1087, 1103, 1119, 1128, 1142, 1158, 1169,
+    1187, 1200, 1214, 1230, 1246, 1258, 1271, 1283,
+    1296, 1309, 1327, 1341, 1359, 1371, 1386, 1395,
+    1410, 1422, 1428, 1437, 1454, 1471, 1483, 1501,
+    1511, 1529, 1536, 1560, 1569, 1585, 1597, 1603,
+    1627, 1633, 1641, 1659, 1669, 1679, 1686, 1702,
+    1724, 1730, 1737, 1745, 1754, 1768, 1798, 1826,
+    1854, 1870, 1893, 1916, 1939, 1962, 1987, 2013,
+    2036, 2058, 2077, 2096, 2115, 2133, 2147, 2161,
+    2175, 2189, 2207, 2227, 2250, 2273, 2296, 2319,
+    2341, 2356, 2376, 2397, 2418, 2439, 2459, 2482,
+    2499, 2515, 2532, 2549, 2566, 2583, 2599, 2616,
+    2635, 2651, 2668, 2685, 2702, 2718, 2727, 2738,
+    2749, 2763, 2781, 2798, 2817, 2836, 2855, 2874,
+    2892, 2907, 2923, 2940, 2957, 2974, 2990, 3009,
+    3028, 3047, 3067, 3083, 3108, 3124, 3146, 3162,
+    3185, 3202, 3225, 3242, 3264, 3280, 3303, 3320,
+    3341, 3362, 3380, 3398, 3416, 3432, 3450, 3466,
+    3484, 3500, 3518, 3534, 3553, 3570, 3593, 3613,
+    3636, 3655, 3677, 3696, 3719, 3739, 3760, 3779,
+    3799, 3817, 3834, 3847, 3861, 3873, 3887, 3901,
+    3915, 3927, 3941, 3949, 3971, 3990, 4009, 4022,
+    4043, 4063, 4076, 4095, 4108, 4127, 4140, 4155,
+    4170, 4185, 4198, 4215, 4227, 4248, 4264, 4287,
+    4304, 4325, 4342, 4362, 4382, 4398, 4420, 4438,
+    4461, 4479, 4502, 4522, 4545, 4564, 4587, 4601,
+    4624, 4639, 4661, 4676, 4697, 4714, 4735, 4752,
+    4772, 4788, 4809, 4826, 4846, 4860, 4881, 4895,
+    4912, 4924, 4945, 4962, 4982, 4998, 5019, 5035,
+    5057, 5074, 5095, 5114, 5134, 5150, 5180, 5204,
+    5226, 5246, 5264, 5283, 5297, 5315, 5329, 5348,
+    5363, 5380, 5404, 5427, 5448, 5471, 5492, 5515,
+    5532, 5546, 5557, 5580, 5599, 5620, 5637, 5659,
+    5676, 5698, 5715, 5738, 5756, 5778, 5798, 5825,
+    5845, 5875, 5901, 5925, 5947, 5968, 5985, 6006,
+    6023, 6035, 6052, 6060, 6071, 6080, 6087, 6093,
+    6100, 6108, 6115, 6126, 6131, 6137, 6143, 6149,
+    6158, 6165, 6171, 6177, 6182, 6191, 6200, 6209,
+    6216, 6225, 6236, 6243, 6251, 6271, 6277, 6297,
+    6319, 6339, 6362, 6385, 6405, 6420, 6438, 6455,
+    6470, 6488, 6503, 6518, 6535, 6553, 6565, 6582,
+    6600, 6620, 6637, 6652, 6670, 6687, 6707, 6722,
+    6739, 6757, 6776, 6794, 6812, 6830, 6844, 6862,
+    6882, 6899, 6918, 6931, 6948, 6963, 6984, 7002,
+    7020, 7033, 7050, 7066, 7084, 7094, 7108, 7127,
+    7143, 7156, 7175, 7189, 7206, 7224, 7240, 7255,
+    7269, 7282, 7305, 7324, 7347, 7365, 7379, 7395,
+    7414, 7431, 7458, 7477, 7495, 7513, 7532, 7549,
+    7566, 7578, 7592, 7606, 7633, 7658, 7676, 7697,
+    7718, 7740, 7757, 7775, 7792, 7809, 7824, 7844,
+    7859, 7884, 7901, 7918, 7938, 7955, 7975, 7995,
+    8012, 8030, 8047, 8064, 8082, 8099, 8117, 8137,
+    8155, 8175, 8192, 8214, 8240, 8262, 8284, 8301,
+    8319, 8342, 8360, 8373, 8392, 8405, 8417, 8434,
+    8447, 8465, 8478, 8491, 8507, 8520, 8534, 8549,
+    8562, 8576, 8589, 8605, 8618, 8631, 8647, 8669,
+    8683, 8699, 8712, 8727, 8747, 8764, 8781, 8794,
+    8806, 8824, 8837, 8854, 8870, 8893, 8907, 8920,
+    8933, 8942, 8956, 8968, 8987, 9005, 9023, 9039,
+    9055, 9074, 9092, 9107, 9124, 9154, 9177, 9207,
+    9230, 9259, 9287, 9308, 9328, 9344, 9369, 9385,
+    9411, 9431, 9452, 9471, 9493, 9510, 9538, 9556,
+    9580, 9599, 9626, 9643, 9670, 9687, 9710, 9729,
+    9757, 9775, 9804, 9823, 9841, 9857, 9875, 9891,
+    9910, 9929, 9952, 9971, 9992, 10009, 10031, 10050,
+    10070, 10088, 10109, 10128, 10142, 10151, 10165, 10175,
+    10197, 10215, 10238, 10256, 10283, 10303, 10330, 10349,
+    10373, 10392, 10417, 10437, 10463, 10484, 10512, 10534,
+    10562, 10584, 10612, 10633, 10661, 10683, 10711, 10732,
+    10754, 10770, 10791, 10807, 10835, 10857, 10885, 10907,
+    10935, 10956, 10984, 11006, 11034, 11055, 11078, 11097,
+    11119, 11135, 11155, 11176, 11195, 11219, 11225, 11231,
+    11237, 11243, 11249, 11258, 11267, 11274, 11283, 11295,
+    11303, 11310, 11317, 11324, 11331, 11340, 11349, 11361,
+    11382, 11403, 11414, 11426, 11464, 11471, 11483, 11494,
+    11507, 11522, 11538, 11547, 11562, 11571, 11584, 11603,
+    11613, 11623, 11633, 11643, 11653, 11666, 11675, 11683,
+    11693, 11701, 11711, 11721, 11731, 11741, 11751, 11761,
+    11771, 11784, 11801, 11821, 11855, 11874, 11897, 11912,
+    11932, 11952, 11974, 12002, 12019, 12048, 12082, 12097,
+    12118, 12138, 12153, 12179, 12207, 12233, 12264, 12276,
+    12296, 12323, 12348, 12366, 12391, 12424, 12464, 12491,
+    12509, 12534, 12567, 12582, 12600, 12617, 12640, 12652,
+    12667, 12679, 12694, 12706, 12724, 12743, 12765, 12786,
+    12807, 12829, 12847, 12857, 12874, 12880, 12898, 12914,
+    12934, 12948, 12976, 13004, 13035, 13055, 13074, 13089,
+    13106, 13123, 13139, 13158, 13188, 13205, 13219, 13230,
+    13246, 13256, 13267, 13283, 13297, 13313, 13327, 13349,
+    13368, 13391, 13414, 13450, 13462, 13476, 13490, 13504,
+    13520, 13532, 13545, 13561, 13575, 13589, 13605, 13617,
+    13630, 13646, 13665, 13687, 13709, 13725, 13747, 13769,
+    13792, 13812, 13835, 13858, 13878, 13901, 13934, 13967,
+    14001, 14023, 14045, 14081, 14103, 14122, 14152, 14185,
+    14222, 14233, 14249, 14256, 14263, 14275, 14298, 14318,
+    14341, 14364, 14384, 14407, 14422, 14436, 14450, 14462,
+    14480, 14508, 14536, 14564, 14592, 14603, 14622, 14638,
+    14670, 14694, 14723, 14742, 14761, 14776, 14793, 14809,
+    14833, 14851, 14875, 14885, 14906, 14924, 14946, 14971,
+};
+
+extern const font_offsets HelpFont_sparse_font_offsets;
+const font_offsets HelpFont_sparse_font_offsets =
+{
+    HelpFont_sparse_font_ranges, 119,
+    HelpFont_sparse_font_glyphs, 856
+};
@@ -4,10 +4,13 @@
 #include "target.h"
 
 extern const unsigned char StackFont_sparse_font_data[];
+static_assert(object::ID_sparse_font >= 0x80 &&
+              object::ID_sparse_font < 0x4000,
+              "Font type ID must be encoded on two bytes");
 const unsigned char StackFont_sparse_font_data[36409] FONT_QSPI =
 {
 
-    0x96, 0x02, 0xB4, 0x9C, 0x02, 0x24, 0x00, 0x01, 0x00, 0x1C, 0x01, 0x01, 0x00, 0x00, 0x0D, 0x01,
+    FONT_TYPE_ID(object::ID_sparse_font), 0xB4, 0x9C, 0x02, 0x24, 0x00, 0x01, 0x00, 0x1C, 0x01, 0x01, 0x00, 0x00, 0x0D, 0x01,
     0x00, 0x1C, 0x01, 0x01, 0x06, 0x00, 0x20, 0x5F, 0x00, 0x1C, 0x01, 0x01, 0x06, 0x00, 0x02, 0x05,
     0x03, 0x17, 0x06, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x1F, 0xC0, 0xFF, 0x1F, 0x02, 0x05, 0x08, 0x0A,
     0x0C, 0xE7, 0xE7, 0xE7, 0xE7, 0xE7, 0xE7, 0xE7, 0xE7, 0xE7, 0xE7, 0x01, 0x05, 0x0E, 0x17, 0x10,
@@ -2284,3 +2287,244 @@ const unsigned char StackFont_sparse_font_data[36409] FONT_QSPI =
     0x70, 0x70, 0x1E, 0x0E, 0xCE, 0xC3, 0xC1, 0x79, 0x00, 0x00, 0x06, 0x00, 0x00, 0x00, 0x00, 0x09,
     0x53, 0x74, 0x61, 0x63, 0x6B, 0x46, 0x6F, 0x6E, 0x74,
 };
+
+static const font_offsets::range StackFont_sparse_font_ranges[119] FONT_QSPI =
+{
+    { 0, 1, 0 },
+    { 13, 1, 1 },
+    { 32, 95, 2 },
+    { 160, 224, 97 },
+    { 402, 1, 321 },
+    { 416, 2, 322 },
+    { 431, 2, 324 },
+    { 461, 16, 326 },
+    { 506, 6, 342 },
+    { 536, 4, 348 },
+    { 567, 1, 352 },
+    { 704, 1, 353 },
+    { 710, 2, 354 },
+    { 713, 1, 356 },
+    { 728, 6, 357 },
+    { 768, 5, 363 },
+    { 774, 5, 368 },
+    { 780, 1, 373 },
+    { 803, 1, 374 },
+    { 884, 2, 375 },
+    { 894, 1, 377 },
+    { 900, 7, 378 },
+    { 908, 1, 385 },
+    { 910, 20, 386 },
+    { 931, 44, 406 },
+    { 1024, 96, 450 },
+    { 1168, 2, 546 },
+    { 7808, 6, 548 },
+    { 7838, 1, 554 },
+    { 7840, 90, 555 },
+    { 8194, 6, 645 },
+    { 8208, 1, 651 },
+    { 8211, 3, 652 },
+    { 8215, 8, 655 },
+    { 8224, 3, 663 },
+    { 8230, 1, 666 },
+    { 8240, 1, 667 },
+    { 8242, 2, 668 },
+    { 8249, 2, 670 },
+    { 8252, 3, 672 },
+    { 8260, 1, 675 },
+    { 8287, 1, 676 },
+    { 8304, 1, 677 },
+    { 8307, 7, 678 },
+    { 8315, 1, 685 },
+    { 8319, 11, 686 },
+    { 8355, 2, 697 },
+    { 8359, 1, 699 },
+    { 8363, 2, 700 },
+    { 8377, 2, 702 },
+    { 8381, 1, 704 },
+    { 8450, 1, 705 },
+    { 8453, 1, 706 },
+    { 8467, 1, 707 },
+    { 8470, 1, 708 },
+    { 8481, 2, 709 },
+    { 8486, 1, 711 },
+    { 8494, 1, 712 },
+    { 8520, 1, 713 },
+    { 8539, 4, 714 },
+    { 8544, 16, 718 },
+    { 8592, 6, 734 },
+    { 8616, 1, 740 },
+    { 8644, 1, 741 },
+    { 8706, 1, 742 },
+    { 8710, 1, 743 },
+    { 8719, 1, 744 },
+    { 8721, 2, 745 },
+    { 8725, 1, 747 },
+    { 8729, 4, 748 },
+    { 8734, 4, 752 },
+    { 8745, 1, 756 },
+    { 8747, 1, 757 },
+    { 8776, 1, 758 },
+    { 8800, 2, 759 },
+    { 8804, 2, 761 },
+    { 8895, 1, 763 },
+    { 8962, 1, 764 },
+    { 8976, 1, 765 },
+    { 8992, 2, 766 },
+    { 9472, 1, 768 },
+    { 9474, 1, 769 },
+    { 9484, 1, 770 },
+    { 9488, 1, 771 },
+    { 9492, 1, 772 },
+    { 9496, 1, 773 },
+    { 9500, 1, 774 },
+    { 9508, 1, 775 },
+    { 9516, 1, 776 },
+    { 9524, 1, 777 },
+    { 9532, 1, 778 },
+    { 9552, 29, 779 },
+    { 9600, 1, 808 },
+    { 9604, 1, 809 },
+    { 9608, 1, 810 },
+    { 9612, 1, 811 },
+    { 9616, 4, 812 },
+    { 9632, 2, 816 },
+    { 9642, 3, 818 },
+    { 9650, 1, 821 },
+    { 9654, 1, 822 },
+    { 9658, 1, 823 },
+    { 9660, 1, 824 },
+    { 9664, 1, 825 },
+    { 9668, 1, 826 },
+    { 9674, 2, 827 },
+    { 9679, 1, 829 },
+    { 9688, 2, 830 },
+    { 9698, 5, 832 },
+    { 9786, 3, 837 },
+    { 9792, 1, 840 },
+    { 9794, 1, 841 },
+    { 9824, 1, 842 },
+    { 9827, 1, 843 },
+    { 9829, 2, 844 },
+    { 9834, 2, 846 },
+    { 61441, 2, 848 },
+    { 63171, 1, 850 },
+    { 64256, 5, 851 },
+};
+
+static const uint32_t StackFont_sparse_font_glyphs[856] FONT_QSPI =
+{
+    8, 16, 24, 30, 44, 59, 105, 149,
+    229, 278, 287, 317, 347, 369, 405, 414,
+    423, 430, 474, 514, 540, 577, 614, 657,
+    697, 737, 777, 817, 854, 866, 880, 916,
+    941, 977, 1011, 1086, 1135, 1175, 1218, 1258,
+    1292, 1326, 1369, 1412, 1440, 1468, 1508, 1542,
+    1593, 1636, 1679, 1716, 1769, 1809, 1849, 1892,
+    1935, 1981, 2041, 2087, 2127, 2164, 2192, 2232,
+    2260, 2285, 2292, 2302, 2332, 2372, 2400, 2440,
+    2470, 2501, 2541, 2581, 2596, 2625, 2665, 2686,
+    2730, 2760, 2790, 2830, 2870, 2893, 2922, 2950,
+    2980, 3010, 3056, 3088, 3131, 3157, 3192, 3207,
+    3242, 3261, 3267, 3282, 3320, 3363, 3392, 3435,
+    3452, 3500, 3509, 3575, 3592, 3625, 3651, 3660,
+    3726, 3734, 3748, 3794, 3813, 3834, 3844, 3884,
+    3938, 3945, 3956, 3972, 3988, 4023, 4100, 4174,
+    4251, 4288, 4353, 4418, 4483, 4547, 4601, 4666,
+    4729, 4783, 4828, 4873, 4918, 4961, 4998, 5035,
+    5072, 5107, 5156, 5212, 5269, 5326, 5385, 5442,
+    5496, 5532, 5588, 5645, 5702, 5761, 5815, 5868,
+    5905, 5946, 5989, 6032, 6075, 6116, 6156, 6199,
+    6245, 6282, 6325, 6368, 6411, 6451, 6473, 6498,
+    6530, 6557, 6598, 6639, 6682, 6725, 6768, 6809,
+    6849, 6885, 6919, 6962, 7005, 7048, 7088, 7139,
+    7188, 7237, 7299, 7339, 7399, 7440, 7502, 7542,
+    7599, 7638, 7697, 7736, 7790, 7830, 7889, 7928,
+    7981, 8036, 8085, 8131, 8174, 8214, 8258, 8299,
+    8342, 8382, 8425, 8465, 8510, 8553, 8612, 8663,
+    8720, 8769, 8823, 8872, 8929, 8981, 9038, 9087,
+    9138, 9181, 9221, 9252, 9287, 9313, 9349, 9377,
+    9412, 9437, 9472, 9484, 9538, 9583, 9634, 9672,
+    9725, 9773, 9803, 9848, 9875, 9920, 9943, 9977,
+    10009, 10043, 10075, 10115, 10142, 10199, 10240, 10297,
+    10340, 10397, 10440, 10489, 10543, 10583, 10637, 10677,
+    10734, 10775, 10832, 10878, 10941, 10989, 11042, 11073,
+    11126, 11158, 11211, 11243, 11296, 11335, 11390, 11429,
+    11479, 11516, 11571, 11610, 11664, 11698, 11755, 11789,
+    11832, 11860, 11917, 11958, 12012, 12052, 12109, 12150,
+    12209, 12252, 12309, 12358, 12412, 12452, 12533, 12599,
+    12652, 12703, 12753, 12802, 12837, 12884, 12918, 12967,
+    13003, 13041, 13093, 13152, 13198, 13260, 13306, 13371,
+    13414, 13451, 13483, 13542, 13585, 13644, 13687, 13748,
+    13793, 13855, 13902, 13966, 14013, 14075, 14125, 14194,
+    14246, 14331, 14397, 14466, 14513, 14566, 14605, 14662,
+    14702, 14726, 14767, 14778, 14792, 14803, 14814, 14821,
+    14831, 14842, 14854, 14870, 14877, 14885, 14893, 14901,
+    14911, 14919, 14925, 14932, 14940, 14951, 14962, 14972,
+    14980, 14991, 15008, 15018, 15032, 15081, 15088, 15137,
+    15194, 15240, 15297, 15354, 15408, 15445, 15494, 15534,
+    15568, 15614, 15648, 15685, 15728, 15774, 15802, 15842,
+    15888, 15939, 15982, 16016, 16059, 16102, 16142, 16182,
+    16225, 16265, 16317, 16363, 16413, 16456, 16491, 16541,
+    16594, 16633, 16684, 16710, 16754, 16793, 16844, 16887,
+    16933, 16962, 17007, 17047, 17093, 17113, 17143, 17196,
+    17236, 17268, 17313, 17345, 17382, 17425, 17465, 17504,
+    17536, 17568, 17629, 17675, 17740, 17784, 17812, 17853,
+    17896, 17939, 18005, 18050, 18093, 18142, 18187, 18231,
+    18272, 18300, 18335, 18363, 18435, 18501, 18547, 18600,
+    18657, 18713, 18762, 18811, 18851, 18891, 18925, 18981,
+    19015, 19075, 19116, 19159, 19213, 19253, 19302, 19353,
+    19396, 19440, 19483, 19520, 19564, 19607, 19653, 19706,
+    19752, 19805, 19845, 19899, 19972, 20026, 20080, 20120,
+    20164, 20226, 20266, 20296, 20340, 20370, 20396, 20437,
+    20467, 20511, 20539, 20569, 20609, 20639, 20671, 20706,
+    20736, 20766, 20796, 20836, 20864, 20894, 20934, 20994,
+    21026, 21064, 21094, 21133, 21185, 21222, 21261, 21289,
+    21317, 21361, 21389, 21432, 21472, 21528, 21563, 21591,
+    21619, 21633, 21659, 21680, 21728, 21774, 21820, 21861,
+    21902, 21950, 21990, 22027, 22061, 22142, 22206, 22287,
+    22351, 22431, 22489, 22538, 22600, 22640, 22704, 22745,
+    22818, 22872, 22937, 22984, 23053, 23098, 23171, 23218,
+    23295, 23346, 23408, 23455, 23517, 23564, 23639, 23688,
+    23761, 23810, 23876, 23925, 23968, 24008, 24052, 24093,
+    24137, 24178, 24239, 24293, 24349, 24393, 24445, 24494,
+    24544, 24591, 24644, 24695, 24731, 24753, 24788, 24805,
+    24859, 24899, 24956, 24997, 25062, 25113, 25174, 25218,
+    25280, 25329, 25393, 25440, 25507, 25558, 25631, 25687,
+    25760, 25816, 25889, 25943, 26016, 26070, 26141, 26193,
+    26247, 26287, 26344, 26385, 26462, 26518, 26595, 26651,
+    26728, 26782, 26859, 26913, 26988, 27040, 27093, 27144,
+    27194, 27234, 27286, 27343, 27395, 27451, 27457, 27463,
+    27469, 27475, 27481, 27490, 27502, 27513, 27530, 27550,
+    27561, 27570, 27579, 27588, 27597, 27614, 27631, 27651,
+    27704, 27753, 27769, 27789, 27901, 27910, 27930, 27951,
+    27975, 28009, 28050, 28061, 28091, 28100, 28124, 28171,
+    28192, 28213, 28234, 28255, 28276, 28300, 28311, 28327,
+    28348, 28364, 28383, 28404, 28425, 28446, 28467, 28488,
+    28509, 28533, 28573, 28619, 28708, 28759, 28805, 28841,
+    28884, 28930, 28976, 29044, 29082, 29159, 29252, 29284,
+    29333, 29378, 29409, 29486, 29566, 29643, 29723, 29751,
+    29800, 29872, 29941, 29987, 30056, 30145, 30257, 30323,
+    30369, 30438, 30527, 30561, 30604, 30644, 30698, 30730,
+    30762, 30794, 30826, 30858, 30893, 30932, 30988, 31032,
+    31081, 31133, 31182, 31195, 31232, 31240, 31284, 31327,
+    31376, 31407, 31483, 31555, 31629, 31675, 31713, 31743,
+    31784, 31820, 31861, 31905, 31985, 32018, 32044, 32066,
+    32095, 32110, 32128, 32164, 32197, 32233, 32266, 32324,
+    32377, 32432, 32487, 32580, 32607, 32642, 32679, 32717,
+    32758, 32792, 32828, 32866, 32903, 32941, 32982, 33016,
+    33052, 33090, 33145, 33205, 33265, 33315, 33370, 33425,
+    33486, 33538, 33599, 33660, 33712, 33773, 33863, 33953,
+    34040, 34091, 34142, 34235, 34283, 34333, 34410, 34491,
+    34579, 34605, 34634, 34644, 34654, 34674, 34731, 34773,
+    34832, 34891, 34933, 34992, 35029, 35055, 35081, 35108,
+    35150, 35221, 35295, 35369, 35443, 35457, 35499, 35544,
+    35632, 35688, 35755, 35791, 35834, 35869, 35905, 35941,
+    35996, 36036, 36089, 36102, 36156, 36200, 36251, 36318,
+};
+
+extern const font_offsets StackFont_sparse_font_offsets;
+const font_offsets StackFont_sparse_font_offsets =
+{
+    StackFont_sparse_font_ranges, 119,
+    StackFont_sparse_font_glyphs, 856
+};
@@ -64,6 +64,7 @@ RECORDER(lcd_warning,   64, "Warnings from lcd/display functions");
 volatile int       lcd_needsupdate = 0;
 int                lcd_buf_cleared = 0;
 uint8_t            lcd_buffer[LCD_SCANLINE * LCD_H / 8];
+std::atomic<uint32_t> lcd_dirty_lines[(LCD_H + 31) / 32];
 bool               shiftHeld = false;
 bool               altHeld   = false;
 
@@ -505,30 +506,51 @@ void lcd_print(disp_stat_t * ds, const char* fmt, ...)
     lcd_puts(ds, buffer);
 }
 
+static void lcd_dirty(int ln, int cnt)
+{
+    // The screen thread clears the bits it paints, see SimScreen::update()
+    if (ln < 0)
+        ln = 0;
+    if (ln + cnt > LCD_H)
+        cnt = LCD_H - ln;
+    for (int y = ln; y < ln + cnt; )
+    {
+        int      w    = y / 32;
+        uint32_t mask = 0;
+        for (; y < ln + cnt && y / 32 == w; y++)
+            mask |= 1U << (y % 32);
+        lcd_dirty_lines[w].fetch_or(mask);
+    }
+}
 void lcd_forced_refresh()
 {
     record(lcd, "Forced refresh");
+    lcd_dirty(0, LCD_H);
     lcd_needsupdate++;
 }
 void lcd_refresh()
 {
     record(lcd_refresh, "Refresh %u", lcd_needsupdate);
+    lcd_dirty(0, LCD_H);
     lcd_needsupdate++;
 }
 void lcd_refresh_dma()
 {
     record(lcd_refresh, "Refresh DMA %u", lcd_needsupdate);
+    lcd_dirty(0, LCD_H);
     lcd_needsupdate++;
 }
 void lcd_refresh_wait()
 {
     record(lcd_refresh, "Refresh wait %u", lcd_needsupdate);
+    lcd_dirty(0, LCD_H);
     lcd_needsupdate++;
 }
 void lcd_refresh_lines(int ln, int cnt)
 {
     record(lcd_refresh, "Refresh lines %u (%d-%d) count %d",
            lcd_needsupdate, ln, ln+cnt-1, cnt);
+    lcd_dirty(ln, cnt);
     lcd_needsupdate += (ln >= 0 && cnt > 0);
 }
 void lcd_setLine(disp_stat_t * ds, int ln_nr)
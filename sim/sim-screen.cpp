@@ -51,6 +51,10 @@ SimScreen::SimScreen(QWidget *parent)
       screenTimer(new QTimer(this)),
       mainPixmap(LCD_W, LCD_H)
 {
+    // Paint all lines the first time
+    for (int w = 0; w < (LCD_H + 31) / 32; w++)
+        lcd_dirty_lines[w].store(~0U);
+
     connect(&screenTimer, SIGNAL(timeout()), this, SLOT(update()));
     screenTimer.setSingleShot(true);
     screenTimer.start(20);
@@ -127,8 +131,16 @@ void SimScreen::update()
     screen.setBackgroundBrush(QBrush(fgColor));
     QPainter      pt(&mainPixmap);
 
+    // Only repaint the lines that were refreshed since last time.
+    // The RPL thread sets dirty bits concurrently, so take them atomically:
+    // a line refreshed while we paint it will be painted again next time
+    uint32_t dirty = 0;
     for (int y = 0; y < LCD_H; y++)
     {
+        if (y % 32 == 0)
+            dirty = lcd_dirty_lines[y / 32].exchange(0);
+        if (!(dirty & (1U << (y % 32))))
+            continue;
         for (int x = 0; x < LCD_W; x++)
         {
             unsigned bo = y * LCD_SCANLINE + x;
@@ -32,10 +32,12 @@
 #include <QGraphicsView>
 #include <QGraphicsPixmapItem>
 #include <QTimer>
+#include <atomic>
 
 
 extern volatile int lcd_needsupdate;
 extern uint8_t lcd_buffer[];
+extern std::atomic<uint32_t> lcd_dirty_lines[];
 
 class SimScreen : public QGraphicsView
 // ----------------------------------------------------------------------------
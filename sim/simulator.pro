@@ -53,6 +53,8 @@ SOURCES +=                                      \
         ../src/decimal128.cc                    \
         ../src/decimal-64.cc                    \
         ../src/decimal-32.cc                    \
+        ../src/big_decimal.cc                   \
+        ../src/hwdouble.cc                      \
         ../src/runtime.cc                       \
         ../src/text.cc                          \
         ../src/symbol.cc                        \
@@ -66,6 +68,12 @@ SOURCES +=                                      \
         ../src/list.cc                          \
         ../src/program.cc                       \
         ../src/equation.cc                      \
+        ../src/compiled.cc                      \
+        ../src/solve.cc                         \
+        ../src/integrate.cc                     \
+        ../src/plot.cc                          \
+        ../src/dag.cc                           \
+        ../src/polynomial.cc                    \
         ../src/array.cc                         \
         ../src/loops.cc                         \
         ../src/conditionals.cc                  \
@@ -30,8 +30,10 @@
 #include "algebraic.h"
 
 #include "arithmetic.h"
+#include "big_decimal.h"
 #include "bignum.h"
 #include "complex.h"
+#include "hwdouble.h"
 #include "integer.h"
 #include "parser.h"
 #include "renderer.h"
@@ -70,6 +72,21 @@ bool algebraic::real_promotion(algebraic_g &x, object::id type)
 
     record(algebraic, "Real promotion of %p from %+s to %+s",
            (object_p) x, object::name(xt), object::name(type));
+
+    // Any real value can be converted to a variable-precision decimal
+    if (type == ID_big_decimal && (is_integer(xt) || is_real(xt)))
+    {
+        x = big_decimal::make(x).Safe();
+        return x.Safe();
+    }
+
+    // Same thing for hardware floating-point
+    if (type == ID_hwdouble && (is_integer(xt) || is_real(xt)))
+    {
+        x = hwdouble::make(x);
+        return x.Safe();
+    }
+
     switch(xt)
     {
     case ID_integer:
@@ -228,6 +245,15 @@ bool algebraic::real_promotion(algebraic_g &x, object::id type)
         break;
     }
 
+    case ID_hwdouble:
+        x = hwdouble_p(x.Safe())->to_decimal(type);
+        return x.Safe();
+
+    case ID_big_decimal:
+        // Narrowing, e.g. for graphics or functions only in decimal128
+        x = big_decimal_p(x.Safe())->to_decimal128();
+        return x.Safe() && real_promotion(x, type);
+
     default:
         break;
     }
@@ -242,14 +268,27 @@ object::id algebraic::real_promotion(algebraic_g &x)
 // ----------------------------------------------------------------------------
 {
     // Auto-selection of type
-    uint16_t prec = Settings.precision;
-    id       type = prec > BID64_MAXDIGITS ? ID_decimal128
-                  : prec > BID32_MAXDIGITS ? ID_decimal64
-                                           : ID_decimal32;
+    id type = real_type();
     return real_promotion(x, type) ? type : ID_object;
 }
 
 
+object::id algebraic::real_type(bool hardware)
+// ----------------------------------------------------------------------------
+//   Return the real type selected by the precision and floating-point mode
+// ----------------------------------------------------------------------------
+//   If hardware is false, only return decimal types
+{
+    uint16_t prec = Settings.precision;
+    if (hardware && Settings.hardware_fp && prec <= BID64_MAXDIGITS)
+        return ID_hwdouble;
+    return prec > BID128_MAXDIGITS ? ID_big_decimal
+         : prec > BID64_MAXDIGITS  ? ID_decimal128
+         : prec > BID32_MAXDIGITS  ? ID_decimal64
+                                   : ID_decimal32;
+}
+
+
 bool algebraic::complex_promotion(algebraic_g &x, object::id type)
 // ----------------------------------------------------------------------------
 //   Promote the value x to the given complex type
@@ -346,6 +385,11 @@ bool algebraic::decimal_to_fraction(algebraic_g &x)
     case ID_decimal128: x = decimal128_p(x.Safe())->to_fraction(); return true;
     case ID_decimal64:  x = decimal64_p(x.Safe())->to_fraction();  return true;
     case ID_decimal32:  x = decimal32_p(x.Safe())->to_fraction();  return true;
+    case ID_big_decimal:
+        x = big_decimal_p(x.Safe())->to_fraction();
+        return x.Safe();
+    case ID_hwdouble:
+        return real_promotion(x, ID_decimal64) && decimal_to_fraction(x);
     case ID_fraction:
     case ID_neg_fraction:
     case ID_big_fraction:
@@ -360,6 +404,9 @@ algebraic_g algebraic::pi()
 //   Return the value of pi
 // ----------------------------------------------------------------------------
 {
+    if (Settings.precision > BID128_MAXDIGITS)
+        return big_decimal::pi().Safe();
+
     static bool init = false;
     static byte rep[1+sizeof(bid128)];
     if (!init)
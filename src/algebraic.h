@@ -51,6 +51,7 @@ struct algebraic : command
     // Promotion of integer / fractions to real
     static bool real_promotion(algebraic_g &x, id type);
     static id   real_promotion(algebraic_g &x);
+    static id   real_type(bool hardware = true);
 
     // Promotion of integer, real or fraction to complex
     static bool complex_promotion(algebraic_g &x, id type = ID_rectangular);
@@ -30,6 +30,7 @@
 #include "arithmetic.h"
 
 #include "array.h"
+#include "big_decimal.h"
 #include "bignum.h"
 #include "decimal-32.h"
 #include "decimal-64.h"
@@ -37,6 +38,7 @@
 #include "equation.h"
 #include "fraction.h"
 #include "functions.h"
+#include "hwdouble.h"
 #include "integer.h"
 #include "list.h"
 #include "runtime.h"
@@ -67,10 +69,7 @@ bool arithmetic::real_promotion(algebraic_g &x, algebraic_g &y)
     if (!is_real(xt) || !is_real(yt))
         return false;
 
-    uint16_t prec  = Settings.precision;
-    id       minty = prec > BID64_MAXDIGITS ? ID_decimal128
-                   : prec > BID32_MAXDIGITS ? ID_decimal64
-                                            : ID_decimal32;
+    id minty = real_type();
     if (is_decimal(xt) && xt > minty)
         minty = xt;
     if (is_decimal(yt) && yt > minty)
@@ -859,7 +858,7 @@ inline bool pow::bignum_ok(bignum_g &x, bignum_g &y)
     // Compute result, check that it does not overflow
     if (y->type() == ID_neg_bignum)
         return false;
-    x = bignum::pow(x, y);
+    x = bignum::pow(x, y, Settings.maxbignum);
     return true;
 }
 
@@ -1102,7 +1101,7 @@ algebraic_p arithmetic::evaluate(id          op,
     algebraic_g y = yr;
     if (real_promotion(x, y))
     {
-        // Here, x and y have the same type, a decimal type
+        // Here, x and y have the same type, a real type
         xt = x->type();
         switch(xt)
         {
@@ -1113,6 +1112,7 @@ algebraic_p arithmetic::evaluate(id          op,
             bid32 res;
             ops.op32(&res.value, &xv.value, &yv.value);
             x = rt.make<decimal32>(ID_decimal32, res);
+            break;
         }
         case ID_decimal64:
         {
@@ -1121,6 +1121,7 @@ algebraic_p arithmetic::evaluate(id          op,
             bid64 res;
             ops.op64(&res.value, &xv.value, &yv.value);
             x = rt.make<decimal64>(ID_decimal64, res);
+            break;
         }
         case ID_decimal128:
         {
@@ -1129,7 +1130,14 @@ algebraic_p arithmetic::evaluate(id          op,
             bid128 res;
             ops.op128(&res.value, &xv.value, &yv.value);
             x = rt.make<decimal128>(ID_decimal128, res);
+            break;
         }
+        case ID_hwdouble:
+            x = hwdouble::evaluate(op, x, y);
+            break;
+        case ID_big_decimal:
+            x = big_decimal::evaluate(op, x, y);
+            break;
         default:
             break;
         }
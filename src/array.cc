@@ -30,6 +30,9 @@
 #include "array.h"
 #include "arithmetic.h"
 #include "functions.h"
+#include "integer.h"
+
+#include <bit>
 
 
 RECORDER(matrix, 16, "Determinant computation");
@@ -146,6 +149,270 @@ bool array::is_matrix(size_t *rows, size_t *cols) const
 
 
 
+// ============================================================================
+//
+//    Fused numerical kernels
+//
+// ============================================================================
+//
+//   The generic algebraic operators allocate an object for each product and
+//   for each partial sum. For the inner loops of dot products, norms and
+//   row operations, we instead accumulate in a single native accumulator:
+//   - As long as all terms are native integers, the sum is kept exact
+//   - As soon as a decimal shows up, we switch to a bid128 accumulator
+//   If an element is not numeric (symbolic, fraction, complex, ...) or if
+//   the exact integer sum overflows, the kernel fails and the caller falls
+//   back to the generic symbolic code, which gives exact or symbolic results.
+
+struct fused
+// ----------------------------------------------------------------------------
+//   Accumulator for fused multiply-add kernels
+// ----------------------------------------------------------------------------
+{
+    fused()
+        : exact(true), negative(false), magnitude(0), sum(),
+          widest(object::ID_object) {}
+
+    enum kind { NONE, INTEGER, DECIMAL };
+
+    kind load(object_p obj, bool &neg, ularge &mag, bid128 &dec)
+    // ------------------------------------------------------------------------
+    //   Load a numerical element, return its kind
+    // ------------------------------------------------------------------------
+    {
+        if (!obj)
+            return NONE;
+        object::id ty = obj->type();
+        switch(ty)
+        {
+        case object::ID_integer:
+        case object::ID_neg_integer:
+        {
+            integer_p i = integer_p(obj);
+            if (!i->native())
+                return NONE;
+            neg = ty == object::ID_neg_integer;
+            mag = i->value<ularge>();
+            return INTEGER;
+        }
+        case object::ID_decimal32:
+        {
+            bid32 v = decimal32_p(obj)->value();
+            bid32_to_bid128(&dec.value, &v.value);
+            break;
+        }
+        case object::ID_decimal64:
+        {
+            bid64 v = decimal64_p(obj)->value();
+            bid64_to_bid128(&dec.value, &v.value);
+            break;
+        }
+        case object::ID_decimal128:
+            dec = decimal128_p(obj)->value();
+            break;
+        default:
+            return NONE;
+        }
+
+        // Hardware and variable-precision results use the generic path
+        object::id rty = algebraic::real_type();
+        if (rty < object::ID_decimal32 || rty > object::ID_decimal128)
+            return NONE;
+        if (ty > widest)
+            widest = ty;
+        return DECIMAL;
+    }
+
+
+    static void convert(bid128 &dec, bool neg, ularge mag)
+    // ------------------------------------------------------------------------
+    //   Convert an integer magnitude and sign to bid128
+    // ------------------------------------------------------------------------
+    {
+        BID_UINT64 bval = BID_UINT64(mag);
+        bid128_from_uint64(&dec.value, &bval);
+        if (neg)
+            bid128_negate(&dec.value, &dec.value);
+    }
+
+
+    bool accumulate(bool neg, ularge mag)
+    // ------------------------------------------------------------------------
+    //   Add an exact integer term, return false on overflow
+    // ------------------------------------------------------------------------
+    {
+        if (neg == negative)
+        {
+            ularge total = magnitude + mag;
+            if (total < magnitude)
+                return false;
+            magnitude = total;
+        }
+        else if (mag > magnitude)
+        {
+            magnitude = mag - magnitude;
+            negative = neg;
+        }
+        else
+        {
+            magnitude -= mag;
+        }
+        return true;
+    }
+
+
+    void decimal()
+    // ------------------------------------------------------------------------
+    //   Switch the accumulator to decimal mode
+    // ------------------------------------------------------------------------
+    {
+        if (exact)
+        {
+            convert(sum, negative, magnitude);
+            exact = false;
+        }
+    }
+
+
+    bool add(object_p x, bool subtract = false)
+    // ------------------------------------------------------------------------
+    //   Add (or subtract) a single term
+    // ------------------------------------------------------------------------
+    {
+        bool   xn = false;
+        ularge xm = 0;
+        bid128 xd;
+        kind   kx = load(x, xn, xm, xd);
+        if (kx == NONE)
+            return false;
+        if (kx == INTEGER)
+        {
+            if (exact)
+                return accumulate(xn != subtract, xm);
+            convert(xd, xn, xm);
+        }
+        decimal();
+        if (subtract)
+            bid128_sub(&sum.value, &sum.value, &xd.value);
+        else
+            bid128_add(&sum.value, &sum.value, &xd.value);
+        return true;
+    }
+
+
+    bool product(object_p x, object_p y, bool subtract = false)
+    // ------------------------------------------------------------------------
+    //   Add (or subtract) the product x * y to the accumulator
+    // ------------------------------------------------------------------------
+    {
+        bool   xn = false, yn = false;
+        ularge xm = 0,     ym = 0;
+        bid128 xd, yd;
+        kind   kx = load(x, xn, xm, xd);
+        if (kx == NONE)
+            return false;
+        kind   ky = load(y, yn, ym, yd);
+        if (ky == NONE)
+            return false;
+
+        if (exact && kx == INTEGER && ky == INTEGER)
+        {
+            // Same overflow check as in mul::integer_ok
+            if (std::__countl_zero(xm) + std::__countl_zero(ym) <
+                int(8 * sizeof(ularge)))
+                return false;
+            return accumulate((xn != yn) != subtract, xm * ym);
+        }
+
+        decimal();
+        if (kx == INTEGER)
+            convert(xd, xn, xm);
+        if (ky == INTEGER)
+            convert(yd, yn, ym);
+        bid128 prod;
+        bid128_mul(&prod.value, &xd.value, &yd.value);
+        if (subtract)
+            bid128_sub(&sum.value, &sum.value, &prod.value);
+        else
+            bid128_add(&sum.value, &sum.value, &prod.value);
+        return true;
+    }
+
+
+    void sqrt()
+    // ------------------------------------------------------------------------
+    //   Replace a decimal accumulator with its square root
+    // ------------------------------------------------------------------------
+    {
+        decimal();
+        bid128_sqrt(&sum.value, &sum.value);
+    }
+
+
+    algebraic_p value() const
+    // ------------------------------------------------------------------------
+    //   Build the resulting object
+    // ------------------------------------------------------------------------
+    {
+        if (exact)
+            return rt.make<integer>(negative && magnitude
+                                    ? object::ID_neg_integer
+                                    : object::ID_integer,
+                                    magnitude);
+
+        // Same type selection as arithmetic::real_promotion
+        object::id ty = algebraic::real_type();
+        if (widest > ty)
+            ty = widest;
+        switch(ty)
+        {
+        case object::ID_decimal32:
+        {
+            bid32 res;
+            bid128_to_bid32(&res.value, (BID_UINT128 *) &sum.value);
+            return rt.make<decimal32>(object::ID_decimal32, res);
+        }
+        case object::ID_decimal64:
+        {
+            bid64 res;
+            bid128_to_bid64(&res.value, (BID_UINT128 *) &sum.value);
+            return rt.make<decimal64>(object::ID_decimal64, res);
+        }
+        default:
+            return rt.make<decimal128>(object::ID_decimal128, sum);
+        }
+    }
+
+    bool       exact;           // Accumulating native integers
+    bool       negative;        // Sign of the exact sum
+    ularge     magnitude;       // Magnitude of the exact sum
+    bid128     sum;             // Decimal sum
+    object::id widest;          // Widest decimal type seen in input
+};
+
+
+static bool fused_norm_square(array_p a, fused &acc)
+// ----------------------------------------------------------------------------
+//   Accumulate the squares of all elements, recursing into sub-arrays
+// ----------------------------------------------------------------------------
+{
+    for (object_p obj : *a)
+    {
+        if (obj->type() == object::ID_array)
+        {
+            if (!fused_norm_square(array_p(obj), acc))
+                return false;
+        }
+        else if (!acc.product(obj, obj))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+
 // ============================================================================
 //
 //    Additive operations
@@ -302,6 +569,20 @@ static algebraic_g matrix_mul(size_t r, size_t c,
         record(matrix_error,
                "Inconsistent matrix size rx=%u cx=%u ry=%u cy%=u",
                rx, cx, ry, cy);
+
+    // Fast path: numerical dot product in a single accumulator
+    fused acc;
+    bool  numeric = true;
+    for (size_t i = 0; numeric && i < cx; i++)
+    {
+        size_t ix = r * cx + i;
+        size_t iy = cy * i + c;
+        numeric = acc.product(rt.stack(px + ~ix), rt.stack(py + ~iy));
+    }
+    if (numeric)
+        return acc.value();
+
+    // Generic path: symbolic or exact non-integer elements
     for (size_t i = 0; i < cx; i++)
     {
         size_t ix = r * cx + i;
@@ -474,11 +755,20 @@ algebraic_g array::determinant() const
                     object_p tk = rt.stack(pt + ~k);
                     if (!mjk || !tk)
                         goto err;
-                    algebraic_g mjka = mjk->as_algebraic();
-                    algebraic_g tka = tk->as_algebraic();
-                    if (!mjka || !tka)
-                        goto err;
-                    mjka = aa * mjka - ba * tka;
+                    algebraic_g mjka;
+                    fused acc;
+                    if (acc.product(aa, mjk) && acc.product(ba, tk, true))
+                    {
+                        mjka = acc.value();
+                    }
+                    else
+                    {
+                        mjka = mjk->as_algebraic();
+                        algebraic_g tka = tk->as_algebraic();
+                        if (!mjka || !tka)
+                            goto err;
+                        mjka = aa * mjka - ba * tka;
+                    }
                     record(matrix, "  m[%u,%u] is now %t", j, k, mjk);
                     rt.stack(px + ~ixjk, mjka.Safe());
                 }
@@ -772,11 +1062,20 @@ array_g array::invert() const
                         object_p mik = rt.stack(p + ~oik);
                         if (!mjk || !mik)
                             goto err;
-                        algebraic_g mjka = mjk->as_algebraic();
-                        algebraic_g mika = mik->as_algebraic();
-                        if (!mjka || !mika)
-                            goto err;
-                        mjka = aa * mjka - ca * mika;
+                        algebraic_g mjka;
+                        fused acc;
+                        if (acc.product(aa, mjk) && acc.product(ca, mik, true))
+                        {
+                            mjka = acc.value();
+                        }
+                        else
+                        {
+                            mjka = mjk->as_algebraic();
+                            algebraic_g mika = mik->as_algebraic();
+                            if (!mjka || !mika)
+                                goto err;
+                            mjka = aa * mjka - ca * mika;
+                        }
                         rt.stack(p + ~ojk, mjka.Safe());
                         record(matrix, "%+s[%u,%u] is now %t",
                                mat ? "t" : "m", j, k, mjka.Safe());
@@ -829,11 +1128,20 @@ array_g array::invert() const
                         object_p mjk = rt.stack(p + ~ojk);
                         if (!mik || !mjk)
                             goto err;
-                        algebraic_g mika = mik->as_algebraic();
-                        algebraic_g mjka = mjk->as_algebraic();
-                        if (!mika || !mjka)
-                            goto err;
-                        mjka = mjka  - za * mika;
+                        algebraic_g mjka;
+                        fused acc;
+                        if (acc.add(mjk) && acc.product(za, mik, true))
+                        {
+                            mjka = acc.value();
+                        }
+                        else
+                        {
+                            algebraic_g mika = mik->as_algebraic();
+                            mjka = mjk->as_algebraic();
+                            if (!mika || !mjka)
+                                goto err;
+                            mjka = mjka  - za * mika;
+                        }
                         rt.stack(p + ~ojk, mjka.Safe());
                     }
                 }
@@ -886,16 +1194,16 @@ err:
 }
 
 
-algebraic_g array::norm_square() const
+static algebraic_g generic_norm_square(array_p a)
 // ----------------------------------------------------------------------------
-//   Compute the square of the norm of a matrix or vector
+//   Compute the square of the norm using generic arithmetic
 // ----------------------------------------------------------------------------
 {
     algebraic_g sum;
-    for (object_p obj : *this)
+    for (object_p obj : *a)
     {
-        id oty = obj->type();
-        if (oty == ID_array)
+        object::id oty = obj->type();
+        if (oty == object::ID_array)
         {
             algebraic_g enorm2 = array_p(obj)->norm_square();
             sum = sum ? sum + enorm2 : enorm2;
@@ -915,13 +1223,141 @@ algebraic_g array::norm_square() const
 }
 
 
-algebraic_g array::norm() const
+algebraic_g array::norm_square() const
 // ----------------------------------------------------------------------------
 //   Compute the square of the norm of a matrix or vector
 // ----------------------------------------------------------------------------
 {
-    algebraic_g sq = norm_square();
-    return sqrt::run(sq);
+    fused acc;
+    if (fused_norm_square(this, acc))
+        return acc.value();
+    return generic_norm_square(this);
+}
+
+
+algebraic_g array::norm() const
+// ----------------------------------------------------------------------------
+//   Compute the norm of a matrix or vector
+// ----------------------------------------------------------------------------
+{
+    fused       acc;
+    algebraic_g sq;
+    if (fused_norm_square(this, acc))
+    {
+        // For decimal values, take the square root directly in the accumulator
+        if (!acc.exact)
+        {
+            acc.sqrt();
+            return acc.value();
+        }
+        sq = acc.value();
+    }
+    else
+    {
+        sq = generic_norm_square(this);
+    }
+    return sq ? sqrt::run(sq) : nullptr;
+}
+
+
+algebraic_g array::dot(array_r x, array_r y)
+// ----------------------------------------------------------------------------
+//   Compute the dot product of two vectors
+// ----------------------------------------------------------------------------
+{
+    size_t depth = rt.depth();
+    size_t cx = 0, cy = 0;
+    if (!x->is_vector(&cx))
+    {
+        rt.type_error();
+        return nullptr;
+    }
+    if (!y->is_vector(&cy))
+    {
+        rt.drop(rt.depth() - depth);
+        rt.type_error();
+        return nullptr;
+    }
+
+    algebraic_g result;
+    if (cx != cy)
+        rt.dimension_error();
+    else if (!cx)
+        result = integer::make(0);
+    else
+        result = matrix_mul(0, 0, 1, cx, cy, 1);
+    rt.drop(rt.depth() - depth);
+    return result;
+}
+
+
+static algebraic_g axpy_element(algebraic_r a,
+                                const object_g &x, const object_g &y)
+// ----------------------------------------------------------------------------
+//   Compute a * x + y for a single element, fused when numeric
+// ----------------------------------------------------------------------------
+{
+    fused acc;
+    if (acc.product(a, x) && acc.add(y))
+        return acc.value();
+
+    algebraic_g xa = x->as_algebraic();
+    algebraic_g ya = y->as_algebraic();
+    if (!xa || !ya)
+    {
+        rt.type_error();
+        return nullptr;
+    }
+    return a * xa + ya;
+}
+
+
+array_g array::axpy(algebraic_r a, array_r x, array_r y)
+// ----------------------------------------------------------------------------
+//   Compute a * x + y element-wise, recursing into sub-arrays
+// ----------------------------------------------------------------------------
+{
+    if (x->items() != y->items())
+    {
+        rt.dimension_error();
+        return nullptr;
+    }
+
+    scribble scr;
+    iterator yi = y->begin();
+    for (object_p obj : *x)
+    {
+        object_g xo = obj;
+        object_g yo = *yi++;
+        bool     xs = xo->type() == ID_array;
+        bool     ys = yo->type() == ID_array;
+        if (xs != ys)
+        {
+            rt.dimension_error();
+            return nullptr;
+        }
+        if (xs)
+        {
+            array_g sub = axpy(a, array_p(xo.Safe()), array_p(yo.Safe()));
+            if (!sub)
+                return nullptr;
+            obj = sub.Safe();
+        }
+        else
+        {
+            algebraic_g r = axpy_element(a, xo, yo);
+            if (!r)
+                return nullptr;
+            obj = r.Safe();
+        }
+
+        size_t objsz = obj->size();
+        byte_p objp = byte_p(obj);
+        if (!rt.append(objsz, objp))
+            return nullptr;
+    }
+
+    return array_p(list::make(ID_array, scr.scratch(), scr.growth()));
 }
 
 
@@ -948,6 +1384,58 @@ COMMAND_BODY(det)
 }
 
 
+COMMAND_BODY(dot)
+// ----------------------------------------------------------------------------
+//   Implement the 'dot' command
+// ----------------------------------------------------------------------------
+{
+    object_p y = rt.stack(0);
+    object_p x = rt.stack(1);
+    if (!x || !y)
+        return ERROR;
+
+    array_g xa = x->as<array>();
+    array_g ya = y->as<array>();
+    if (!xa || !ya)
+    {
+        rt.type_error();
+        return ERROR;
+    }
+
+    if (algebraic_g r = array::dot(xa, ya))
+        if (rt.drop() && rt.top(r))
+            return OK;
+    return ERROR;
+}
+
+
+COMMAND_BODY(axpy)
+// ----------------------------------------------------------------------------
+//   Implement the 'axpy' command, computing a * X + Y
+// ----------------------------------------------------------------------------
+{
+    object_p y = rt.stack(0);
+    object_p x = rt.stack(1);
+    object_p a = rt.stack(2);
+    if (!x || !y || !a)
+        return ERROR;
+
+    array_g     xa = x->as<array>();
+    array_g     ya = y->as<array>();
+    algebraic_g aa = a->as_algebraic();
+    if (!xa || !ya || !aa || aa->type() == ID_array)
+    {
+        rt.type_error();
+        return ERROR;
+    }
+
+    if (array_g r = array::axpy(aa, xa, ya))
+        if (rt.drop(2) && rt.top(r))
+            return OK;
+    return ERROR;
+}
+
+
 
 // ============================================================================
 //
@@ -81,6 +81,8 @@ struct array : list
     algebraic_g norm_square() const;
     algebraic_g norm() const;
     array_g invert() const;
+    static algebraic_g dot(array_r x, array_r y);
+    static array_g axpy(algebraic_r a, array_r x, array_r y);
 
 public:
     OBJECT_DECL(array);
@@ -96,5 +98,7 @@ array_g operator*(array_r x, array_r y);
 array_g operator/(array_r x, array_r y);
 
 COMMAND_DECLARE(det);
+COMMAND_DECLARE(dot);
+COMMAND_DECLARE(axpy);
 
 #endif // ARRAY_H
@@ -0,0 +1,1474 @@
+// ****************************************************************************
+//  big_decimal.cc                                                DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Variable-precision decimal numbers
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "big_decimal.h"
+
+#include "decimal-32.h"
+#include "decimal-64.h"
+#include "decimal128.h"
+#include "fraction.h"
+#include "integer.h"
+#include "parser.h"
+#include "renderer.h"
+#include "text.h"
+#include "utf8.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+RECORDER(big_decimal, 16, "Variable-precision decimal numbers");
+
+
+// Number of additional digits used for intermediate computations
+static const uint GUARD = 6;
+
+
+static size_t digit_bits(uint digits)
+// ----------------------------------------------------------------------------
+//   Number of bits needed for a mantissa with the given number of digits
+// ----------------------------------------------------------------------------
+{
+    return digits * 3322 / 1000 + 64;
+}
+
+
+static size_t mantissa_bits(uint digits)
+// ----------------------------------------------------------------------------
+//   Maximum size of intermediate mantissas when computing with digits
+// ----------------------------------------------------------------------------
+//   MaxBigNumBits limits the size of user-visible integers. The mantissas
+//   we compute with are bounded by the precision, so they get their own
+//   limit, and a high Precision does not require changing MaxBigNumBits.
+//   Aligned operands and products hold about three times the digits.
+{
+    size_t bits = digit_bits(3 * (digits + GUARD) + 16);
+    return bits > Settings.maxbignum ? bits : Settings.maxbignum;
+}
+
+
+static inline bignum_g mantissa_add(bignum_r y, bignum_r x, size_t bits)
+// ----------------------------------------------------------------------------
+//   Add two mantissas, with an explicit limit on the size of the result
+// ----------------------------------------------------------------------------
+{
+    return bignum::add_sub(y, x, false, bits);
+}
+
+
+static inline bignum_g mantissa_mul(bignum_r y, bignum_r x, size_t bits)
+// ----------------------------------------------------------------------------
+//   Multiply two mantissas, with an explicit limit on the size of the result
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe() || !y.Safe())
+        return nullptr;
+    object::id ty = bignum::product_type(y->type(), x->type());
+    return bignum::multiply(y, x, ty, bits);
+}
+
+
+
+// ============================================================================
+//
+//   Mantissa helpers
+//
+// ============================================================================
+
+static bignum_g ten_power(uint n)
+// ----------------------------------------------------------------------------
+//   Return 10^n as a bignum
+// ----------------------------------------------------------------------------
+{
+    bignum_g ten = bignum::make(10);
+    bignum_g exp = bignum::make(n);
+    return bignum::pow(ten, exp, digit_bits(n + 1));
+}
+
+
+static uint digit_count(bignum_r m)
+// ----------------------------------------------------------------------------
+//   Return the number of decimal digits in the magnitude of m
+// ----------------------------------------------------------------------------
+{
+    if (!m.Safe())
+        return 0;
+    size_t size = 0;
+    byte_p p = m->value(&size);
+    while (size && !p[size - 1])
+        size--;
+    if (!size)
+        return 0;
+
+    // Estimate from the number of bits, then adjust with powers of 10
+    uint bits = 8 * (size - 1);
+    for (byte top = p[size - 1]; top; top >>= 1)
+        bits++;
+    uint     count = (bits - 1) * 30103 / 100000 + 1;
+    bignum_g power = ten_power(count);
+    bignum_g ten   = bignum::make(10);
+    while (power && bignum::compare(m, power, true) >= 0)
+    {
+        power = mantissa_mul(power, ten, digit_bits(count + 2));
+        count++;
+    }
+    return count;
+}
+
+
+static bignum_g parse_digits(gcutf8 &src, size_t start, size_t end)
+// ----------------------------------------------------------------------------
+//   Convert the decimal digits in the given range into a bignum
+// ----------------------------------------------------------------------------
+//   Characters that are not digits, like the decimal separator, are skipped
+{
+    size_t   bits   = digit_bits(end - start + 9);
+    bignum_g result = bignum::make(0);
+    bignum_g chunk  = ten_power(9);
+    uint     value  = 0;
+    uint     count  = 0;
+    for (size_t i = start; i < end; i++)
+    {
+        byte c = src.Safe()[i];
+        if (c < '0' || c > '9')
+            continue;
+        value = value * 10 + (c - '0');
+        if (++count == 9)
+        {
+            bignum_g low = bignum::make(value);
+            result = mantissa_add(mantissa_mul(result, chunk, bits), low, bits);
+            value = 0;
+            count = 0;
+        }
+    }
+    if (count)
+    {
+        bignum_g low = bignum::make(value);
+        result = mantissa_mul(result, ten_power(count), bits);
+        result = mantissa_add(result, low, bits);
+    }
+    return result;
+}
+
+
+static text_g digits_text(bignum_r mantissa)
+// ----------------------------------------------------------------------------
+//   Return the decimal digits of the magnitude of the mantissa as text
+// ----------------------------------------------------------------------------
+{
+    bignum_g m     = mantissa;
+    bignum_g chunk = ten_power(9);
+    text_g   result;
+    {
+        renderer tmp(false);
+        if (m->is_zero())
+            tmp.put('0');
+        while (m && !m->is_zero())
+        {
+            bignum_g quotient, remainder;
+            if (!bignum::quorem(m, chunk, object::ID_bignum,
+                                &quotient, &remainder))
+                return nullptr;
+            uint value = remainder->value<uint>();
+            m = quotient;
+            for (uint i = 0; i < 9 && (value || !m->is_zero()); i++)
+            {
+                tmp.put(char('0' + value % 10));
+                value /= 10;
+            }
+        }
+
+        // Digits were generated least significant first
+        byte *dest = (byte *) tmp.text();
+        utf8_reverse(dest, dest + tmp.size(), false);
+        result = text::make(tmp.text(), tmp.size());
+    }
+    return result;
+}
+
+
+static bignum_g nearest(big_decimal_r x, uint digits)
+// ----------------------------------------------------------------------------
+//   Return the integer nearest to x
+// ----------------------------------------------------------------------------
+{
+    if (x->order() < 0)
+        return bignum::make(0);
+    size_t   bits = mantissa_bits(digits);
+    bignum_g m    = x->mantissa();
+    int      e    = x->exponent();
+    if (e >= 0)
+        return mantissa_mul(m, ten_power(e), bits);
+
+    bool neg = m->type() == object::ID_neg_bignum;
+    bignum_g scale = ten_power(-e);
+    bignum_g q, r;
+    if (!bignum::quorem(m, scale, object::ID_bignum, &q, &r))
+        return nullptr;
+    r = mantissa_add(r, r, bits);
+    if (bignum::compare(r, scale) >= 0)
+        q = mantissa_add(q, bignum_g(bignum::make(1)), bits);
+    if (neg)
+        q = -q;
+    return q;
+}
+
+
+
+// ============================================================================
+//
+//   Construction and conversions
+//
+// ============================================================================
+
+big_decimal_g big_decimal::make(bignum_r mantissa, int exponent, uint digits)
+// ----------------------------------------------------------------------------
+//   Round the mantissa to the given number of digits and normalize
+// ----------------------------------------------------------------------------
+{
+    if (!mantissa.Safe())
+        return nullptr;
+    bignum_g m = mantissa;
+    if (m->is_zero())
+        return rt.make<big_decimal>(m, 0);
+
+    bool neg = m->type() == ID_neg_bignum;
+    if (neg)
+        m = -m;
+    if (digits < 1)
+        digits = 1;
+
+    // Round to nearest, ties away from zero
+    uint count = digit_count(m);
+    if (count > digits)
+    {
+        uint     drop  = count - digits;
+        size_t   bits  = digit_bits(count + 1);
+        bignum_g scale = ten_power(drop);
+        bignum_g q, r;
+        if (!bignum::quorem(m, scale, ID_bignum, &q, &r))
+            return nullptr;
+        r = mantissa_add(r, r, bits);
+        if (bignum::compare(r, scale) >= 0)
+            q = mantissa_add(q, bignum_g(bignum::make(1)), bits);
+        m = q;
+        exponent += drop;
+    }
+
+    // Strip trailing zeroes
+    bignum_g ten = bignum::make(10);
+    while (m)
+    {
+        bignum_g q, r;
+        if (!bignum::quorem(m, ten, ID_bignum, &q, &r))
+            return nullptr;
+        if (!r->is_zero())
+            break;
+        m = q;
+        exponent++;
+    }
+    if (!m)
+        return nullptr;
+
+    if (neg)
+        m = -m;
+    return rt.make<big_decimal>(m, exponent);
+}
+
+
+big_decimal_g big_decimal::constant(large value, int exponent)
+// ----------------------------------------------------------------------------
+//   Build a constant from an integer value and exponent
+// ----------------------------------------------------------------------------
+{
+    bignum_g m = bignum::make(value);
+    return make(m, exponent, 20);
+}
+
+
+big_decimal_g big_decimal::make(algebraic_r xr, uint digits)
+// ----------------------------------------------------------------------------
+//   Convert a real number to a variable-precision decimal
+// ----------------------------------------------------------------------------
+{
+    if (!xr.Safe())
+        return nullptr;
+
+    algebraic_g x  = xr;
+    id          xt = x->type();
+    switch(xt)
+    {
+    case ID_big_decimal:
+    {
+        big_decimal_g d = big_decimal_p(x.Safe());
+        return make(d->mantissa(), d->exponent(), digits);
+    }
+
+    case ID_integer:
+    case ID_neg_integer:
+        bignum_promotion(x);
+        // fallthrough
+    case ID_bignum:
+    case ID_neg_bignum:
+    {
+        bignum_g m = bignum_p(x.Safe());
+        return make(m, 0, digits);
+    }
+
+    case ID_fraction:
+    case ID_neg_fraction:
+    case ID_big_fraction:
+    case ID_neg_big_fraction:
+    {
+        fraction_g    f   = fraction_p(x.Safe());
+        bignum_g      n   = f->numerator();
+        bignum_g      d   = f->denominator();
+        big_decimal_g num = make(n, 0, digits + GUARD);
+        big_decimal_g den = make(d, 0, digits + GUARD);
+        return div(num, den, digits);
+    }
+
+    case ID_hwdouble:
+    case ID_decimal32:
+    case ID_decimal64:
+    case ID_decimal128:
+    {
+        if (!real_promotion(x, ID_decimal128))
+            return nullptr;
+        bid128 v = decimal128_p(x.Safe())->value();
+        char buf[64];
+        bid128_to_string(buf, &v.value);
+
+        // The BID library emits an integral mantissa, e.g. +12345E-2
+        char *exp = strchr(buf, 'E');
+        if (!exp || (buf[0] != '+' && buf[0] != '-'))
+        {
+            rt.domain_error();
+            return nullptr;
+        }
+        gcutf8   src = utf8(buf);
+        bignum_g m   = parse_digits(src, 1, exp - buf);
+        if (buf[0] == '-')
+            m = -m;
+        return make(m, atoi(exp + 1), digits);
+    }
+
+    default:
+        break;
+    }
+
+    rt.type_error();
+    return nullptr;
+}
+
+
+algebraic_p big_decimal::to_decimal128() const
+// ----------------------------------------------------------------------------
+//   Convert to the nearest decimal128 value
+// ----------------------------------------------------------------------------
+{
+    bignum_g m   = mantissa();
+    int      e   = exponent();
+    bool     neg = m->type() == ID_neg_bignum;
+    if (neg)
+        m = -m;
+
+    // Keep a few more digits than decimal128 can hold, the library rounds
+    const uint max = BID128_MAXDIGITS + 6;
+    uint count = digit_count(m);
+    if (count > max)
+    {
+        m = m / ten_power(count - max);
+        e += count - max;
+    }
+
+    text_g digits = digits_text(m);
+    if (!digits)
+        return nullptr;
+    size_t len = 0;
+    utf8   txt = digits->value(&len);
+    char   buf[80];
+    snprintf(buf, sizeof(buf), "%c%.*sE%d",
+             neg ? '-' : '+', int(len), cstring(txt), e);
+
+    bid128 v;
+    bid128_from_string(&v.value, buf);
+    return rt.make<decimal128>(ID_decimal128, v);
+}
+
+
+algebraic_p big_decimal::to_fraction() const
+// ----------------------------------------------------------------------------
+//   Exact conversion to an integer or a fraction
+// ----------------------------------------------------------------------------
+{
+    bignum_g m = mantissa();
+    int      e = exponent();
+    if (e >= 0)
+    {
+        m = m * ten_power(e);
+        return m.Safe();
+    }
+    bignum_g d = ten_power(-e);
+    fraction_g f = big_fraction::make(m, d);
+    return f.Safe();
+}
+
+
+bool big_decimal::is_one() const
+// ----------------------------------------------------------------------------
+//   Normalized values make this test simple
+// ----------------------------------------------------------------------------
+{
+    return exponent() == 0 && !is_negative() && mantissa()->is(1);
+}
+
+
+big_decimal_g big_decimal::neg() const
+// ----------------------------------------------------------------------------
+//   Negate the value
+// ----------------------------------------------------------------------------
+{
+    int      e = exponent();
+    bignum_g m = mantissa();
+    m = -m;
+    return rt.make<big_decimal>(m, e);
+}
+
+
+big_decimal_g big_decimal::abs() const
+// ----------------------------------------------------------------------------
+//   Absolute value
+// ----------------------------------------------------------------------------
+{
+    if (is_negative())
+        return neg();
+    return this;
+}
+
+
+int big_decimal::order() const
+// ----------------------------------------------------------------------------
+//   Return n such that 10^(n-1) <= |x| < 10^n
+// ----------------------------------------------------------------------------
+{
+    bignum_g m = mantissa();
+    int      e = exponent();
+    return e + digit_count(m);
+}
+
+
+int big_decimal::compare(big_decimal_r x, big_decimal_r y)
+// ----------------------------------------------------------------------------
+//   Exact comparison of two values
+// ----------------------------------------------------------------------------
+{
+    int sx = x->is_zero() ? 0 : x->is_negative() ? -1 : 1;
+    int sy = y->is_zero() ? 0 : y->is_negative() ? -1 : 1;
+    if (sx != sy)
+        return sx < sy ? -1 : 1;
+    if (!sx)
+        return 0;
+
+    int ox = x->order();
+    int oy = y->order();
+    if (ox != oy)
+        return (ox < oy) == (sx > 0) ? -1 : 1;
+
+    // Same order of magnitude: align exponents and compare mantissas
+    bignum_g mx = x->mantissa();
+    bignum_g my = y->mantissa();
+    int      ex   = x->exponent();
+    int      ey   = y->exponent();
+    size_t   bits = digit_bits(ox - (ex < ey ? ex : ey) + 1);
+    if (ex > ey)
+        mx = mantissa_mul(mx, ten_power(ex - ey), bits);
+    else if (ey > ex)
+        my = mantissa_mul(my, ten_power(ey - ex), bits);
+    int cmp = bignum::compare(mx, my);
+    return cmp < 0 ? -1 : cmp > 0 ? 1 : 0;
+}
+
+
+
+// ============================================================================
+//
+//   Arithmetic kernels
+//
+// ============================================================================
+
+big_decimal_g big_decimal::add(big_decimal_r x, big_decimal_r y,
+                               uint digits, bool subtract)
+// ----------------------------------------------------------------------------
+//   Add or subtract two values, rounding to the given number of digits
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe() || !y.Safe())
+        return nullptr;
+    bignum_g mx = x->mantissa();
+    bignum_g my = y->mantissa();
+    int      ex = x->exponent();
+    int      ey = y->exponent();
+    if (subtract)
+        my = -my;
+    if (my->is_zero())
+        return make(mx, ex, digits);
+    if (mx->is_zero())
+        return make(my, ey, digits);
+
+    // If one value is negligible, do not align on its exponent
+    int ox = ex + digit_count(mx);
+    int oy = ey + digit_count(my);
+    if (ox - oy > int(digits) + 2)
+        return make(mx, ex, digits);
+    if (oy - ox > int(digits) + 2)
+        return make(my, ey, digits);
+
+    size_t bits = mantissa_bits(digits);
+    int    e    = ex < ey ? ex : ey;
+    if (ex > e)
+        mx = mantissa_mul(mx, ten_power(ex - e), bits);
+    if (ey > e)
+        my = mantissa_mul(my, ten_power(ey - e), bits);
+    return make(mantissa_add(mx, my, bits), e, digits);
+}
+
+
+big_decimal_g big_decimal::mul(big_decimal_r x, big_decimal_r y, uint digits)
+// ----------------------------------------------------------------------------
+//   Multiply two values
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe() || !y.Safe())
+        return nullptr;
+    bignum_g mx = x->mantissa();
+    bignum_g my = y->mantissa();
+    bignum_g mp = mantissa_mul(mx, my, mantissa_bits(digits));
+    return make(mp, x->exponent() + y->exponent(), digits);
+}
+
+
+big_decimal_g big_decimal::div(big_decimal_r x, big_decimal_r y, uint digits)
+// ----------------------------------------------------------------------------
+//   Divide two values, computing two more digits than needed for rounding
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe() || !y.Safe())
+        return nullptr;
+    bignum_g mx = x->mantissa();
+    bignum_g my = y->mantissa();
+    if (my->is_zero())
+    {
+        rt.zero_divide_error();
+        return nullptr;
+    }
+    if (mx->is_zero())
+        return x;
+
+    int shift = int(digits) + 2 + int(digit_count(my)) - int(digit_count(mx));
+    if (shift < 0)
+        shift = 0;
+    if (shift)
+        mx = mantissa_mul(mx, ten_power(shift), mantissa_bits(digits));
+    return make(mx / my, x->exponent() - y->exponent() - shift, digits);
+}
+
+
+static bignum_g isqrt(bignum_r n)
+// ----------------------------------------------------------------------------
+//   Integer square root using Newton's method from above
+// ----------------------------------------------------------------------------
+{
+    uint     count = digit_count(n);
+    size_t   bits  = digit_bits(count + 1);
+    bignum_g x     = ten_power((count + 1) / 2);
+    bignum_g two   = bignum::make(2);
+    while (x)
+    {
+        bignum_g y = mantissa_add(x, n / x, bits) / two;
+        if (!y)
+            return nullptr;
+        if (bignum::compare(y, x) >= 0)
+            break;
+        x = y;
+    }
+    return x;
+}
+
+
+big_decimal_g big_decimal::sqrt(big_decimal_r x, uint digits)
+// ----------------------------------------------------------------------------
+//   Square root
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe())
+        return nullptr;
+    if (x->is_zero())
+        return x;
+    if (x->is_negative())
+    {
+        rt.domain_error();
+        return nullptr;
+    }
+
+    // Scale the mantissa to twice the digits with an even exponent
+    bignum_g m     = x->mantissa();
+    int      e     = x->exponent();
+    int      shift = 2 * (int(digits) + 2) - int(digit_count(m));
+    if (shift < 0)
+        shift = 0;
+    if ((e - shift) % 2)
+        shift++;
+    if (shift)
+        m = mantissa_mul(m, ten_power(shift), mantissa_bits(digits));
+    return make(isqrt(m), (e - shift) / 2, digits);
+}
+
+
+
+// ============================================================================
+//
+//   Transcendental kernels
+//
+// ============================================================================
+
+static inline bool negligible(big_decimal_r term, big_decimal_r sum, uint digits)
+// ----------------------------------------------------------------------------
+//   Check if a series term no longer contributes to the sum
+// ----------------------------------------------------------------------------
+{
+    return !term.Safe() || term->is_zero() ||
+        (!sum->is_zero() && term->order() < sum->order() - int(digits));
+}
+
+
+big_decimal_g big_decimal::exp(big_decimal_r x, uint digits)
+// ----------------------------------------------------------------------------
+//   Exponential, using argument halving and the Taylor series
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe())
+        return nullptr;
+    big_decimal_g one = constant(1);
+    if (x->is_zero())
+        return one;
+
+    int ox = x->order();
+    if (ox > 9)
+    {
+        if (x->is_negative())
+            return constant(0);
+        rt.domain_error();
+        return nullptr;
+    }
+
+    // Halve the argument until it is below 10^-3. Each squaring at the end
+    // doubles the relative error, so add guard digits accordingly
+    int  k    = ox > -3 ? (ox + 3) * 10 / 3 + 1 : 0;
+    uint work = digits + GUARD + k * 3 / 10;
+    big_decimal_g r = x;
+    if (k)
+    {
+        bignum_g      two   = bignum::make(2);
+        bignum_g      count = bignum::make(k);
+        bignum_g      power = bignum::pow(two, count, mantissa_bits(work));
+        big_decimal_g scale = make(power, 0, work);
+        r = div(r, scale, work);
+    }
+
+    big_decimal_g sum  = one;
+    big_decimal_g term = one;
+    for (large n = 1; term; n++)
+    {
+        big_decimal_g div_n = constant(n);
+        term = mul(term, r, work);
+        term = div(term, div_n, work);
+        if (negligible(term, sum, work))
+            break;
+        sum = add(sum, term, work);
+    }
+    while (sum && k--)
+        sum = mul(sum, sum, work);
+    if (!sum || !term)
+        return nullptr;
+    return make(sum->mantissa(), sum->exponent(), digits);
+}
+
+
+static big_decimal_g log_reduced(big_decimal_r a, uint work)
+// ----------------------------------------------------------------------------
+//   Natural logarithm for a in [1, 10], refining a decimal128 estimate
+// ----------------------------------------------------------------------------
+//   Halley's iteration y += 2 (a - e^y) / (a + e^y) triples the number of
+//   correct digits at each step
+{
+    algebraic_g a128 = a->to_decimal128();
+    if (!a128)
+        return nullptr;
+    bid128 v = decimal128_p(a128.Safe())->value();
+    bid128 l;
+    bid128_log(&l.value, &v.value);
+    algebraic_g lg = rt.make<decimal128>(object::ID_decimal128, l);
+    big_decimal_g y = big_decimal::make(lg, work);
+
+    for (uint good = BID128_MAXDIGITS - 2; y && good < work; good *= 3)
+    {
+        big_decimal_g e   = big_decimal::exp(y, work);
+        big_decimal_g num = big_decimal::add(a, e, work, true);
+        big_decimal_g den = big_decimal::add(a, e, work);
+        big_decimal_g cor = big_decimal::div(num, den, work);
+        cor = big_decimal::add(cor, cor, work);
+        y = big_decimal::add(y, cor, work);
+    }
+    return y;
+}
+
+
+big_decimal_g big_decimal::log(big_decimal_r x, uint digits)
+// ----------------------------------------------------------------------------
+//   Natural logarithm
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe())
+        return nullptr;
+    if (x->is_zero() || x->is_negative())
+    {
+        rt.domain_error();
+        return nullptr;
+    }
+
+    // Write x as a * 10^scale with a in [1, 10)
+    bignum_g m     = x->mantissa();
+    uint     count = digit_count(m);
+    int      scale = x->exponent() + int(count) - 1;
+    uint     work  = digits + GUARD;
+    for (int s = scale; s; s /= 10)
+        work++;
+
+    big_decimal_g a = make(m, 1 - int(count), work);
+    big_decimal_g r = log_reduced(a, work);
+    if (r && scale)
+    {
+        big_decimal_g ten  = constant(10);
+        big_decimal_g ln10 = log_reduced(ten, work);
+        big_decimal_g s    = constant(scale);
+        r = add(r, mul(ln10, s, work), work);
+    }
+    if (!r)
+        return nullptr;
+    return make(r->mantissa(), r->exponent(), digits);
+}
+
+
+static big_decimal_g atan_inverse(large n, uint work)
+// ----------------------------------------------------------------------------
+//   Compute atan(1/n) with the series for small arguments
+// ----------------------------------------------------------------------------
+{
+    big_decimal_g one  = big_decimal::constant(1);
+    big_decimal_g nb   = big_decimal::constant(n);
+    big_decimal_g n2   = big_decimal::constant(n * n);
+    big_decimal_g term = big_decimal::div(one, nb, work);
+    big_decimal_g sum  = term;
+    for (large k = 1; term; k++)
+    {
+        big_decimal_g odd = big_decimal::constant(2 * k + 1);
+        term = big_decimal::div(term, n2, work);
+        big_decimal_g t = big_decimal::div(term, odd, work);
+        if (negligible(t, sum, work))
+            break;
+        sum = big_decimal::add(sum, t, work, k & 1);
+    }
+    return term ? sum : nullptr;
+}
+
+
+big_decimal_g big_decimal::pi(uint digits)
+// ----------------------------------------------------------------------------
+//   Compute pi using Machin's formula
+// ----------------------------------------------------------------------------
+{
+    uint          work = digits + GUARD;
+    big_decimal_g a    = atan_inverse(5, work);
+    big_decimal_g b    = atan_inverse(239, work);
+    big_decimal_g c16  = constant(16);
+    big_decimal_g c4   = constant(4);
+    a = mul(a, c16, work);
+    b = mul(b, c4, work);
+    return add(a, b, digits, true);
+}
+
+
+big_decimal_g big_decimal::pi()
+// ----------------------------------------------------------------------------
+//   Compute pi with the current precision
+// ----------------------------------------------------------------------------
+{
+    return pi(precision());
+}
+
+
+big_decimal_g big_decimal::sin(big_decimal_r x, uint digits, bool cosine)
+// ----------------------------------------------------------------------------
+//   Sine or cosine of x in radians
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe())
+        return nullptr;
+
+    // Large arguments need more digits of pi for the reduction
+    uint work = digits + GUARD;
+    int  ox   = x->order();
+    if (ox > 0)
+        work += ox;
+
+    // Reduce to |r| <= pi/4 and find the quadrant
+    big_decimal_g two    = constant(2);
+    big_decimal_g halfpi = pi(work);
+    halfpi = div(halfpi, two, work);
+    big_decimal_g ratio  = div(x, halfpi, work);
+    if (!ratio)
+        return nullptr;
+    bignum_g      q  = nearest(ratio, work);
+    big_decimal_g qd = make(q, 0, work);
+    big_decimal_g r  = add(x, mul(qd, halfpi, work), work, true);
+    bool          qneg = q->type() == ID_neg_bignum;
+    bignum_g      qmag = qneg ? -q : q;
+    bignum_g      four = bignum::make(4);
+    int quadrant = (qmag % four)->value<int>();
+    if (qneg)
+        quadrant = 4 - quadrant;
+    quadrant = (quadrant + (cosine ? 1 : 0)) % 4;
+
+    // Taylor series for sin(r) or cos(r)
+    bool          use_cos = quadrant & 1;
+    big_decimal_g one     = constant(1);
+    big_decimal_g r2      = mul(r, r, work);
+    big_decimal_g term    = use_cos ? one : r;
+    big_decimal_g sum     = term;
+    for (large n = use_cos ? 1 : 2; term && !term->is_zero(); n += 2)
+    {
+        big_decimal_g divisor = constant(n * (n + 1));
+        term = mul(term, r2, work);
+        term = div(term, divisor, work);
+        if (negligible(term, sum, work))
+            break;
+        term = term->neg();
+        sum = add(sum, term, work);
+    }
+    if (!sum || !term)
+        return nullptr;
+    if (quadrant & 2)
+        sum = sum->neg();
+    return make(sum->mantissa(), sum->exponent(), digits);
+}
+
+
+big_decimal_g big_decimal::atan(big_decimal_r x, uint digits)
+// ----------------------------------------------------------------------------
+//   Arc-tangent in radians
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe())
+        return nullptr;
+    if (x->is_zero())
+        return x;
+
+    uint          work   = digits + GUARD;
+    bool          neg    = x->is_negative();
+    big_decimal_g one    = constant(1);
+    big_decimal_g a      = x->abs();
+    bool          invert = compare(a, one) > 0;
+    if (invert)
+        a = div(one, a, work);
+
+    // Use atan(a) = 2 atan(a / (1 + sqrt(1 + a^2))) until a is small
+    big_decimal_g tenth = constant(1, -1);
+    uint          shift = 0;
+    while (a && compare(a, tenth) > 0)
+    {
+        big_decimal_g s = sqrt(add(one, mul(a, a, work), work), work);
+        a = div(a, add(one, s, work), work);
+        shift++;
+    }
+    if (!a)
+        return nullptr;
+
+    big_decimal_g a2   = mul(a, a, work);
+    big_decimal_g term = a;
+    big_decimal_g sum  = a;
+    for (large k = 1; term; k++)
+    {
+        big_decimal_g odd = constant(2 * k + 1);
+        term = mul(term, a2, work);
+        big_decimal_g t = div(term, odd, work);
+        if (negligible(t, sum, work))
+            break;
+        sum = add(sum, t, work, k & 1);
+    }
+    if (!term || !sum)
+        return nullptr;
+    if (shift)
+        sum = mul(sum, constant(large(1) << shift), work);
+    if (invert)
+    {
+        big_decimal_g two    = constant(2);
+        big_decimal_g halfpi = div(pi(work), two, work);
+        sum = add(halfpi, sum, work, true);
+    }
+    if (neg)
+        sum = sum->neg();
+    if (!sum)
+        return nullptr;
+    return make(sum->mantissa(), sum->exponent(), digits);
+}
+
+
+static big_decimal_g angle(big_decimal_r x, uint work, bool to)
+// ----------------------------------------------------------------------------
+//   Convert between radians and the current angle mode
+// ----------------------------------------------------------------------------
+{
+    large half = 0;
+    switch(Settings.angle_mode)
+    {
+    case settings::DEGREES:     half = 180;     break;
+    case settings::GRADS:       half = 200;     break;
+    case settings::PI_RADIANS:  half = 1;       break;
+    default:                    return x;
+    }
+    big_decimal_g pi = big_decimal::pi(work);
+    big_decimal_g h  = big_decimal::constant(half);
+    if (to)
+        return big_decimal::div(big_decimal::mul(x, h, work), pi, work);
+    return big_decimal::div(big_decimal::mul(x, pi, work), h, work);
+}
+
+
+algebraic_p big_decimal::to_angle(algebraic_r x)
+// ----------------------------------------------------------------------------
+//   Convert a result in radians to the current angle mode
+// ----------------------------------------------------------------------------
+{
+    uint          digits = precision();
+    big_decimal_g r      = big_decimal_p(x.Safe());
+    r = angle(r, digits + GUARD, true);
+    if (!r)
+        return nullptr;
+    return make(r->mantissa(), r->exponent(), digits);
+}
+
+
+
+// ============================================================================
+//
+//   Evaluation of arithmetic and functions
+//
+// ============================================================================
+
+algebraic_p big_decimal::evaluate(id op, algebraic_r xr, algebraic_r yr)
+// ----------------------------------------------------------------------------
+//   Arithmetic operations, called from arithmetic::evaluate
+// ----------------------------------------------------------------------------
+{
+    big_decimal_g x = big_decimal_p(xr.Safe());
+    big_decimal_g y = big_decimal_p(yr.Safe());
+    if (!x || !y)
+        return nullptr;
+
+    uint          digits = precision();
+    uint          work   = digits + GUARD;
+    big_decimal_g r;
+    switch(op)
+    {
+    case ID_add:        r = add(x, y, digits);                  break;
+    case ID_sub:        r = add(x, y, digits, true);            break;
+    case ID_mul:        r = mul(x, y, digits);                  break;
+    case ID_div:        r = div(x, y, digits);                  break;
+
+    case ID_mod:
+    case ID_rem:
+    {
+        // Exact remainder on aligned mantissas
+        bignum_g mx = x->mantissa();
+        bignum_g my = y->mantissa();
+        if (my->is_zero())
+        {
+            rt.zero_divide_error();
+            return nullptr;
+        }
+        size_t bits = mantissa_bits(digits);
+        int    ex   = x->exponent();
+        int    ey   = y->exponent();
+        int    e    = ex < ey ? ex : ey;
+        if (ex > e)
+            mx = mantissa_mul(mx, ten_power(ex - e), bits);
+        if (ey > e)
+            my = mantissa_mul(my, ten_power(ey - e), bits);
+        if (!mx || !my)
+            return nullptr;
+        bignum_g rm = mx % my;
+        if (op == ID_mod && rm && !rm->is_zero() &&
+            (rm->type() == ID_neg_bignum) != (my->type() == ID_neg_bignum))
+            rm = mantissa_add(rm, my, bits);
+        r = make(rm, e, digits);
+        break;
+    }
+
+    case ID_pow:
+    {
+        // Integral exponents use repeated squaring
+        if (y->exponent() >= 0 && y->order() <= 9)
+        {
+            bignum_g n   = nearest(y, work);
+            bool     neg = n->type() == ID_neg_bignum;
+            ularge   k   = n->value<ularge>();
+            uint     w   = work;
+            for (ularge b = k; b; b >>= 1)
+                w++;
+            big_decimal_g result = constant(1);
+            big_decimal_g base   = x;
+            while (k && result && base)
+            {
+                if (k & 1)
+                    result = mul(result, base, w);
+                k >>= 1;
+                if (k)
+                    base = mul(base, base, w);
+            }
+            if (neg && result)
+                result = div(constant(1), result, w);
+            r = result;
+            break;
+        }
+        if (x->is_zero())
+        {
+            if (y->is_negative())
+            {
+                rt.zero_divide_error();
+                return nullptr;
+            }
+            return x.Safe();
+        }
+        if (x->is_negative())
+        {
+            rt.domain_error();
+            return nullptr;
+        }
+
+        // x^y = exp(y ln x), the integral digits of y ln x need more digits
+        big_decimal_g l = mul(log(x, work), y, work);
+        if (l && l->order() > 0)
+            l = mul(log(x, work + l->order()), y, work + l->order());
+        r = exp(l, work);
+        break;
+    }
+
+    case ID_hypot:
+    {
+        big_decimal_g s = add(mul(x, x, work), mul(y, y, work), work);
+        r = sqrt(s, digits);
+        break;
+    }
+
+    case ID_atan2:
+    {
+        // atan2(x, y) is the angle of the point (y, x)
+        if (y->is_zero())
+        {
+            if (x->is_zero())
+            {
+                r = constant(0);
+                break;
+            }
+            r = div(pi(work), constant(x->is_negative() ? -2 : 2), work);
+            break;
+        }
+        r = atan(div(x, y, work), work);
+        if (r && y->is_negative())
+            r = add(r, pi(work), work, x->is_negative());
+        break;
+    }
+
+    default:
+        rt.type_error();
+        return nullptr;
+    }
+
+    if (!r)
+        return nullptr;
+    return make(r->mantissa(), r->exponent(), digits);
+}
+
+
+algebraic_p big_decimal::evaluate(id op, algebraic_r xr, bid128_fn op128)
+// ----------------------------------------------------------------------------
+//   Functions, called from function::evaluate
+// ----------------------------------------------------------------------------
+{
+    big_decimal_g x = big_decimal_p(xr.Safe());
+    if (!x)
+        return nullptr;
+
+    uint          digits = precision();
+    uint          work   = digits + GUARD;
+    big_decimal_g one    = constant(1);
+    big_decimal_g two    = constant(2);
+    big_decimal_g r;
+
+    // Functions like sinh or expm1 lose digits near zero
+    int small = x->is_zero() ? 0 : -x->order();
+    uint near = small > 0 ? work + small : work;
+
+    switch(op)
+    {
+    case ID_abs:
+        return x->abs().Safe();
+
+    case ID_sqrt:
+        r = sqrt(x, digits);
+        break;
+    case ID_cbrt:
+        if (x->is_zero())
+            return x.Safe();
+        r = log(x->abs(), work);
+        r = exp(div(r, constant(3), work), work);
+        if (r && x->is_negative())
+            r = r->neg();
+        break;
+
+    case ID_sin:
+    case ID_cos:
+        r = sin(angle(x, work, false), work, op == ID_cos);
+        break;
+    case ID_tan:
+    {
+        big_decimal_g a = angle(x, work, false);
+        r = div(sin(a, work, false), sin(a, work, true), work);
+        break;
+    }
+
+    case ID_asin:
+    case ID_acos:
+    {
+        int cmp = compare(x->abs(), one);
+        if (cmp > 0)
+        {
+            rt.domain_error();
+            return nullptr;
+        }
+        if (cmp == 0)
+            r = div(pi(work), x->is_negative() ? two->neg() : two, work);
+        else
+            r = atan(div(x, sqrt(add(one, mul(x, x, work), work, true), work),
+                         work), work);
+        if (op == ID_acos)
+            r = add(div(pi(work), two, work), r, work, true);
+        r = angle(r, work, true);
+        break;
+    }
+    case ID_atan:
+        r = angle(atan(x, work), work, true);
+        break;
+
+    case ID_sinh:
+    case ID_cosh:
+    case ID_tanh:
+    {
+        big_decimal_g e  = exp(x, near);
+        big_decimal_g ie = div(one, e, near);
+        big_decimal_g s  = add(e, ie, near, true);
+        big_decimal_g c  = add(e, ie, near);
+        r = op == ID_sinh ? div(s, two, near)
+          : op == ID_cosh ? div(c, two, near)
+                          : div(s, c, near);
+        break;
+    }
+    case ID_asinh:
+    {
+        big_decimal_g a = x->abs();
+        r = add(mul(a, a, near), one, near);
+        r = log(add(a, sqrt(r, near), near), near);
+        if (r && x->is_negative())
+            r = r->neg();
+        break;
+    }
+    case ID_acosh:
+        if (compare(x, one) < 0)
+        {
+            rt.domain_error();
+            return nullptr;
+        }
+        r = add(mul(x, x, work), one, work, true);
+        r = log(add(x, sqrt(r, work), work), work);
+        break;
+    case ID_atanh:
+        if (compare(x->abs(), one) >= 0)
+        {
+            rt.domain_error();
+            return nullptr;
+        }
+        r = div(add(one, x, near), add(one, x, near, true), near);
+        r = div(log(r, near), two, near);
+        break;
+
+    case ID_log1p:
+        r = log(add(one, x, near), near);
+        break;
+    case ID_expm1:
+        r = add(exp(x, near), one, near, true);
+        break;
+    case ID_log:
+        r = log(x, work);
+        break;
+    case ID_log10:
+    case ID_log2:
+    {
+        big_decimal_g base = constant(op == ID_log10 ? 10 : 2);
+        r = div(log(x, work), log(base, work), work);
+        break;
+    }
+    case ID_exp:
+        r = exp(x, work);
+        break;
+    case ID_exp10:
+    case ID_exp2:
+    {
+        // The integral digits of x ln(b) need more digits
+        big_decimal_g base = constant(op == ID_exp10 ? 10 : 2);
+        uint          w    = x->order() > 0 ? work + x->order() : work;
+        r = exp(mul(x, log(base, w), w), work);
+        break;
+    }
+
+    default:
+    {
+        // Other functions, e.g. gamma, are only available in decimal128
+        algebraic_g d = x->to_decimal128();
+        if (!d || !op128)
+        {
+            rt.type_error();
+            return nullptr;
+        }
+        bid128 v = decimal128_p(d.Safe())->value();
+        bid128 res;
+        op128(&res.value, &v.value);
+        int finite = false;
+        bid128_isFinite(&finite, &res.value);
+        if (!finite)
+        {
+            rt.domain_error();
+            return nullptr;
+        }
+        d = rt.make<decimal128>(ID_decimal128, res);
+        r = make(d, digits);
+        break;
+    }
+    }
+
+    if (!r)
+        return nullptr;
+    return make(r->mantissa(), r->exponent(), digits);
+}
+
+
+
+// ============================================================================
+//
+//   Object interface
+//
+// ============================================================================
+
+SIZE_BODY(big_decimal)
+// ----------------------------------------------------------------------------
+//   Exponent followed by an embedded bignum
+// ----------------------------------------------------------------------------
+{
+    byte_p p = o->payload();
+    p = leb128skip(p);
+    return ptrdiff(object_p(p)->skip(), o);
+}
+
+
+PARSE_BODY(big_decimal)
+// ----------------------------------------------------------------------------
+//   Parse numbers that do not fit in decimal128
+// ----------------------------------------------------------------------------
+//   This is only reached when the decimal128 parser rejected the input,
+//   e.g. because it has too many digits
+{
+    if (Settings.precision <= BID128_MAXDIGITS)
+        return SKIP;
+
+    gcutf8 source = p.source;
+    utf8   s      = source;
+    utf8   last   = s + p.length;
+    bool   neg    = false;
+
+    // Skip leading sign
+    if (*s == '+' || *s == '-')
+    {
+        // In an equation, `1 + 3` should interpret `+` as an infix
+        if (p.precedence < 0)
+            return SKIP;
+        neg = *s == '-';
+        s++;
+    }
+
+    // Mantissa digits, with an optional decimal separator
+    utf8 digits = s;
+    while (s < last && (*s >= '0' && *s <= '9'))
+        s++;
+    int  decimals = 0;
+    bool hadDecimalDot = s < last && (*s == '.' || *s == ',');
+    if (hadDecimalDot)
+    {
+        utf8 frac = ++s;
+        while (s < last && (*s >= '0' && *s <= '9'))
+            s++;
+        decimals = s - frac;
+    }
+    if (s - digits - hadDecimalDot == 0)
+        return SKIP;
+    size_t mstart = digits - source.Safe();
+    size_t mend   = s - source.Safe();
+
+    // Exponent
+    int exponent = 0;
+    if (s < last &&
+        (*s == 'e' || *s == 'E' || utf8_codepoint(s) == Settings.exponent_mark))
+    {
+        s = utf8_next(s);
+        bool eneg = *s == '-';
+        if (*s == '+' || *s == '-')
+            s++;
+        utf8 expval = s;
+        while (s < last && (*s >= '0' && *s <= '9'))
+        {
+            exponent = exponent * 10 + (*s++ - '0');
+            if (exponent > 100000000)
+            {
+                rt.exponent_range_error().source(s);
+                return ERROR;
+            }
+        }
+        if (s == expval)
+        {
+            rt.exponent_error().source(s);
+            return ERROR;
+        }
+        if (eneg)
+            exponent = -exponent;
+    }
+    size_t end = s - source.Safe();
+
+    record(big_decimal, "Parsing %u characters, exponent %d, %d decimals",
+           end, exponent, decimals);
+    bignum_g m = parse_digits(source, mstart, mend);
+    if (!m)
+        return ERROR;
+    if (neg)
+        m = -m;
+    p.end = end;
+    p.out = make(m, exponent - decimals, precision()).Safe();
+    return p.out ? OK : ERROR;
+}
+
+
+RENDER_BODY(big_decimal)
+// ----------------------------------------------------------------------------
+//   Render a variable-precision decimal
+// ----------------------------------------------------------------------------
+//   On the stack, use the same formatting as decimal128 for the leading
+//   digits. When editing or saving, emit all digits
+{
+    bignum_g m   = o->mantissa();
+    int      e   = o->exponent();
+    bool     neg = o->is_negative();
+    if (neg)
+        m = -m;
+    text_g digits = digits_text(m);
+    if (!digits)
+        return 0;
+    size_t count   = 0;
+    utf8   txt     = digits->value(&count);
+    int    realexp = e + int(count) - 1;
+
+    if (r.stack())
+    {
+        // Pass leading digits to decimal_format in the BID library format
+        const size_t max = BID128_MAXDIGITS + 2;
+        size_t shown = count < max ? count : max;
+        char buf[256];
+        snprintf(buf, sizeof(buf), "%c%.*sE%d",
+                 neg ? '-' : '+', int(shown), cstring(txt),
+                 e + int(count - shown));
+        size_t sz = decimal_format(buf, sizeof(buf), false, false);
+        return r.put(buf, sz) ? r.size() : 0;
+    }
+
+    bool    raw     = r.file_save();
+    char    decimal = raw ? '.' : Settings.decimal_mark;
+    unicode expmark = raw ? 'E' : Settings.exponent_mark;
+    if (neg)
+        r.put('-');
+
+    if (realexp >= 0 && realexp < int(count))
+    {
+        // Positional notation, e.g. 3.14159
+        txt = digits->value(&count);
+        r.put(utf8(txt), realexp + 1);
+        r.put(decimal);
+        txt = digits->value(&count);
+        r.put(utf8(txt) + realexp + 1, count - realexp - 1);
+    }
+    else if (realexp < 0 && realexp > -6)
+    {
+        // Leading zeroes, e.g. 0.000123
+        r.put('0');
+        r.put(decimal);
+        for (int z = realexp + 1; z < 0; z++)
+            r.put('0');
+        txt = digits->value(&count);
+        r.put(utf8(txt), count);
+    }
+    else
+    {
+        // Scientific notation, e.g. 1.234E-20
+        txt = digits->value(&count);
+        r.put(char(txt[0]));
+        r.put(decimal);
+        txt = digits->value(&count);
+        r.put(utf8(txt) + 1, count - 1);
+        r.put(expmark);
+        char expbuf[16];
+        snprintf(expbuf, sizeof(expbuf), "%d", realexp);
+        r.put(expbuf);
+    }
+    return r.size();
+}
@@ -0,0 +1,130 @@
+#ifndef BIG_DECIMAL_H
+#define BIG_DECIMAL_H
+// ****************************************************************************
+//  big_decimal.h                                                 DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Variable-precision decimal numbers, used when Precision exceeds
+//      what the decimal128 representation can hold
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+//
+// Payload format:
+//
+//   The payload begins with a signed LEB128 decimal exponent, followed by
+//   an embedded bignum object (ID_bignum or ID_neg_bignum, size and bytes)
+//   holding the mantissa. The value is mantissa * 10^exponent.
+//
+//   Values are kept normalized: the mantissa is rounded to the requested
+//   number of digits, and has no trailing decimal zeroes.
+//
+//   All computations reuse the bignum kernels, so the cost scales with the
+//   number of digits selected with the Precision setting.
+
+#include "algebraic.h"
+#include "bignum.h"
+#include "runtime.h"
+#include "settings.h"
+
+// Maximum number of digits that can be selected with Precision
+#define BIG_DECIMAL_MAXDIGITS   1000
+
+GCP(big_decimal);
+
+struct big_decimal : algebraic
+// ----------------------------------------------------------------------------
+//   A variable-precision decimal number
+// ----------------------------------------------------------------------------
+{
+    big_decimal(bignum_r mantissa, int exponent, id type = ID_big_decimal)
+        : algebraic(type)
+    {
+        byte *p = (byte *) payload(this);
+        p = leb128(p, exponent);
+        memcpy(p, (byte_p) bignum_p(mantissa), mantissa->size());
+    }
+
+    static size_t required_memory(id i, bignum_r mantissa, int exponent)
+    {
+        return leb128size(i) + leb128size(exponent) + mantissa->size();
+    }
+
+    int exponent() const
+    {
+        byte_p p = payload();
+        return leb128<int>(p);
+    }
+
+    bignum_g mantissa() const
+    {
+        byte_p p = payload();
+        p = leb128skip(p);
+        return bignum_p(p);
+    }
+
+    bool is_zero() const        { return mantissa()->is_zero(); }
+    bool is_negative() const    { return mantissa()->type() == ID_neg_bignum; }
+    bool is_one() const;
+
+    // Number of significant digits used for computations
+    static uint precision()     { return Settings.precision; }
+
+    // Build a normalized value rounded to the given number of digits
+    static big_decimal_g make(bignum_r mantissa, int exponent, uint digits);
+    static big_decimal_g make(algebraic_r x, uint digits = precision());
+    static big_decimal_g constant(large value, int exponent = 0);
+
+    // Conversion to decimal128 for library functions and graphics
+    algebraic_p to_decimal128() const;
+    algebraic_p to_fraction() const;
+
+    // Evaluation of arithmetic and functions
+    static algebraic_p evaluate(id op, algebraic_r x, algebraic_r y);
+    static algebraic_p evaluate(id op, algebraic_r x, bid128_fn op128);
+    static algebraic_p to_angle(algebraic_r x);
+    static int         compare(big_decimal_r x, big_decimal_r y);
+
+    // Kernels, computing with the given number of digits
+    static big_decimal_g add(big_decimal_r x, big_decimal_r y, uint digits,
+                             bool subtract = false);
+    static big_decimal_g mul(big_decimal_r x, big_decimal_r y, uint digits);
+    static big_decimal_g div(big_decimal_r x, big_decimal_r y, uint digits);
+    static big_decimal_g sqrt(big_decimal_r x, uint digits);
+    static big_decimal_g exp(big_decimal_r x, uint digits);
+    static big_decimal_g log(big_decimal_r x, uint digits);
+    static big_decimal_g sin(big_decimal_r x, uint digits, bool cosine);
+    static big_decimal_g atan(big_decimal_r x, uint digits);
+    static big_decimal_g pi(uint digits);
+    static big_decimal_g pi();
+
+    big_decimal_g neg() const;
+    big_decimal_g abs() const;
+    int           order() const;
+
+public:
+    OBJECT_DECL(big_decimal);
+    PARSE_DECL(big_decimal);
+    SIZE_DECL(big_decimal);
+    RENDER_DECL(big_decimal);
+};
+
+#endif // BIG_DECIMAL_H
@@ -144,18 +144,82 @@ static size_t render_num(renderer &r,
         space = 0;
     }
 
-    // Copy the '#' or '-' sign
-    if (*fmt)
-        r.put(*fmt++);
-
     // Get denominator for the base
     object::id ntype = num->type();
     size_t findex = r.size();
     bignum_g b = rt.make<bignum>(ntype, base);
     bignum_g n = (bignum *) num;
 
+    // Check how many digits fit when the output is bounded, e.g. on stack
+    size_t room = r.budget();
+    if (!room)
+    {
+        r.truncate();
+        return r.size();
+    }
+    if (spacing)
+        room = room / (spacing + 4) * spacing;
+    size_t skip = 0;            // Low digits omitted when rendering the head
+    size_t pad  = 0;            // Digits to render when rendering the tail
+    if (size_t bits = n->bits())
+    {
+        uint log2lo = 0;
+        for (uint v = base; v > 1; v >>= 1)
+            log2lo++;
+        if ((bits + log2lo - 1) / log2lo > room)
+        {
+            bignum_g bb = bignum::make(base);
+            bignum_g p  = bignum::pow(bb, bignum_g(bignum::make(room)),
+                                      Settings.maxbignum);
+            bignum_g q  = nullptr;
+            bignum_g m  = nullptr;
+            if (r.tail())
+            {
+                // Tail: the last digits are the value modulo base^room
+                if (!p || !bignum::quorem(n, p, bignum::ID_bignum, &q, &m))
+                    return 0;
+                n = m;
+                pad = room;
+            }
+            else
+            {
+                // Head: divide by base^skip for an under-estimated skip,
+                // then adjust until we have exactly the digits that fit
+                uint   log2hi = log2lo + ((base & (base - 1)) != 0);
+                size_t mindig = (bits - 1) / log2hi + 1;
+                if (mindig > room)
+                {
+                    skip = mindig - room;
+                    bignum_g s = bignum::make(skip);
+                    bignum_g d = bignum::pow(bb, s, Settings.maxbignum);
+                    if (!d || !bignum::quorem(n, d, bignum::ID_bignum, &q, &m))
+                        return 0;
+                    n = q;
+                }
+                while (p && bignum::compare(n, p, true) >= 0)
+                {
+                    if (!bignum::quorem(n, bb, bignum::ID_bignum, &q, &m))
+                        return 0;
+                    n = q;
+                    skip++;
+                }
+                r.truncate();
+            }
+        }
+    }
+
+    // Copy the '#' or '-' sign, unless we only render the tail
+    if (*fmt)
+    {
+        if (!pad)
+            r.put(*fmt);
+        fmt++;
+        findex = r.size();
+    }
+
     // Keep dividing by the base until we get 0
-    uint sep = 0;
+    uint sep = spacing ? skip % spacing : 0;
+    size_t digits = 0;
     do
     {
         bignum_g remainder = nullptr;
@@ -171,21 +235,26 @@ static size_t render_num(renderer &r,
         char c = (digit < 10) ? digit + '0' : digit + ('A' - 10);
         r.put(c);
         n = quotient;
+        digits++;
 
-        if (!n->is_zero() && ++sep == spacing)
+        if ((!n->is_zero() || digits < pad) && ++sep == spacing)
         {
             sep = 0;
             r.put(space);
         }
-    } while (!n->is_zero());
+    } while (!n->is_zero() || digits < pad);
 
     // Revert the digits
     byte *dest  = (byte *) r.text();
     bool multibyte = spacing && space > 0xFF;
     utf8_reverse(dest + findex, dest + r.size(), multibyte);
 
-    // Add suffix if there is one
-    if (fancy_base)
+    // Add suffix if there is one, unless we only rendered the head
+    if (skip)
+    {
+        // Digits after the head are not rendered, nor is the suffix
+    }
+    else if (fancy_base)
     {
         static uint16_t fancy_base_digits[10] =
         {
@@ -384,7 +453,8 @@ bignum_g operator~(bignum_r x)
 }
 
 
-bignum_g bignum::add_sub(bignum_r yg, bignum_r xg, bool issub)
+bignum_g bignum::add_sub(bignum_r yg, bignum_r xg, bool issub,
+                         size_t maxbits)
 // ----------------------------------------------------------------------------
 //   Add the two bignum values, result has type of x
 // ----------------------------------------------------------------------------
@@ -404,19 +474,19 @@ bignum_g bignum::add_sub(bignum_r yg, bignum_r xg, bool issub)
         {
             // abs Y > abs X: result has opposite type of X
             id ty = cmp == 0 ? ID_bignum: issub ? xt : opposite_type(xt);
-            return binary<false>(sub_op, yg, xg, ty);
+            return binary<false>(sub_op, yg, xg, ty, maxbits);
         }
         else
         {
             // abs Y < abs X: result has type of X
             id ty = issub ? opposite_type(xt) : xt;
-            return binary<false>(sub_op, xg, yg, ty);
+            return binary<false>(sub_op, xg, yg, ty, maxbits);
         }
     }
 
     // We have the same sign, add items
     id ty = issub ? opposite_type(xt) : xt;
-    return binary<false>(add_op, yg, xg, ty);
+    return binary<false>(add_op, yg, xg, ty, maxbits);
 }
 
 
@@ -425,7 +495,7 @@ bignum_g operator+(bignum_r y, bignum_r x)
 //   Add the two bignum values, result has type of x
 // ----------------------------------------------------------------------------
 {
-    return bignum::add_sub(y, x, false);
+    return bignum::add_sub(y, x, false, Settings.maxbignum);
 }
 
 
@@ -434,7 +504,7 @@ bignum_g operator-(bignum_r y, bignum_r x)
 //   Subtract two bignum values, result has type of x
 // ----------------------------------------------------------------------------
 {
-    return bignum::add_sub(y, x, true);
+    return bignum::add_sub(y, x, true, Settings.maxbignum);
 }
 
 
@@ -443,7 +513,7 @@ bignum_g operator&(bignum_r y, bignum_r x)
 //   Perform a binary and operation
 // ----------------------------------------------------------------------------
 {
-    return bignum::binary<false>(and_op, x, y, x->type());
+    return bignum::binary<false>(and_op, x, y, x->type(), Settings.maxbignum);
 }
 
 
@@ -452,7 +522,7 @@ bignum_g operator|(bignum_r y, bignum_r x)
 //   Perform a binary or operation
 // ----------------------------------------------------------------------------
 {
-    return bignum::binary<false>(or_op, x, y, x->type());
+    return bignum::binary<false>(or_op, x, y, x->type(), Settings.maxbignum);
 }
 
 
@@ -461,11 +531,12 @@ bignum_g operator^(bignum_r y, bignum_r x)
 //   Perform a binary xor operation
 // ----------------------------------------------------------------------------
 {
-    return bignum::binary<false>(xor_op, x, y, x->type());
+    return bignum::binary<false>(xor_op, x, y, x->type(), Settings.maxbignum);
 }
 
 
-bignum_g bignum::multiply(bignum_r yg, bignum_r xg, id ty)
+bignum_g bignum::multiply(bignum_r yg, bignum_r xg, id ty,
+                          size_t maxbits)
 // ----------------------------------------------------------------------------
 //   Perform multiply operation on the two big nums, with result type ty
 // ----------------------------------------------------------------------------
@@ -478,7 +549,7 @@ bignum_g bignum::multiply(bignum_r yg, bignum_r xg, id ty)
     size_t wbits = wordsize(xt);
     size_t wbytes = (wbits + 7) / 8;
     size_t needed = xs + ys;
-    if (needed * 8 > Settings.maxbignum)
+    if (needed * 8 > maxbits)
     {
         rt.number_too_big_error();
         return nullptr;
@@ -543,7 +614,7 @@ bignum_g operator*(bignum_r y, bignum_r x)
     object::id xt = x->type();
     object::id yt = y->type();
     object::id prodtype = bignum::product_type(yt, xt);
-    return bignum::multiply(y, x, prodtype);
+    return bignum::multiply(y, x, prodtype, Settings.maxbignum);
 }
 
 
@@ -692,7 +763,7 @@ bignum_g operator%(bignum_r y, bignum_r x)
 }
 
 
-bignum_g bignum::pow(bignum_r yr, bignum_r xr)
+bignum_g bignum::pow(bignum_r yr, bignum_r xr, size_t maxbits)
 // ----------------------------------------------------------------------------
 //    Compute y^abs(x)
 // ----------------------------------------------------------------------------
@@ -711,10 +782,14 @@ bignum_g bignum::pow(bignum_r yr, bignum_r xr)
         for (uint bit = 0; xv && bit < 8; bit++)
         {
             if (xv & 1)
-                r = r * y;
+                r = multiply(r, y, product_type(r->type(), y->type()),
+                             maxbits);
             xv >>= 1;
             if (xv || xi < xs-1)
-                y = y * y;
+                y = multiply(y, y, product_type(y->type(), y->type()),
+                             maxbits);
+            if (!r || !y)
+                return nullptr;
         }
     }
     return r;
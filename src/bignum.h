@@ -151,6 +151,19 @@ struct bignum : text
         return text::value(size);
     }
 
+    // Number of significant bits in the value
+    size_t bits() const
+    {
+        size_t size = 0;
+        byte_p data = value(&size);
+        while (size && !data[size-1])
+            size--;
+        size_t result = size ? (size - 1) * 8 : 0;
+        for (byte top = size ? data[size-1] : 0; top; top >>= 1)
+            result++;
+        return result;
+    }
+
     // Creating a small integer from a bignum, or return nullptr
     integer_p as_integer() const;
 
@@ -183,14 +196,17 @@ public:
     static id product_type(id yt, id xt);
 
     template<bool extend, typename Op>
-    static bignum_g binary(Op op, bignum_r x, bignum_r y, id ty);
+    static bignum_g binary(Op op, bignum_r x, bignum_r y, id ty,
+                           size_t maxbits);
     template<bool extend, typename Op>
     static bignum_g unary(Op op, bignum_r x);
 
-    static bignum_g add_sub(bignum_r y, bignum_r x, bool subtract);
-    static bignum_g multiply(bignum_r y, bignum_r x, id ty);
+    // Operations that can grow take the maximum size of the result in bits
+    static bignum_g add_sub(bignum_r y, bignum_r x, bool subtract,
+                            size_t maxbits);
+    static bignum_g multiply(bignum_r y, bignum_r x, id ty, size_t maxbits);
     static bool quorem(bignum_r y, bignum_r x, id ty, bignum_g *q, bignum_g *r);
-    static bignum_g pow(bignum_r y, bignum_r x);
+    static bignum_g pow(bignum_r y, bignum_r x, size_t maxbits);
 
 public:
     OBJECT_DECL(bignum);
@@ -303,7 +319,8 @@ inline size_t bignum::wordsize(id type)
 
 
 template <bool extend, typename Op>
-bignum_g bignum::binary(Op op, bignum_r xg, bignum_r yg, id ty)
+bignum_g bignum::binary(Op op, bignum_r xg, bignum_r yg, id ty,
+                        size_t maxbits)
 // ----------------------------------------------------------------------------
 //   Perform binary operation op on bignum values xg and yg
 // ----------------------------------------------------------------------------
@@ -321,7 +338,7 @@ bignum_g bignum::binary(Op op, bignum_r xg, bignum_r yg, id ty)
     size_t   wbytes = (wbits + 7) / 8;
     uint16_t c      = 0;
     size_t   needed = std::max(xs, ys) + 1;
-    if (needed * 8 > Settings.maxbignum)
+    if (needed * 8 > maxbits)
     {
         rt.number_too_big_error();
         return nullptr;
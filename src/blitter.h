@@ -37,6 +37,8 @@
 #include "utf8.h"
 #include "font.h"
 
+#include <string.h>
+
 #define PACKED  __attribute__((packed))
 
 
@@ -302,18 +304,153 @@ struct blitter
         COPY        = CLIP_ALL | SKIP_COLOR,
     };
 
-    // blitop: a blitting operation
-    typedef pixword (*blitop)(pixword dst, pixword src, pixword arg);
-
-    template <clipping Clip, typename Dst, typename Src, mode CMode>
+    template <clipping Clip, typename Op,
+              typename Dst, typename Src, mode CMode>
     static void blit(Dst           &dst,
                      const Src     &src,
                      const rect    &drect,
                      const point   &spos,
-                     blitop         op,
+                     Op             op,
                      pattern<CMode> colors);
 
 
+    // =========================================================================
+    //
+    //   Operators for blit
+    //
+    // =========================================================================
+    //   Operators are functor types passed as template arguments to blit,
+    //   so that each combination of mode, clipping and operation is inlined
+    struct blitop_set
+    // -------------------------------------------------------------------------
+    //   This simply sets the color passed in arg
+    // -------------------------------------------------------------------------
+    {
+        pixword operator()(pixword UNUSED dst,
+                           pixword UNUSED src,
+                           pixword        arg) const
+        {
+            return arg;
+        }
+    };
+
+    struct blitop_source
+    // -------------------------------------------------------------------------
+    //   This simly sets the color from the source
+    // -------------------------------------------------------------------------
+    {
+        pixword operator()(pixword UNUSED dst,
+                           pixword        src,
+                           pixword UNUSED arg) const
+        {
+            return src;
+        }
+    };
+
+    template<mode Mode>
+    struct blitop_mono_fg
+    // ------------------------------------------------------------------------
+    //   1-BPP to N-BPP foreground color conversion (used for text drawing)
+    // ------------------------------------------------------------------------
+    {
+        pixword operator()(pixword dst, pixword src, pixword arg) const;
+    };
+
+    template<mode Mode>
+    struct blitop_mono_bg
+    // -------------------------------------------------------------------------
+    //   Bitmap baground colorization (1bpp destination)
+    // -------------------------------------------------------------------------
+    {
+        pixword operator()(pixword dst, pixword src, pixword arg) const
+        {
+            return blitop_mono_fg<Mode>()(dst, ~src, arg);
+        }
+    };
+
+    struct blitop_invert
+    // -------------------------------------------------------------------------
+    //   Inverting colors can always be achieved with a simple xor
+    // -------------------------------------------------------------------------
+    {
+        pixword operator()(pixword UNUSED dst, pixword src, pixword arg) const
+        {
+            return src ^ arg;
+        }
+    };
+
+    struct blitop_nop
+    // ------------------------------------------------------------------------
+    //   No graphical operation
+    // ------------------------------------------------------------------------
+    {
+        pixword operator()(pixword dst, pixword UNUSED s, pixword UNUSED a) const
+        {
+            return dst;
+        }
+    };
+
+
+    struct glyph_run
+    // ------------------------------------------------------------------------
+    //   Glyphs of a text resolved ahead of time to be drawn together
+    // ------------------------------------------------------------------------
+    //   Glyphs are merged into a 1bpp buffer a band of rows at a time,
+    //   so that each destination word is only written once per band,
+    //   even if several narrow glyphs share it.
+    {
+        enum { GLYPHS = 16, WORDS = 128 };
+
+        struct placed
+        {
+            const pixword *bitmap;      // Word-aligned bitmap for the glyph
+            uint           bx;          // X position in bitmap
+            uint           by;          // Y position in bitmap
+            uint           bw;          // Width of bitmap
+            rect           box;         // Where the glyph is drawn
+        };
+
+        glyph_run(): count(0), bounds() {}
+
+        bool add(coord x, coord y, const font::glyph_info &g)
+        // --------------------------------------------------------------------
+        //   Add a glyph to the run, return false if the run is full
+        // --------------------------------------------------------------------
+        {
+            if (!g.w || !g.h)
+                return true;
+            rect box(x + g.x, y + g.y, x + g.x + g.w - 1, y + g.y + g.h - 1);
+            if (count)
+            {
+                if (count >= GLYPHS)
+                    return false;
+                rect all = bounds | box;
+                if (all.x2 - all.x1 >= (WORDS / 2 - 1) * BPW)
+                    return false;
+                bounds = all;
+            }
+            else
+            {
+                bounds = box;
+            }
+
+            // Bitmap may be misaligned, if so, fixup
+            uintptr_t bma = (uintptr_t) g.bitmap;
+            placed   &p   = glyphs[count++];
+            p.bitmap = (const pixword *) (bma & ~3);
+            p.bx = g.bx + 8 * (bma & 3);
+            p.by = g.by;
+            p.bw = g.bw;
+            p.box = box;
+            return true;
+        }
+
+        uint   count;               // Number of glyphs in the run
+        rect   bounds;              // Bounding rectangle of all glyphs
+        placed glyphs[GLYPHS];      // Glyphs to draw
+    };
+
+
     // ========================================================================
     //
     //   Surface: a bitmap for graphic operations
@@ -374,7 +511,7 @@ struct blitter
         //   Fill a rectangle
         // --------------------------------------------------------------------
         {
-            blit<Clip>(*this, *this, r, point(), blitop_set, colors);
+            blit<Clip>(*this, *this, r, point(), blitop_set(), colors);
         }
 
         template<clipping Clip = FILL_SAFE>
@@ -396,6 +533,50 @@ struct blitter
             fill<Clip>(drawable, colors);
         }
 
+        template<clipping Clip = FILL_SAFE>
+        void line(coord x1, coord y1, coord x2, coord y2,
+                  pattern colors = pattern::black)
+        // --------------------------------------------------------------------
+        //   Draw a line, filling one run of pixels at a time
+        // --------------------------------------------------------------------
+        //   This uses Bresenham's algorithm, but instead of drawing each
+        //   pixel, it fills the horizontal or vertical runs of pixels
+        {
+            coord adx = x2 > x1 ? x2 - x1 : x1 - x2;
+            coord ady = y2 > y1 ? y2 - y1 : y1 - y2;
+            bool  steep = ady > adx;
+            coord t;
+            if (steep)
+            {
+                t = x1; x1 = y1; y1 = t;
+                t = x2; x2 = y2; y2 = t;
+                t = adx; adx = ady; ady = t;
+            }
+            if (x1 > x2)
+            {
+                t = x1; x1 = x2; x2 = t;
+                t = y1; y1 = y2; y2 = t;
+            }
+
+            coord ystep = y1 < y2 ? 1 : -1;
+            coord err = adx / 2;
+            coord start = x1;
+            for (coord x = x1; x <= x2; x++)
+            {
+                err -= ady;
+                if (err < 0 || x == x2)
+                {
+                    if (steep)
+                        fill<Clip>(y1, start, y1, x, colors);
+                    else
+                        fill<Clip>(start, y1, x, y1, colors);
+                    y1 += ystep;
+                    err += adx;
+                    start = x + 1;
+                }
+            }
+        }
+
         template<clipping Clip = COPY>
         void copy(surface &src, const rect &r,
                   const point &spos = point(0,0),
@@ -404,7 +585,7 @@ struct blitter
         //   Copy a rectangular area from the source
         // --------------------------------------------------------------------
         {
-            blit<Clip>(*this, src, r, spos, blitop_source, clear);
+            blit<Clip>(*this, src, r, spos, blitop_source(), clear);
         }
 
         template<clipping Clip = COPY>
@@ -426,13 +607,14 @@ struct blitter
             size  w = src.width;
             size  h = src.height;
             rect  dest(x, y, x + w - 1, y + h - 1);
-            blit<Clip>(*this, src, dest, point(), blitop_source, clr);
+            blit<Clip>(*this, src, dest, point(), blitop_source(), clr);
         }
 
-        template<clipping Clip = CLIP_DST>
+        template<clipping Clip = CLIP_DST,
+                 typename Op = blitop_mono_fg<Mode>>
         coord glyph(coord x, coord y, unicode codepoint, const font *f,
                     pattern colors = pattern::black,
-                    blitop op = blitop_mono_fg<Mode>);
+                    Op op = Op());
         // --------------------------------------------------------------------
         //   Draw a glyph with the given operation and colors
         // --------------------------------------------------------------------
@@ -444,10 +626,11 @@ struct blitter
         //   Draw a glyph with a foreground and background
         // --------------------------------------------------------------------
 
-        template<clipping Clip = CLIP_DST>
+        template<clipping Clip = CLIP_DST,
+                 typename Op = blitop_mono_fg<Mode>>
         coord text(coord x, coord y, utf8 text, const font *f,
                    pattern colors = pattern::black,
-                   blitop op = blitop_mono_fg<Mode>);
+                   Op op = Op());
         // --------------------------------------------------------------------
         //   Draw a text with the given operation and colors
         // --------------------------------------------------------------------
@@ -459,10 +642,11 @@ struct blitter
         //   Draw a text with a foreground and background
         // --------------------------------------------------------------------
 
-        template<clipping Clip = CLIP_DST>
+        template<clipping Clip = CLIP_DST,
+                 typename Op = blitop_mono_fg<Mode>>
         coord text(coord x, coord y, utf8 text, size_t len, const font *f,
                    pattern colors = pattern::black,
-                   blitop op = blitop_mono_fg<Mode>);
+                   Op op = Op());
         // --------------------------------------------------------------------
         //   Draw a text with the given operation and colors
         // --------------------------------------------------------------------
@@ -473,7 +657,14 @@ struct blitter
         // --------------------------------------------------------------------
         //   Draw a text with a foreground and background
         // --------------------------------------------------------------------
+
     protected:
+        template<clipping Clip, typename Op>
+        void glyphs(const glyph_run &run, pattern colors, Op op);
+        // --------------------------------------------------------------------
+        //   Draw a run of glyphs with the given operation and colors
+        // --------------------------------------------------------------------
+
         offset pixel_offset(coord x, coord y) const
         // ---------------------------------------------------------------------
         //   Offset in words in a given surface for the given coordinates
@@ -565,66 +756,59 @@ protected:
 
 
 
-    // =========================================================================
-    //
-    //   Operators for blit
-    //
-    // =========================================================================
-public:
-    static pixword blitop_set(pixword UNUSED dst,
-                              pixword UNUSED src,
-                              pixword        arg)
-    // -------------------------------------------------------------------------
-    //   This simply sets the color passed in arg
-    // -------------------------------------------------------------------------
+protected:
+    template <typename Op, typename Ref>
+    struct is_blitop
+    // ------------------------------------------------------------------------
+    //   Check at compile time if an operation is a given one
+    // ------------------------------------------------------------------------
     {
-        return arg;
-    }
+        enum { value = false };
+    };
 
-    static pixword blitop_source(pixword UNUSED dst,
-                                 pixword        src,
-                                 pixword UNUSED arg)
-    // -------------------------------------------------------------------------
-    //   This simly sets the color from the source
-    // -------------------------------------------------------------------------
+    template <typename Op>
+    struct is_blitop<Op, Op>
     {
-        return src;
-    }
+        enum { value = true };
+    };
 
-    template<mode Mode>
-    static pixword blitop_mono_fg(pixword dst, pixword src, pixword arg);
+    static inline void fill_words(pixword *dp, size_t count, pixword value)
     // ------------------------------------------------------------------------
-    //   1-BPP to N-BPP foreground color conversion (used for text drawing)
+    //   Fill a run of whole words, using memset if the bytes are all equal
     // ------------------------------------------------------------------------
-
-
-
-    template<mode Mode>
-    static pixword blitop_mono_bg(pixword dst, pixword src, pixword arg)
-    // -------------------------------------------------------------------------
-    //   Bitmap baground colorization (1bpp destination)
-    // -------------------------------------------------------------------------
     {
-        return blitop_mono_fg<Mode>(dst, ~src, arg);
-    }
-
-
-    static pixword blitop_invert(pixword dst, pixword src, pixword arg)
-    // -------------------------------------------------------------------------
-    //   Inverting colors can always be achieved with a simple xor
-    // -------------------------------------------------------------------------
-    {
-        dst = src ^ arg;
-        return dst;
+        if (value == (value & 0xFF) * 0x01010101U)
+            memset(dp, value & 0xFF, count * sizeof(pixword));
+        else
+            while (count--)
+                *dp++ = value;
     }
 
-
-    static pixword blitop_nop(pixword dst, pixword UNUSED s, pixword UNUSED a)
+    static void merge_bits(pixword       *dst, unsigned dbit,
+                           const pixword *src, unsigned sbit,
+                           unsigned       count)
     // ------------------------------------------------------------------------
-    //   No graphical operation
+    //   Or a run of bits from a 1bpp source into a 1bpp destination
     // ------------------------------------------------------------------------
     {
-        return dst;
+        src += sbit / BPW;
+        sbit %= BPW;
+        dst += dbit / BPW;
+        dbit %= BPW;
+        while (count)
+        {
+            unsigned n    = count < BPW ? count : unsigned(BPW);
+            pixword  bits = shr(src[0], sbit);
+            if (sbit + n > BPW)
+                bits |= shlc(src[1], sbit);
+            bits &= shrc(~0U, n);
+            dst[0] |= bits << dbit;
+            if (dbit + n > BPW)
+                dst[1] |= shrc(bits, dbit);
+            src++;
+            dst++;
+            count -= n;
+        }
     }
 };
 
@@ -945,6 +1129,7 @@ public:
 
 
 template <blitter::clipping Clip,
+          typename Op,
           typename Dst,
           typename Src,
           blitter::mode CMode>
@@ -952,7 +1137,7 @@ void blitter::blit(Dst           &dst,
                     const Src     &src,
                     const rect    &drect,
                     const point   &spos,
-                    blitop         op,
+                    Op             op,
                     pattern<CMode> colors)
 // ----------------------------------------------------------------------------
 //   Generalized multi-bpp blitting routine
@@ -1104,6 +1289,15 @@ void blitter::blit(Dst           &dst,
         ? 0
         : rotate(colors.bits, dx1 * CBPP + dy1 * cshift - dws);
 
+    // Fast path for solid fills, where whole words can be stored directly
+    bool     solid   = is_blitop<Op, blitop_set>::value && skip_src &&
+        !skip_col && !xback && DBPP == CBPP &&
+        rotate(colors.bits, CBPP) == colors.bits;
+
+    // Fast path for copies where source and destination words are aligned
+    bool     aligned = is_blitop<Op, blitop_source>::value && !skip_src &&
+        !xback && SBPP == DBPP;
+
     // Loop on all lines
     while (ycount-- >= 0)
     {
@@ -1121,7 +1315,73 @@ void blitter::blit(Dst           &dst,
         if (xback)
             sadj -= sxadj;
 
-        do
+        if (solid)
+        {
+            // Masked words at both ends, whole words in the middle
+            pixword value = cdata64;
+            if (dp1 == dp2)
+                dmask &= dmask2;
+            *dp1 = (value & dmask) | (*dp1 & ~dmask);
+            if (dp2 > dp1)
+            {
+                fill_words(dp1 + 1, dp2 - dp1 - 1, value);
+                *dp2 = (value & dmask2) | (*dp2 & ~dmask2);
+            }
+        }
+        else if (aligned && sws == dws)
+        {
+            // Read both end words first, since source and destination
+            // may overlap, then move whole words in the middle
+            size_t  words = dp2 - dp1;
+            pixword sfirst = sp[0];
+            pixword slast  = sp[words];
+            if (words)
+                memmove(dp1 + 1, sp + 1, (words - 1) * sizeof(pixword));
+            else
+                dmask &= dmask2;
+            *dp1 = (sfirst & dmask) | (*dp1 & ~dmask);
+            if (words)
+                *dp2 = (slast & dmask2) | (*dp2 & ~dmask2);
+        }
+        else if (SBPP == DBPP && !xback)
+        {
+            // Same depth: the shift between source and destination is fixed
+            // If the source starts further left in its word than the
+            // destination, the first word comes from the first source word
+            unsigned shift = sadj % BPW;
+            bool     next  = sadj < BPW;
+            do
+            {
+                xdone = dp == dp2;
+                if (xdone)
+                    dmask &= dmask2;
+
+                if (!skip_src)
+                {
+                    if (next)
+                    {
+                        sp++;
+                        smem = snew;
+                        snew = sp[0];
+                    }
+                    next = true;
+                    sdata = shift ? shlc(snew, shift) | shr(smem, shift) : smem;
+                }
+                if (!skip_col)
+                {
+                    cdata   = cdata64;
+                    cdata64 = rotate(cdata64, cxs);
+                }
+
+                pixword ddata = dp[0];
+                pixword tdata = op(ddata, sdata, cdata);
+                *dp           = (tdata & dmask) | (ddata & ~dmask);
+
+                dp++;
+                dmask = ~0U;
+            } while (!xdone);
+        }
+        else do
         {
             xdone = dp == dp2;
             if (xdone)
@@ -1214,10 +1474,10 @@ horizontal_adjust(coord &x1, coord &x2) const
 
 template <>
 inline blitter::pixword
-blitter::blitop_mono_fg<blitter::mode::MONOCHROME_REVERSE>
+blitter::blitop_mono_fg<blitter::mode::MONOCHROME_REVERSE>::operator()
         (blitter::pixword dst,
          blitter::pixword src,
-         blitter::pixword arg)
+         blitter::pixword arg) const
 // -------------------------------------------------------------------------
 //   Bitmap foreground colorization (1bpp destination)
 // -------------------------------------------------------------------------
@@ -1228,9 +1488,10 @@ blitter::blitop_mono_fg<blitter::mode::MONOCHROME_REVERSE>
 
 template <>
 inline blitter::pixword
-blitter::blitop_mono_fg<blitter::mode::MONOCHROME>(blitter::pixword dst,
-                                                     blitter::pixword src,
-                                                     blitter::pixword arg)
+blitter::blitop_mono_fg<blitter::mode::MONOCHROME>::operator()
+        (blitter::pixword dst,
+         blitter::pixword src,
+         blitter::pixword arg) const
 // -------------------------------------------------------------------------
 //   Bitmap foreground colorization (1bpp destination)
 // -------------------------------------------------------------------------
@@ -1241,9 +1502,10 @@ blitter::blitop_mono_fg<blitter::mode::MONOCHROME>(blitter::pixword dst,
 
 template <>
 inline blitter::pixword
-blitter::blitop_mono_fg<blitter::mode::GRAY_4BPP>(blitter::pixword dst,
-                                                    blitter::pixword src,
-                                                    blitter::pixword arg)
+blitter::blitop_mono_fg<blitter::mode::GRAY_4BPP>::operator()
+        (blitter::pixword dst,
+         blitter::pixword src,
+         blitter::pixword arg) const
 // -------------------------------------------------------------------------
 //   Bitmap foreground colorization (4bpp destination)
 // -------------------------------------------------------------------------
@@ -1258,9 +1520,10 @@ blitter::blitop_mono_fg<blitter::mode::GRAY_4BPP>(blitter::pixword dst,
 
 template <>
 inline blitter::pixword
-blitter::blitop_mono_fg<blitter::mode::RGB_16BPP>(blitter::pixword dst,
-                                                    blitter::pixword src,
-                                                    blitter::pixword arg)
+blitter::blitop_mono_fg<blitter::mode::RGB_16BPP>::operator()
+        (blitter::pixword dst,
+         blitter::pixword src,
+         blitter::pixword arg) const
 // -------------------------------------------------------------------------
 //   Bitmap foreground colorization (16bpp destination)
 // -------------------------------------------------------------------------
@@ -1282,13 +1545,13 @@ blitter::blitop_mono_fg<blitter::mode::RGB_16BPP>(blitter::pixword dst,
 // ============================================================================
 
 template <blitter::mode Mode>
-template <blitter::clipping Clip>
+template <blitter::clipping Clip, typename Op>
 blitter::coord blitter::surface<Mode>::glyph(coord       x,
                                                coord       y,
                                                unicode    codepoint,
                                                const font *f,
                                                pattern     colors,
-                                               blitop      op)
+                                               Op          op)
 // ----------------------------------------------------------------------------
 //   Render a glyph on the given surface
 // ----------------------------------------------------------------------------
@@ -1333,7 +1596,7 @@ blitter::coord blitter::surface<Mode>::glyph(coord       x,
         fill<Clip>(x, y, x + g.advance - 1, y + g.h - 1, bg);
         rect  dest(x + g.x, y + g.y, x + g.x + g.w - 1, y + g.y + g.h - 1);
         point spos(g.bx, g.by);
-        blit<Clip>(*this, source, dest, spos, blitop_mono_fg<Mode>, fg);
+        blit<Clip>(*this, source, dest, spos, blitop_mono_fg<Mode>(), fg);
         x += g.advance;
     }
     return x;
@@ -1341,24 +1604,21 @@ blitter::coord blitter::surface<Mode>::glyph(coord       x,
 
 
 template <blitter::mode Mode>
-template <blitter::clipping Clip>
+template <blitter::clipping Clip, typename Op>
 blitter::coord blitter::surface<Mode>::text(coord       x,
                                               coord       y,
                                               utf8        text,
                                               const font *f,
                                               pattern     colors,
-                                              blitop      op)
+                                              Op          op)
 // ----------------------------------------------------------------------------
 //   Render a glyph on the given surface
 // ----------------------------------------------------------------------------
 {
-    while (*text)
-    {
-        unicode cp = utf8_codepoint(text);
-        text = utf8_next(text);
-        x = glyph<Clip>(x, y, cp, f, colors, op);
-    }
-    return x;
+    size_t len = 0;
+    while (text[len])
+        len++;
+    return this->template text<Clip>(x, y, text, len, f, colors, op);
 }
 
 
@@ -1384,18 +1644,24 @@ blitter::coord blitter::surface<Mode>::text(coord       x,
 }
 
 template <blitter::mode Mode>
-template <blitter::clipping Clip>
+template <blitter::clipping Clip, typename Op>
 blitter::coord blitter::surface<Mode>::text(coord       x,
                                               coord       y,
                                               utf8        text,
                                               size_t      len,
                                               const font *f,
                                               pattern     colors,
-                                              blitop      op)
+                                              Op          op)
 // ----------------------------------------------------------------------------
 //   Render a glyph on the given surface
 // ----------------------------------------------------------------------------
+//   Foreground text in a solid color is drawn in runs of glyphs, see
+//   glyph_run. Other operations or patterns may not give the same result
+//   when glyphs are merged, so they draw one glyph at a time.
 {
+    bool      merge = is_blitop<Op, blitop_mono_fg<Mode>>::value &&
+        rotate(colors.bits, BPP) == colors.bits;
+    glyph_run run;
     while (len)
     {
         unicode cp = utf8_codepoint(text);
@@ -1403,13 +1669,101 @@ blitter::coord blitter::surface<Mode>::text(coord       x,
         if (sz > len)
             break;              // Defensive coding, see #101
         len -= sz;
-        x = glyph<Clip>(x, y, cp, f, colors, op);
         text += sz;
+        if (!merge)
+        {
+            x = glyph<Clip>(x, y, cp, f, colors, op);
+            continue;
+        }
+
+        font::glyph_info g;
+        if (f->glyph(cp, g))
+        {
+            if (!run.add(x, y, g))
+            {
+                glyphs<Clip>(run, colors, op);
+                run = glyph_run();
+                run.add(x, y, g);
+            }
+            x += g.advance;
+        }
     }
+    glyphs<Clip>(run, colors, op);
     return x;
 }
 
 
+template <blitter::mode Mode>
+template <blitter::clipping Clip, typename Op>
+void blitter::surface<Mode>::glyphs(const glyph_run &run,
+                                    pattern          colors,
+                                    Op               op)
+// ----------------------------------------------------------------------------
+//   Draw a run of glyphs, one band of rows at a time
+// ----------------------------------------------------------------------------
+//   The clipping is computed once for the whole run. The glyphs are then
+//   merged in a 1bpp buffer, which is drawn with a single blit per band.
+//   Positions in the buffer are computed after horizontal adjustment,
+//   so that each glyph lands where blitting it individually would put it.
+{
+    if (!run.count)
+        return;
+
+    rect bounds = run.bounds;
+    if (Clip & CLIP_DST)
+        bounds &= drawable;
+    if (bounds.x1 > bounds.x2 || bounds.y1 > bounds.y2)
+        return;
+
+    coord   left  = bounds.x1;
+    coord   right = bounds.x2;
+    horizontal_adjust(left, right);
+    int     width = right - left + 1;
+    size    wpr   = (width + BPW - 1) / BPW;
+    coord   rows  = (glyph_run::WORDS - 1) / wpr;
+    pixword buffer[glyph_run::WORDS];
+
+    for (coord top = bounds.y1; top <= bounds.y2; top += rows)
+    {
+        coord bottom = top + rows - 1;
+        if (bottom > bounds.y2)
+            bottom = bounds.y2;
+        memset(buffer, 0, ((bottom - top + 1) * wpr + 1) * sizeof(pixword));
+
+        for (uint i = 0; i < run.count; i++)
+        {
+            const glyph_run::placed &p = run.glyphs[i];
+            coord gl = p.box.x1;
+            coord gr = p.box.x2;
+            horizontal_adjust(gl, gr);
+            int col   = gl - left;
+            int skip  = col < 0 ? -col : 0;
+            int count = gr - gl + 1;
+            if (col + count > width)
+                count = width - col;
+            count -= skip;
+            coord y1 = p.box.y1 > top    ? p.box.y1 : top;
+            coord y2 = p.box.y2 < bottom ? p.box.y2 : bottom;
+            if (count <= 0 || y1 > y2)
+                continue;
+
+            pixword *dp = buffer + (y1 - top) * wpr;
+            uint     sb = (p.by + y1 - p.box.y1) * p.bw + p.bx + skip;
+            for (coord r = y1; r <= y2; r++)
+            {
+                merge_bits(dp, col + skip, p.bitmap, sb, count);
+                dp += wpr;
+                sb += p.bw;
+            }
+        }
+
+        surface<MONOCHROME> source(buffer, wpr * BPW, bottom - top + 1);
+        rect  dest(bounds.x1, top, bounds.x2, bottom);
+        blit<Clip>(*this, source, dest, point(), op, colors);
+    }
+}
+
+
 template <blitter::mode Mode>
 template <blitter::clipping Clip>
 blitter::coord blitter::surface<Mode>::text(coord       x,
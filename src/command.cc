@@ -471,6 +471,8 @@ COMMAND_BODY(Help)
 #endif // CONFIG_FIXED_BASED_OBJECTS
                 case ID_based_integer:
                 case ID_based_bignum:       topic = utf8("Based numbers"); break;
+                case ID_hwdouble:
+                case ID_big_decimal:
                 case ID_decimal128:
                 case ID_decimal64:
                 case ID_decimal32:          topic = utf8("Decimal numbers"); break;
@@ -519,6 +521,8 @@ COMMAND_BODY(ToolsMenu)
             case ID_neg_integer:
             case ID_bignum:
             case ID_neg_bignum:
+            case ID_hwdouble:
+            case ID_big_decimal:
             case ID_decimal128:
             case ID_decimal64:
             case ID_decimal32:          menu = ID_RealMenu; break;
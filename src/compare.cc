@@ -29,10 +29,12 @@
 
 #include "compare.h"
 
+#include "big_decimal.h"
 #include "decimal-32.h"
 #include "decimal-64.h"
 #include "decimal128.h"
 #include "equation.h"
+#include "hwdouble.h"
 #include "integer.h"
 #include "locals.h"
 
@@ -147,6 +149,23 @@ bool comparison::compare(int *cmp, algebraic_g x, algebraic_g y)
             bid128_quiet_greater(&rgt, &xv.value, &yv.value);
             break;
         }
+        case ID_hwdouble:
+        {
+            double xv = hwdouble_p(object_p(x))->value();
+            double yv = hwdouble_p(object_p(y))->value();
+            if (xv != xv || yv != yv)
+                return false;
+            rlt = xv < yv;
+            rgt = xv > yv;
+            break;
+        }
+        case ID_big_decimal:
+        {
+            big_decimal_g xv = big_decimal_p(object_p(x));
+            big_decimal_g yv = big_decimal_p(object_p(y));
+            *cmp = big_decimal::compare(xv, yv);
+            return true;
+        }
         default:
             return false;
         }
@@ -0,0 +1,530 @@
+// ****************************************************************************
+//  compiled.cc                                                   DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Compilation of an expression into a straight-line numeric program
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "compiled.h"
+
+#include "big_decimal.h"
+#include "decimal-32.h"
+#include "decimal-64.h"
+#include "decimal128.h"
+#include "equation.h"
+#include "functions.h"
+#include "hwdouble.h"
+#include "recorder.h"
+
+
+RECORDER(compiled, 16, "Compilation of expressions to numeric programs");
+
+
+// Library functions that do not depend on the angle mode
+#define LIBRARY_FUNCTIONS(F)                                            \
+    F(sqrt)  F(cbrt)                                                    \
+    F(sinh)  F(cosh)  F(tanh)  F(asinh) F(acosh) F(atanh)               \
+    F(log1p) F(expm1) F(log)   F(log10) F(log2)                         \
+    F(exp)   F(exp10) F(exp2)  F(erf)   F(erfc)  F(tgamma) F(lgamma)
+
+
+compiled::compiled()
+// ----------------------------------------------------------------------------
+//   Create an empty program
+// ----------------------------------------------------------------------------
+    : expr(), count(0), instructions(0), constants(0), depth(0), registers(0)
+{}
+
+
+bool compiled::prepare(const object_g &e, symbol_r var)
+// ----------------------------------------------------------------------------
+//   Prepare an expression with a single free variable
+// ----------------------------------------------------------------------------
+{
+    expr = e;
+    names[0] = var;
+    count = 1;
+    return prepare();
+}
+
+
+bool compiled::prepare(const object_g &e, list_r vars)
+// ----------------------------------------------------------------------------
+//   Prepare an expression with a list of free variables
+// ----------------------------------------------------------------------------
+{
+    expr = e;
+    count = 0;
+    for (object_p obj : *vars)
+    {
+        symbol_p name = obj->as<symbol>();
+        if (!name)
+        {
+            rt.type_error();
+            return false;
+        }
+        if (count >= MAX_VARIABLES)
+        {
+            rt.dimension_error();
+            return false;
+        }
+        names[count++] = name;
+    }
+    return prepare();
+}
+
+
+bool compiled::prepare()
+// ----------------------------------------------------------------------------
+//   Compile the expression if possible, otherwise select the slow path
+// ----------------------------------------------------------------------------
+{
+    instructions = 0;
+    constants = 0;
+    depth = 0;
+    registers = 0;
+
+    if (!expr.Safe())
+        return false;
+    object::id ty = expr->type();
+    if (!object::is_symbolic(ty))
+    {
+        rt.type_error();
+        return false;
+    }
+
+    if (!compile(expr.Safe(), 0) || depth != 1 || rt.error())
+    {
+        record(compiled, "Slow path for %t after %u instructions",
+               expr.Safe(), instructions);
+        instructions = 0;
+        return !rt.error();
+    }
+
+    record(compiled, "Compiled %t: %u instructions, %u constants, %u registers",
+           expr.Safe(), instructions, constants, registers);
+    return true;
+}
+
+
+bool compiled::compile(object_p obj, uint inlined)
+// ----------------------------------------------------------------------------
+//   Compile one component of the expression
+// ----------------------------------------------------------------------------
+{
+    object::id ty = obj->type();
+    switch(ty)
+    {
+    case object::ID_equation:
+        for (object_p item : *equation_p(obj))
+            if (!compile(item, inlined))
+                return false;
+        return true;
+
+    case object::ID_symbol:
+    {
+        symbol_p name = symbol_p(obj);
+        int var = variable(name);
+        if (var >= 0)
+            return emit(object::ID_symbol, 0, var);
+
+        // Resolve other names now, inlining stored values or equations
+        if (inlined >= MAX_INLINE)
+            return false;
+        object_p value = name->recall(true);
+        return value && compile(value, inlined + 1);
+    }
+
+    case object::ID_pi:
+    {
+        bid128 value;
+        algebraic_g pi = algebraic::pi();
+        return to_bid128(pi.Safe(), value) && constant(value);
+    }
+
+    case object::ID_TestEQ:
+        return emit(object::ID_sub, 2);
+
+    case object::ID_add:
+    case object::ID_sub:
+    case object::ID_mul:
+    case object::ID_div:
+    case object::ID_pow:
+    case object::ID_hypot:
+    case object::ID_atan2:
+        return emit(ty, 2);
+
+    case object::ID_neg:
+    case object::ID_inv:
+    case object::ID_sq:
+    case object::ID_cubed:
+    case object::ID_abs:
+    case object::ID_sin:
+    case object::ID_cos:
+    case object::ID_tan:
+    case object::ID_asin:
+    case object::ID_acos:
+    case object::ID_atan:
+#define COMPILE_FUNCTION(fn)    case object::ID_##fn:
+    LIBRARY_FUNCTIONS(COMPILE_FUNCTION)
+#undef COMPILE_FUNCTION
+        return emit(ty, 1);
+
+    default:
+        break;
+    }
+
+    // Real numbers become constants, anything else requires the slow path
+    bid128 value;
+    return object::is_real(ty) && to_bid128(obj, value) && constant(value);
+}
+
+
+bool compiled::emit(object::id op, uint arity, uint arg)
+// ----------------------------------------------------------------------------
+//   Emit an instruction, computing its register from the evaluation depth
+// ----------------------------------------------------------------------------
+{
+    if (instructions >= MAX_CODE || arity > depth)
+        return false;
+
+    uint reg = depth - arity;
+    if (arity)
+    {
+        depth -= arity - 1;
+    }
+    else
+    {
+        if (depth >= MAX_REGISTERS)
+            return false;
+        depth++;
+    }
+    if (registers < depth)
+        registers = depth;
+
+    instruction &ins = code[instructions++];
+    ins.op = op;
+    ins.reg = reg;
+    ins.arg = arg;
+    return true;
+}
+
+
+bool compiled::constant(const bid128 &value)
+// ----------------------------------------------------------------------------
+//   Emit a load for a constant value, sharing identical constants
+// ----------------------------------------------------------------------------
+{
+    uint index = 0;
+    while (index < constants &&
+           memcmp(&values[index], &value, sizeof(value)) != 0)
+        index++;
+    if (index >= constants)
+    {
+        if (constants >= MAX_CONSTANTS)
+            return false;
+        values[constants++] = value;
+    }
+    return emit(object::ID_decimal128, 0, index);
+}
+
+
+int compiled::variable(symbol_p name) const
+// ----------------------------------------------------------------------------
+//   Return the index of a free variable, or -1
+// ----------------------------------------------------------------------------
+{
+    for (uint v = 0; v < count; v++)
+        if (names[v]->is_same_as(name))
+            return v;
+    return -1;
+}
+
+
+static inline void apply(algebraic::bid128_fn fn, bid128 &x)
+// ----------------------------------------------------------------------------
+//   Apply a library function in place
+// ----------------------------------------------------------------------------
+{
+    bid128 res;
+    fn(&res.value, &x.value);
+    x = res;
+}
+
+
+bool compiled::evaluate(const bid128 vars[], bid128 &result) const
+// ----------------------------------------------------------------------------
+//   Run the program with the given values for the free variables
+// ----------------------------------------------------------------------------
+{
+    if (!instructions)
+        return substitute(vars, result);
+
+    bid128 regs[MAX_REGISTERS];
+    uint   one = 1;
+    for (uint i = 0; i < instructions; i++)
+    {
+        const instruction &ins = code[i];
+        bid128 *x = regs + ins.reg;
+        bid128 *y = x + 1;
+        bid128 res;
+
+        switch(ins.op)
+        {
+        case object::ID_symbol:
+            *x = vars[ins.arg];
+            break;
+        case object::ID_decimal128:
+            *x = values[ins.arg];
+            break;
+
+        case object::ID_add:
+            bid128_add(&res.value, &x->value, &y->value);
+            *x = res;
+            break;
+        case object::ID_sub:
+            bid128_sub(&res.value, &x->value, &y->value);
+            *x = res;
+            break;
+        case object::ID_mul:
+            bid128_mul(&res.value, &x->value, &y->value);
+            *x = res;
+            break;
+        case object::ID_div:
+            bid128_div(&res.value, &x->value, &y->value);
+            *x = res;
+            break;
+        case object::ID_pow:
+            bid128_pow(&res.value, &x->value, &y->value);
+            *x = res;
+            break;
+        case object::ID_hypot:
+            bid128_hypot(&res.value, &x->value, &y->value);
+            *x = res;
+            break;
+        case object::ID_atan2:
+            bid128_atan2(&res.value, &x->value, &y->value);
+            function::adjust_to_angle(res);
+            *x = res;
+            break;
+
+        case object::ID_neg:
+            apply(bid128_negate, *x);
+            break;
+        case object::ID_abs:
+            apply(bid128_abs, *x);
+            break;
+        case object::ID_inv:
+            bid128_from_uint32(&res.value, &one);
+            bid128_div(&res.value, &res.value, &x->value);
+            *x = res;
+            break;
+        case object::ID_sq:
+            bid128_mul(&res.value, &x->value, &x->value);
+            *x = res;
+            break;
+        case object::ID_cubed:
+            bid128_mul(&res.value, &x->value, &x->value);
+            bid128_mul(&res.value, &res.value, &x->value);
+            *x = res;
+            break;
+
+        case object::ID_sin:
+        case object::ID_cos:
+        case object::ID_tan:
+            function::adjust_from_angle(*x);
+            apply(ins.op == object::ID_sin ? bid128_sin
+                  : ins.op == object::ID_cos ? bid128_cos
+                  : bid128_tan, *x);
+            break;
+        case object::ID_asin:
+        case object::ID_acos:
+        case object::ID_atan:
+            apply(ins.op == object::ID_asin ? bid128_asin
+                  : ins.op == object::ID_acos ? bid128_acos
+                  : bid128_atan, *x);
+            function::adjust_to_angle(*x);
+            break;
+
+#define EVALUATE_FUNCTION(fn)                                   \
+        case object::ID_##fn:                                   \
+            apply(bid128_##fn, *x);                             \
+            break;
+        LIBRARY_FUNCTIONS(EVALUATE_FUNCTION)
+#undef EVALUATE_FUNCTION
+
+        default:
+            record(compiled, "Invalid opcode %u at %u", ins.op, i);
+            rt.invalid_object_error();
+            return false;
+        }
+    }
+
+    int finite = 0;
+    bid128_isFinite(&finite, &regs[0].value);
+    if (!finite)
+    {
+        rt.domain_error();
+        return false;
+    }
+    result = regs[0];
+    return true;
+}
+
+
+bool compiled::substitute(const bid128 vars[], bid128 &result) const
+// ----------------------------------------------------------------------------
+//   Slow path: replace variables with their values and evaluate
+// ----------------------------------------------------------------------------
+{
+    // Allocate the values before building the equation in the scratchpad
+    algebraic_g vals[MAX_VARIABLES];
+    for (uint v = 0; v < count; v++)
+    {
+        vals[v] = rt.make<decimal128>(object::ID_decimal128, vars[v]);
+        if (!vals[v])
+            return false;
+    }
+
+    object_g value = expr;
+    if (equation_p eq = expr->as<equation>())
+    {
+        scribble scr;
+        for (object_p item : *eq)
+        {
+            if (symbol_p name = item->as<symbol>())
+            {
+                int var = variable(name);
+                if (var >= 0)
+                    item = vals[var].Safe();
+            }
+            else if (item->type() == object::ID_TestEQ)
+            {
+                item = command::static_object(object::ID_sub);
+            }
+            if (!rt.append(item->size(), byte_p(item)))
+                return false;
+        }
+        value = list::make(object::ID_equation, scr.scratch(), scr.growth());
+    }
+    else if (symbol_p name = expr->as<symbol>())
+    {
+        int var = variable(name);
+        if (var >= 0)
+            value = vals[var].Safe();
+    }
+    if (!value)
+        return false;
+
+    size_t depth = rt.depth();
+    if (value->execute() != object::OK)
+        return false;
+    if (rt.depth() != depth + 1)
+    {
+        if (rt.depth() > depth)
+            rt.drop(rt.depth() - depth);
+        rt.value_error();
+        return false;
+    }
+    object_p computed = rt.pop();
+    if (!to_bid128(computed, result))
+    {
+        rt.type_error();
+        return false;
+    }
+
+    int finite = 0;
+    bid128_isFinite(&finite, &result.value);
+    if (!finite)
+    {
+        rt.domain_error();
+        return false;
+    }
+    return true;
+}
+
+
+bool compiled::to_bid128(object_p obj, bid128 &result)
+// ----------------------------------------------------------------------------
+//   Convert a real number to bid128
+// ----------------------------------------------------------------------------
+{
+    if (!obj)
+        return false;
+    algebraic_g x = obj->as_algebraic();
+    if (!x.Safe())
+        return false;
+
+    object::id ty = x->type();
+    if (ty == object::ID_big_decimal)
+        x = big_decimal_p(x.Safe())->to_decimal128();
+    else if (ty == object::ID_hwdouble)
+        x = hwdouble_p(x.Safe())->to_decimal(object::ID_decimal128);
+    else if (!object::is_real(ty) ||
+             !algebraic::real_promotion(x, object::ID_decimal128))
+        return false;
+
+    if (!x.Safe() || x->type() != object::ID_decimal128)
+        return false;
+    result = decimal128_p(x.Safe())->value();
+    return true;
+}
+
+
+algebraic_p compiled::to_real(const bid128 &value)
+// ----------------------------------------------------------------------------
+//   Build a real number of the type selected by the current precision
+// ----------------------------------------------------------------------------
+{
+    bid128     wide = value;
+    object::id ty   = algebraic::real_type();
+    switch(ty)
+    {
+    case object::ID_decimal32:
+    {
+        bid32 res;
+        bid128_to_bid32(&res.value, &wide.value);
+        return rt.make<decimal32>(object::ID_decimal32, res);
+    }
+    case object::ID_decimal64:
+    {
+        bid64 res;
+        bid128_to_bid64(&res.value, &wide.value);
+        return rt.make<decimal64>(object::ID_decimal64, res);
+    }
+    default:
+        break;
+    }
+
+    // Other types are built from the decimal128 value
+    algebraic_g x = rt.make<decimal128>(object::ID_decimal128, value);
+    if (!x.Safe())
+        return nullptr;
+    if (ty == object::ID_hwdouble)
+        return hwdouble::make(x);
+    if (ty == object::ID_big_decimal)
+        return big_decimal::make(x).Safe();
+    return x;
+}
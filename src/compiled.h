@@ -0,0 +1,235 @@
+#ifndef COMPILED_H
+#define COMPILED_H
+// ****************************************************************************
+//  compiled.h                                                    DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Compilation of an expression into a straight-line numeric program
+//
+//      This is the engine used by the numerical solver, integration and
+//      plotting, which all evaluate the same expression many times for
+//      different values of one or a few variables.
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+//
+//   The postfix form of an equation maps directly to a register machine:
+//   each component either loads a value in the next register, or combines
+//   the topmost registers. The register number is therefore known at
+//   compile time, and each instruction is only four bytes long.
+//
+//   Names that are not among the free variables are resolved once, when
+//   compiling: numerical values become constants, and equations stored in
+//   variables are inlined. Numbers are all converted to bid128, so that
+//   evaluation directly calls the bid128 kernels and never allocates.
+//
+//   When the expression uses something the compiler does not know about,
+//   e.g. a user-defined function or a complex value, compilation fails and
+//   evaluate() falls back to substituting values and evaluating the
+//   resulting equation. This is slower, but gives the same results.
+//
+//   An equation such as 'A=B' is evaluated as A-B, so that its roots are
+//   the solutions of the equation.
+
+#include "algebraic.h"
+#include "list.h"
+#include "symbol.h"
+#include "types.h"
+
+
+struct compiled
+// ----------------------------------------------------------------------------
+//   A compiled expression, evaluated with bid128 values for its variables
+// ----------------------------------------------------------------------------
+{
+    enum
+    {
+        MAX_CODE        = 64,   // Instructions in a program
+        MAX_CONSTANTS   = 16,   // Constants in a program
+        MAX_REGISTERS   = 16,   // Maximum evaluation depth
+        MAX_VARIABLES   = 4,    // Free variables
+        MAX_INLINE      = 4,    // Depth of inlined variables
+    };
+
+    compiled();
+
+    // Prepare an expression with the given free variables
+    bool        prepare(const object_g &expr, symbol_r var);
+    bool        prepare(const object_g &expr, list_r vars);
+
+    // Evaluate with the given variable values
+    bool        evaluate(const bid128 vars[], bid128 &result) const;
+    bool        evaluate(const bid128 &x, bid128 &result) const
+    {
+        return evaluate(&x, result);
+    }
+
+    // Check if we have a straight-line program or use the slow path
+    bool        is_compiled() const     { return instructions != 0; }
+    uint        variables() const       { return count; }
+
+    // Conversions between objects and bid128 values
+    static bool        to_bid128(object_p obj, bid128 &result);
+    static algebraic_p to_real(const bid128 &value);
+
+    // Helpers on bid128 values for the numerical algorithms
+    static bid128 integer(int x)
+    {
+        bid128 r;
+        bid128_from_int32(&r.value, &x);
+        return r;
+    }
+    static bid128 abs(bid128 x)
+    {
+        bid128 r;
+        bid128_abs(&r.value, &x.value);
+        return r;
+    }
+    static bool is_zero(bid128 x)
+    {
+        int r = 0;
+        bid128_isZero(&r, &x.value);
+        return r;
+    }
+    static bool is_negative(bid128 x)
+    {
+        int r = 0;
+        bid128_isSigned(&r, &x.value);
+        return r && !is_zero(x);
+    }
+    static bid128 epsilon(int digits)
+    {
+        bid128 r = integer(1);
+        digits = -digits;
+        bid128_scalbn(&r.value, &r.value, &digits);
+        return r;
+    }
+
+protected:
+    bool        prepare();
+    bool        compile(object_p obj, uint inlined);
+    bool        emit(object::id op, uint arity, uint arg = 0);
+    bool        constant(const bid128 &value);
+    int         variable(symbol_p name) const;
+    bool        substitute(const bid128 vars[], bid128 &result) const;
+
+    struct instruction
+    {
+        uint16_t        op;     // Opcode, ID_symbol or ID_decimal128 for loads
+        byte            reg;    // Register for the result and first operand
+        byte            arg;    // Variable or constant index for loads
+    };
+
+protected:
+    object_g            expr;
+    symbol_g            names[MAX_VARIABLES];
+    uint                count;
+    uint                instructions;
+    uint                constants;
+    uint                depth;
+    uint                registers;
+    instruction         code[MAX_CODE];
+    bid128              values[MAX_CONSTANTS];
+};
+
+
+
+// ============================================================================
+//
+//    Arithmetic operators on bid128 values
+//
+// ============================================================================
+
+inline bid128 operator-(bid128 x)
+// ----------------------------------------------------------------------------
+//   Negate a bid128 value
+// ----------------------------------------------------------------------------
+{
+    bid128 r;
+    bid128_negate(&r.value, &x.value);
+    return r;
+}
+
+
+inline bid128 operator+(bid128 x, bid128 y)
+// ----------------------------------------------------------------------------
+//   Add bid128 values
+// ----------------------------------------------------------------------------
+{
+    bid128 r;
+    bid128_add(&r.value, &x.value, &y.value);
+    return r;
+}
+
+
+inline bid128 operator-(bid128 x, bid128 y)
+// ----------------------------------------------------------------------------
+//   Subtract bid128 values
+// ----------------------------------------------------------------------------
+{
+    bid128 r;
+    bid128_sub(&r.value, &x.value, &y.value);
+    return r;
+}
+
+
+inline bid128 operator*(bid128 x, bid128 y)
+// ----------------------------------------------------------------------------
+//   Multiply bid128 values
+// ----------------------------------------------------------------------------
+{
+    bid128 r;
+    bid128_mul(&r.value, &x.value, &y.value);
+    return r;
+}
+
+
+inline bid128 operator/(bid128 x, bid128 y)
+// ----------------------------------------------------------------------------
+//   Divide bid128 values
+// ----------------------------------------------------------------------------
+{
+    bid128 r;
+    bid128_div(&r.value, &x.value, &y.value);
+    return r;
+}
+
+
+inline bool operator<(bid128 x, bid128 y)
+// ----------------------------------------------------------------------------
+//   Compare bid128 values
+// ----------------------------------------------------------------------------
+{
+    int r = 0;
+    bid128_quiet_less(&r, &x.value, &y.value);
+    return r;
+}
+
+
+inline bool operator==(bid128 x, bid128 y)
+// ----------------------------------------------------------------------------
+//   Check if bid128 values are equal
+// ----------------------------------------------------------------------------
+{
+    int r = 0;
+    bid128_quiet_equal(&r, &x.value, &y.value);
+    return r;
+}
+
+#endif // COMPILED_H
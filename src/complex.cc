@@ -32,6 +32,9 @@
 
 #include "arithmetic.h"
 #include "compare.h"
+#include "decimal-32.h"
+#include "decimal-64.h"
+#include "decimal128.h"
 #include "functions.h"
 #include "parser.h"
 #include "renderer.h"
@@ -233,6 +236,33 @@ algebraic_g complex::convert_angle(algebraic_g a,
 }
 
 
+static bool packed(complex_r x, complex_r y,
+                   bid128 &a, bid128 &b, bid128 &c, bid128 &d,
+                   object::id &parts)
+// ----------------------------------------------------------------------------
+//   Check if both x and y are rectangular with decimal components
+// ----------------------------------------------------------------------------
+//   On return, parts is the decimal type for the result, selected like in
+//   arithmetic::real_promotion: the widest of the inputs and the precision
+{
+    if (x->type() != object::ID_rectangular ||
+        y->type() != object::ID_rectangular)
+        return false;
+    rectangular_p xx = rectangular_p(complex_p(x));
+    rectangular_p yy = rectangular_p(complex_p(y));
+    object::id    xt = object::ID_object;
+    object::id    yt = object::ID_object;
+    if (!xx->packed(a, b, xt) || !yy->packed(c, d, yt))
+        return false;
+    parts = algebraic::real_type();
+    if (xt > parts)
+        parts = xt;
+    if (yt > parts)
+        parts = yt;
+    return true;
+}
+
+
 complex_g operator-(complex_r x)
 // ----------------------------------------------------------------------------
 //  Unary minus
@@ -246,6 +276,15 @@ complex_g operator-(complex_r x)
         return polar::make(-p->mod(), p->pifrac(), settings::PI_RADIANS);
     }
     rectangular_p r = rectangular_p(complex_p(x));
+    bid128 a, b;
+    object::id parts;
+    if (r->packed(a, b, parts))
+    {
+        bid128 nr, ni;
+        bid128_negate(&nr.value, &a.value);
+        bid128_negate(&ni.value, &b.value);
+        return rectangular::make(nr, ni, parts);
+    }
     return rectangular::make(-r->re(), -r->im());
 }
 
@@ -257,6 +296,15 @@ complex_g operator+(complex_r x, complex_r y)
 {
     if (!x.Safe() || !y.Safe())
         return nullptr;
+    bid128 a, b, c, d;
+    object::id parts;
+    if (packed(x, y, a, b, c, d, parts))
+    {
+        bid128 re, im;
+        bid128_add(&re.value, &a.value, &c.value);
+        bid128_add(&im.value, &b.value, &d.value);
+        return rectangular::make(re, im, parts);
+    }
     return rectangular::make(x->re() + y->re(), x->im() + y->im());
 }
 
@@ -268,6 +316,15 @@ complex_g operator-(complex_r x, complex_r y)
 {
     if (!x.Safe() || !y.Safe())
         return nullptr;
+    bid128 a, b, c, d;
+    object::id parts;
+    if (packed(x, y, a, b, c, d, parts))
+    {
+        bid128 re, im;
+        bid128_sub(&re.value, &a.value, &c.value);
+        bid128_sub(&im.value, &b.value, &d.value);
+        return rectangular::make(re, im, parts);
+    }
     if (x->is_zero())
         return -y;
     if (y->is_zero())
@@ -290,6 +347,21 @@ complex_g operator*(complex_r x, complex_r y)
                            x->pifrac() + y->pifrac(),
                            settings::PI_RADIANS);
 
+    bid128 a, b, c, d;
+    object::id parts;
+    if (packed(x, y, a, b, c, d, parts))
+    {
+        // (a+ib)(c+id) = (ac-bd) + i(ad+bc)
+        bid128 ac, bd, ad, bc, re, im;
+        bid128_mul(&ac.value, &a.value, &c.value);
+        bid128_mul(&bd.value, &b.value, &d.value);
+        bid128_mul(&ad.value, &a.value, &d.value);
+        bid128_mul(&bc.value, &b.value, &c.value);
+        bid128_sub(&re.value, &ac.value, &bd.value);
+        bid128_add(&im.value, &ad.value, &bc.value);
+        return rectangular::make(re, im, parts);
+    }
+
     rectangular_p xx = rectangular_p(complex_p(x));
     rectangular_p yy = rectangular_p(complex_p(y));
     algebraic_g xr = xx->re();
@@ -314,6 +386,26 @@ complex_g operator/(complex_r x, complex_r y)
                            x->pifrac() - y->pifrac(),
                            settings::PI_RADIANS);
 
+    bid128 xr, xi, yr, yi;
+    object::id parts;
+    if (packed(x, y, xr, xi, yr, yi, parts))
+    {
+        // (a+ib)/(c+id) = ((ac+bd) + i(bc-ad)) / (c^2+d^2)
+        bid128 cc, dd, r, ac, bd, bc, ad, re, im;
+        bid128_mul(&cc.value, &yr.value, &yr.value);
+        bid128_mul(&dd.value, &yi.value, &yi.value);
+        bid128_add(&r.value, &cc.value, &dd.value);
+        bid128_mul(&ac.value, &xr.value, &yr.value);
+        bid128_mul(&bd.value, &xi.value, &yi.value);
+        bid128_mul(&bc.value, &xi.value, &yr.value);
+        bid128_mul(&ad.value, &xr.value, &yi.value);
+        bid128_add(&re.value, &ac.value, &bd.value);
+        bid128_sub(&im.value, &bc.value, &ad.value);
+        bid128_div(&re.value, &re.value, &r.value);
+        bid128_div(&im.value, &im.value, &r.value);
+        return rectangular::make(re, im, parts);
+    }
+
     rectangular_p xx = rectangular_p(complex_p(x));
     rectangular_p yy = rectangular_p(complex_p(y));
     algebraic_g a = xx->re();
@@ -612,6 +704,33 @@ algebraic_g rectangular::mod() const
 //   Compute the modulus in rectangular form
 // ----------------------------------------------------------------------------
 {
+    bid128 a, b;
+    id parts;
+    if (packed(a, b, parts))
+    {
+        bid128 m;
+        bid128_hypot(&m.value, &a.value, &b.value);
+        id ty = real_type();
+        if (parts > ty)
+            ty = parts;
+        switch(ty)
+        {
+        case ID_decimal32:
+        {
+            bid32 r;
+            bid128_to_bid32(&r.value, &m.value);
+            return rt.make<decimal32>(ID_decimal32, r);
+        }
+        case ID_decimal64:
+        {
+            bid64 r;
+            bid128_to_bid64(&r.value, &m.value);
+            return rt.make<decimal64>(ID_decimal64, r);
+        }
+        default:
+            return rt.make<decimal128>(ID_decimal128, m);
+        }
+    }
     algebraic_g r = re();
     algebraic_g i = im();
     return hypot::evaluate(r, i);
@@ -648,6 +767,110 @@ algebraic_g rectangular::pifrac() const
 }
 
 
+static byte *pack(byte *p, const bid128 &value, object::id ty)
+// ----------------------------------------------------------------------------
+//   Write a decimal component of the given type, narrowing from bid128
+// ----------------------------------------------------------------------------
+{
+    p = leb128(p, ty);
+    switch(ty)
+    {
+    case object::ID_decimal32:
+    {
+        bid32 v;
+        bid128_to_bid32(&v.value, (BID_UINT128 *) &value.value);
+        memcpy(p, &v, sizeof(v));
+        return p + sizeof(v);
+    }
+    case object::ID_decimal64:
+    {
+        bid64 v;
+        bid128_to_bid64(&v.value, (BID_UINT128 *) &value.value);
+        memcpy(p, &v, sizeof(v));
+        return p + sizeof(v);
+    }
+    default:
+        memcpy(p, &value, sizeof(value));
+        return p + sizeof(value);
+    }
+}
+
+
+static bool unpack(algebraic_p x, bid128 &value)
+// ----------------------------------------------------------------------------
+//   Read a decimal component as bid128
+// ----------------------------------------------------------------------------
+{
+    switch(x->type())
+    {
+    case object::ID_decimal32:
+    {
+        bid32 v = decimal32_p(x)->value();
+        bid32_to_bid128(&value.value, &v.value);
+        return true;
+    }
+    case object::ID_decimal64:
+    {
+        bid64 v = decimal64_p(x)->value();
+        bid64_to_bid128(&value.value, &v.value);
+        return true;
+    }
+    case object::ID_decimal128:
+        value = decimal128_p(x)->value();
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+rectangular::rectangular(const bid128 &re, const bid128 &im, id parts,
+                         id type)
+// ----------------------------------------------------------------------------
+//   Build a rectangular complex directly from two bid128 values
+// ----------------------------------------------------------------------------
+    : complex(type)
+{
+    byte *p = (byte *) payload(this);
+    p = pack(p, re, parts);
+    pack(p, im, parts);
+}
+
+
+size_t rectangular::required_memory(id i, const bid128 &, const bid128 &,
+                                    id parts)
+// ----------------------------------------------------------------------------
+//   Size of a packed rectangular complex
+// ----------------------------------------------------------------------------
+{
+    size_t bytes = parts == ID_decimal32 ? sizeof(bid32)
+                 : parts == ID_decimal64 ? sizeof(bid64)
+                                         : sizeof(bid128);
+    return leb128size(i) + 2 * (leb128size(parts) + bytes);
+}
+
+
+bool rectangular::packed(bid128 &re, bid128 &im, id &parts) const
+// ----------------------------------------------------------------------------
+//   Extract the two components if they are both fixed-size decimals
+// ----------------------------------------------------------------------------
+//   This is not used when the precision selects hardware floating-point or
+//   variable-precision decimals, since bid128 would lose accuracy there.
+{
+    id rty = real_type();
+    if (rty < ID_decimal32 || rty > ID_decimal128)
+        return false;
+    algebraic_p x = algebraic_p(payload(this));
+    algebraic_p y = algebraic_p(byte_p(x) + x->size());
+    if (!unpack(x, re) || !unpack(y, im))
+        return false;
+    id xt = x->type();
+    id yt = y->type();
+    parts = xt > yt ? xt : yt;
+    return true;
+}
+
+
 bool rectangular::is_zero() const
 // ----------------------------------------------------------------------------
 //   A complex in rectangular form is zero iff both re and im are zero
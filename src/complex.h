@@ -33,6 +33,12 @@
 // Payload format:
 //
 //   The payload is a simple sequence with the two parts of the complex
+//
+//   When both parts of a rectangular complex are decimal32, decimal64 or
+//   decimal128, the payload is two packed BID values, each preceded by its
+//   type. Arithmetic on such values is done directly on bid128 locals,
+//   building a single result object with parts of the selected decimal type,
+//   without going through the generic algebraic operators.
 
 
 #include "algebraic.h"
@@ -60,6 +66,8 @@ struct complex : algebraic
         memcpy(p, byte_p(y), ys);
     }
 
+    complex(id type): algebraic(type) {}
+
     static size_t required_memory(id i, algebraic_r x, algebraic_r y)
     {
         return leb128size(i) + x->size() + y->size();
@@ -157,6 +165,13 @@ struct rectangular : complex
 {
     rectangular(algebraic_r re, algebraic_r im, id type = ID_rectangular)
         : complex(re, im, type) {}
+    rectangular(const bid128 &re, const bid128 &im, id parts,
+                id type = ID_rectangular);
+
+    using complex::required_memory;
+    static size_t required_memory(id i,
+                                  const bid128 &re, const bid128 &im,
+                                  id parts);
 
     algebraic_g re()  const     { return x(); }
     algebraic_g im()  const     { return y(); }
@@ -172,6 +187,13 @@ struct rectangular : complex
             return nullptr;
         return rt.make<rectangular>(r, i);
     }
+    static rectangular_p make(const bid128 &r, const bid128 &i, id parts)
+    {
+        return rt.make<rectangular>(r, i, parts);
+    }
+
+    // Fast path when both components are decimal32, decimal64 or decimal128
+    bool        packed(bid128 &re, bid128 &im, id &parts) const;
 
 public:
     OBJECT_DECL(rectangular);
@@ -0,0 +1,635 @@
+// ****************************************************************************
+//  dag.cc                                                        DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Hash-consed directed acyclic graph form for symbolic expressions,
+//      and symbolic differentiation
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "dag.h"
+
+#include "arithmetic.h"
+#include "integer.h"
+#include "list.h"
+#include "recorder.h"
+#include "settings.h"
+
+#include <cstring>
+
+
+RECORDER(dag, 16, "Hash-consed expression graphs");
+
+
+// Maximum depth of the evaluation stack when building a DAG
+static const uint DAG_MAX_DEPTH = 32;
+
+// Size of the tables at the beginning of the scratchpad
+static const size_t DAG_HASH_BYTES = dag::HASH_SIZE * sizeof(dag::node_id);
+static const size_t DAG_MEMO_BYTES = dag::MAX_NODES * sizeof(dag::node_id);
+static const size_t DAG_NODE_BYTES = dag::MAX_NODES * 3 * sizeof(uint16_t);
+static const size_t DAG_TABLES     = DAG_HASH_BYTES + DAG_MEMO_BYTES
+                                   + DAG_NODE_BYTES;
+
+
+static uint32_t hash_bytes(const byte *p, size_t size)
+// ----------------------------------------------------------------------------
+//   FNV-1a hash of a sequence of bytes
+// ----------------------------------------------------------------------------
+{
+    uint32_t hash = 2166136261u;
+    while (size--)
+        hash = (hash ^ *p++) * 16777619u;
+    return hash;
+}
+
+
+dag::dag()
+// ----------------------------------------------------------------------------
+//   Allocate and clear the tables in the scratchpad
+// ----------------------------------------------------------------------------
+    : scr(), base(rt.depth()), nodes(0), zero(NONE), one(NONE), two(NONE)
+{
+    if (!rt.allocate(DAG_TABLES))
+    {
+        nodes = MAX_NODES;
+        return;
+    }
+    memset(hash_table(), 0, DAG_HASH_BYTES);
+    memset(memo_table(), 0xFF, DAG_MEMO_BYTES);
+
+    zero = leaf(integer::make(0));
+    one  = leaf(integer::make(1));
+    two  = leaf(integer::make(2));
+}
+
+
+dag::~dag()
+// ----------------------------------------------------------------------------
+//   Drop the leaves from the stack, the scribble frees the tables
+// ----------------------------------------------------------------------------
+{
+    uint depth = rt.depth();
+    if (depth > base)
+        rt.drop(depth - base);
+}
+
+
+byte *dag::hash_table() const
+// ----------------------------------------------------------------------------
+//   The hash table is at the beginning of the scratchpad area
+// ----------------------------------------------------------------------------
+{
+    return ((scribble &) scr).scratch();
+}
+
+
+byte *dag::memo_table() const
+// ----------------------------------------------------------------------------
+//   The memoization table follows the hash table
+// ----------------------------------------------------------------------------
+{
+    return hash_table() + DAG_HASH_BYTES;
+}
+
+
+byte *dag::node_table() const
+// ----------------------------------------------------------------------------
+//   The nodes follow the memoization table
+// ----------------------------------------------------------------------------
+{
+    return memo_table() + DAG_MEMO_BYTES;
+}
+
+
+dag::node dag::get(node_id n) const
+// ----------------------------------------------------------------------------
+//   Read a node, which may not be aligned in the scratchpad
+// ----------------------------------------------------------------------------
+{
+    node result;
+    memcpy(&result, node_table() + n * sizeof(node), sizeof(node));
+    return result;
+}
+
+
+object_p dag::leaf_object(node_id n) const
+// ----------------------------------------------------------------------------
+//   Return the object for a leaf, which lives on the stack
+// ----------------------------------------------------------------------------
+{
+    node leaf = get(n);
+    return rt.stack(rt.depth() - 1 - base - leaf.left);
+}
+
+
+bool dag::is_integer(node_id n) const
+// ----------------------------------------------------------------------------
+//   Check if a node is a small integer constant
+// ----------------------------------------------------------------------------
+{
+    if (get(n).op != LEAF)
+        return false;
+    object::id ty = leaf_object(n)->type();
+    return ty == object::ID_integer || ty == object::ID_neg_integer;
+}
+
+
+dag::node_id dag::insert(const node &n, uint hash, object_p obj)
+// ----------------------------------------------------------------------------
+//   Return an existing node identical to n, or create a new one
+// ----------------------------------------------------------------------------
+{
+    for (uint probe = 0; probe < HASH_SIZE; probe++)
+    {
+        uint     slot  = (hash + probe) & (HASH_SIZE - 1);
+        node_id  entry = 0;
+        memcpy(&entry, hash_table() + slot * sizeof(entry), sizeof(entry));
+        if (!entry)
+        {
+            if (nodes >= MAX_NODES)
+            {
+                record(dag, "Out of nodes");
+                rt.too_complex_error();
+                return NONE;
+            }
+
+            node created = n;
+            if (n.op == LEAF)
+            {
+                created.left = rt.depth() - base;
+                if (!rt.push(obj))
+                    return NONE;
+            }
+            node_id id = nodes++;
+            memcpy(node_table() + id * sizeof(node), &created, sizeof(node));
+            entry = id + 1;
+            memcpy(hash_table() + slot * sizeof(entry), &entry, sizeof(entry));
+            return id;
+        }
+
+        node_id id       = entry - 1;
+        node    existing = get(id);
+        if (existing.op != n.op)
+            continue;
+        if (n.op == LEAF)
+        {
+            if (leaf_object(id)->is_same_as(obj))
+                return id;
+        }
+        else if (existing.left == n.left && existing.right == n.right)
+        {
+            return id;
+        }
+    }
+    rt.too_complex_error();
+    return NONE;
+}
+
+
+dag::node_id dag::leaf(object_p obj)
+// ----------------------------------------------------------------------------
+//   Create or find a leaf node
+// ----------------------------------------------------------------------------
+{
+    if (!obj)
+        return NONE;
+    node n = { LEAF, 0, NONE };
+    return insert(n, hash_bytes(byte_p(obj), obj->size()), obj);
+}
+
+
+dag::node_id dag::fold(object::id op, node_id l, node_id r)
+// ----------------------------------------------------------------------------
+//   Fold operations on small integer constants, e.g. 3-1
+// ----------------------------------------------------------------------------
+{
+    if (!is_integer(l) || (r != NONE && !is_integer(r)))
+        return NONE;
+
+    algebraic_g x = algebraic_p(leaf_object(l));
+    algebraic_g y = r != NONE ? algebraic_p(leaf_object(r)) : nullptr;
+    switch(op)
+    {
+    case object::ID_add:        x = x + y; break;
+    case object::ID_sub:        x = x - y; break;
+    case object::ID_mul:        x = x * y; break;
+    case object::ID_neg:        x = -x;    break;
+    default:                    return NONE;
+    }
+    if (!x.Safe())
+    {
+        rt.clear_error();
+        return NONE;
+    }
+    return leaf(x.Safe());
+}
+
+
+dag::node_id dag::make(object::id op, node_id l, node_id r)
+// ----------------------------------------------------------------------------
+//   Create or find an operator node, simplifying trivial cases
+// ----------------------------------------------------------------------------
+{
+    uint arity = command::static_object(op)->arity();
+    if (l == NONE || (arity == 2 && r == NONE))
+        return NONE;
+
+    switch(op)
+    {
+    case object::ID_add:
+        if (l == zero)
+            return r;
+        if (r == zero)
+            return l;
+        break;
+    case object::ID_sub:
+        if (r == zero)
+            return l;
+        if (l == r)
+            return zero;
+        if (l == zero)
+            return make(object::ID_neg, r);
+        break;
+    case object::ID_mul:
+        if (l == zero || r == zero)
+            return zero;
+        if (l == one)
+            return r;
+        if (r == one)
+            return l;
+        break;
+    case object::ID_div:
+        if (l == zero)
+            return zero;
+        if (r == one)
+            return l;
+        if (l == r)
+            return one;
+        break;
+    case object::ID_pow:
+        if (r == zero)
+            return one;
+        if (r == one)
+            return l;
+        if (r == two)
+            return make(object::ID_sq, l);
+        break;
+    case object::ID_neg:
+    {
+        if (l == zero)
+            return zero;
+        node arg = get(l);
+        if (arg.op == object::ID_neg)
+            return arg.left;
+        break;
+    }
+    default:
+        break;
+    }
+
+    node_id folded = fold(op, l, r);
+    if (folded != NONE)
+        return folded;
+
+    node n = { uint16_t(op), l, arity == 2 ? r : node_id(NONE) };
+    return insert(n, hash_bytes((const byte *) &n, sizeof(n)), nullptr);
+}
+
+
+dag::node_id dag::build(object_p expr)
+// ----------------------------------------------------------------------------
+//   Build the DAG for an expression
+// ----------------------------------------------------------------------------
+{
+    equation_p eq = expr->as<equation>();
+    if (!eq)
+        return leaf(expr);
+
+    node_id stack[DAG_MAX_DEPTH];
+    uint    depth = 0;
+    for (object_p obj : *eq)
+    {
+        uint    arity = obj->arity();
+        node_id n     = NONE;
+        if (arity > depth || arity > 2)
+        {
+            rt.unimplemented_error();
+            return NONE;
+        }
+        if (arity == 0)
+        {
+            if (depth >= DAG_MAX_DEPTH)
+            {
+                rt.too_complex_error();
+                return NONE;
+            }
+            n = leaf(obj);
+        }
+        else if (arity == 1)
+        {
+            n = make(obj->type(), stack[--depth]);
+        }
+        else
+        {
+            depth -= 2;
+            n = make(obj->type(), stack[depth], stack[depth + 1]);
+        }
+        if (n == NONE)
+            return NONE;
+        stack[depth++] = n;
+    }
+    if (depth != 1)
+    {
+        rt.invalid_object_error();
+        return NONE;
+    }
+    return stack[0];
+}
+
+
+bool dag::emit(node_id n)
+// ----------------------------------------------------------------------------
+//   Emit the postfix form for a node in the scratchpad
+// ----------------------------------------------------------------------------
+{
+    node x = get(n);
+    object_p obj = nullptr;
+    if (x.op == LEAF)
+    {
+        obj = leaf_object(n);
+    }
+    else
+    {
+        if (!emit(x.left))
+            return false;
+        if (x.right != NONE && !emit(x.right))
+            return false;
+        obj = command::static_object(object::id(x.op));
+    }
+    return rt.append(obj->size(), byte_p(obj));
+}
+
+
+object_p dag::linearize(node_id root)
+// ----------------------------------------------------------------------------
+//   Convert a DAG back to an equation, or to a number for constants
+// ----------------------------------------------------------------------------
+{
+    if (root == NONE)
+        return nullptr;
+
+    node x = get(root);
+    if (x.op == LEAF)
+    {
+        object_p obj = leaf_object(root);
+        if (obj->type() != object::ID_symbol)
+            return obj;
+    }
+
+    size_t start = scr.growth();
+    if (!emit(root))
+        return nullptr;
+    size_t size = scr.growth() - start;
+    return list::make(object::ID_equation, scr.scratch() + start, size);
+}
+
+
+dag::node_id dag::derivative(node_id expr, symbol_r var)
+// ----------------------------------------------------------------------------
+//   Compute the derivative of an expression, clearing the memoized results
+// ----------------------------------------------------------------------------
+{
+    if (expr == NONE)
+        return NONE;
+    memset(memo_table(), 0xFF, DAG_MEMO_BYTES);
+    node_id result = differentiate(expr, var);
+    record(dag, "Derivative used %u nodes", nodes);
+    return result;
+}
+
+
+dag::node_id dag::angle_factor(bool inverse)
+// ----------------------------------------------------------------------------
+//   Factor converting a derivative in radians to the current angle mode
+// ----------------------------------------------------------------------------
+//   For sin(x) in degrees, the derivative is cos(x) * π/180.
+//   For inverse functions, the result is in degrees, so the factor is 180/π
+{
+    uint half_turn = 0;
+    switch(Settings.angle_mode)
+    {
+    case settings::DEGREES:     half_turn = 180;        break;
+    case settings::GRADS:       half_turn = 200;        break;
+    case settings::PI_RADIANS:  half_turn = 1;          break;
+    default:                    return one;
+    }
+    node_id pi = leaf(command::static_object(object::ID_pi));
+    node_id ht = leaf(integer::make(half_turn));
+    return inverse
+        ? make(object::ID_div, ht, pi)
+        : make(object::ID_div, pi, ht);
+}
+
+
+dag::node_id dag::differentiate(node_id e, symbol_r var)
+// ----------------------------------------------------------------------------
+//   Differentiate a node, reusing the result for shared subexpressions
+// ----------------------------------------------------------------------------
+//   Derivatives of trigonometric functions take the angle mode into account
+{
+    node_id memo = NONE;
+    memcpy(&memo, memo_table() + e * sizeof(memo), sizeof(memo));
+    if (memo != NONE)
+        return memo;
+
+    node    x      = get(e);
+    node_id result = NONE;
+    if (x.op == LEAF)
+    {
+        object_p obj = leaf_object(e);
+        bool     is_var = obj->type() == object::ID_symbol &&
+                          symbol_p(obj)->is_same_as(var);
+        result = is_var ? one : zero;
+    }
+    else
+    {
+        node_id a  = x.left;
+        node_id b  = x.right;
+        node_id da = differentiate(a, var);
+        node_id db = b != NONE ? differentiate(b, var) : node_id(NONE);
+        if (da == NONE || (b != NONE && db == NONE))
+            return NONE;
+
+        switch(x.op)
+        {
+        case object::ID_add:
+            result = make(object::ID_add, da, db);
+            break;
+        case object::ID_sub:
+            result = make(object::ID_sub, da, db);
+            break;
+        case object::ID_neg:
+            result = make(object::ID_neg, da);
+            break;
+        case object::ID_mul:
+            result = make(object::ID_add,
+                          make(object::ID_mul, da, b),
+                          make(object::ID_mul, a, db));
+            break;
+        case object::ID_div:
+            result = make(object::ID_div,
+                          make(object::ID_sub,
+                               make(object::ID_mul, da, b),
+                               make(object::ID_mul, a, db)),
+                          make(object::ID_sq, b));
+            break;
+        case object::ID_pow:
+            if (db == zero)
+                // d(a^n) = n * a^(n-1) * da
+                result = make(object::ID_mul,
+                              make(object::ID_mul, b,
+                                   make(object::ID_pow, a,
+                                        make(object::ID_sub, b, one))),
+                              da);
+            else
+                // d(a^b) = a^b * (db * ln(a) + b * da / a)
+                result = make(object::ID_mul,
+                              e,
+                              make(object::ID_add,
+                                   make(object::ID_mul, db, make(object::ID_log, a)),
+                                   make(object::ID_div,
+                                        make(object::ID_mul, b, da), a)));
+            break;
+        case object::ID_sq:
+            result = make(object::ID_mul, make(object::ID_mul, two, a), da);
+            break;
+        case object::ID_cubed:
+            result = make(object::ID_mul,
+                          make(object::ID_mul,
+                               leaf(integer::make(3)), make(object::ID_sq, a)),
+                          da);
+            break;
+        case object::ID_inv:
+            result = make(object::ID_neg,
+                          make(object::ID_div, da, make(object::ID_sq, a)));
+            break;
+        case object::ID_sqrt:
+            result = make(object::ID_div, da, make(object::ID_mul, two, e));
+            break;
+        case object::ID_exp:
+            result = make(object::ID_mul, e, da);
+            break;
+        case object::ID_log:
+            result = make(object::ID_div, da, a);
+            break;
+        case object::ID_sin:
+            result = make(object::ID_mul,
+                          make(object::ID_mul, make(object::ID_cos, a),
+                               angle_factor(false)),
+                          da);
+            break;
+        case object::ID_cos:
+            result = make(object::ID_neg,
+                          make(object::ID_mul,
+                               make(object::ID_mul, make(object::ID_sin, a),
+                                    angle_factor(false)),
+                               da));
+            break;
+        case object::ID_tan:
+            result = make(object::ID_div,
+                          make(object::ID_mul, da, angle_factor(false)),
+                          make(object::ID_sq, make(object::ID_cos, a)));
+            break;
+        case object::ID_sinh:
+            result = make(object::ID_mul, make(object::ID_cosh, a), da);
+            break;
+        case object::ID_cosh:
+            result = make(object::ID_mul, make(object::ID_sinh, a), da);
+            break;
+        case object::ID_tanh:
+            result = make(object::ID_div, da,
+                          make(object::ID_sq, make(object::ID_cosh, a)));
+            break;
+        case object::ID_asin:
+            result = make(object::ID_div,
+                          make(object::ID_mul, da, angle_factor(true)),
+                          make(object::ID_sqrt,
+                               make(object::ID_sub, one, make(object::ID_sq, a))));
+            break;
+        case object::ID_acos:
+            result = make(object::ID_neg,
+                          make(object::ID_div,
+                               make(object::ID_mul, da, angle_factor(true)),
+                               make(object::ID_sqrt,
+                                    make(object::ID_sub, one,
+                                         make(object::ID_sq, a)))));
+            break;
+        case object::ID_atan:
+            result = make(object::ID_div,
+                          make(object::ID_mul, da, angle_factor(true)),
+                          make(object::ID_add, one, make(object::ID_sq, a)));
+            break;
+        default:
+            // Constant subexpressions, e.g. f(2), have a zero derivative
+            if (da == zero && (b == NONE || db == zero))
+                result = zero;
+            else
+                rt.unimplemented_error();
+            break;
+        }
+    }
+
+    if (result != NONE)
+        memcpy(memo_table() + e * sizeof(result), &result, sizeof(result));
+    return result;
+}
+
+
+COMMAND_BODY(Derivative)
+// ----------------------------------------------------------------------------
+//   Symbolic differentiation: 'Expr' 'Name' ▶ 'Derivative'
+// ----------------------------------------------------------------------------
+{
+    object_g expr = rt.stack(1);
+    object_g name = rt.stack(0);
+    if (!expr || !name)
+        return ERROR;
+
+    symbol_g var = name->as_quoted<symbol>();
+    if (!var || !expr->is_symbolic())
+    {
+        rt.type_error();
+        return ERROR;
+    }
+
+    object_g result;
+    {
+        // The DAG drops its leaves from the stack when destroyed
+        dag     graph;
+        dag::node_id root = graph.build(expr);
+        result = graph.linearize(graph.derivative(root, var));
+    }
+    if (!result || !rt.drop() || !rt.top(result))
+        return ERROR;
+    return OK;
+}
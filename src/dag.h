@@ -0,0 +1,117 @@
+#ifndef DAG_H
+#define DAG_H
+// ****************************************************************************
+//  dag.h                                                         DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Hash-consed directed acyclic graph form for symbolic expressions,
+//      and symbolic differentiation
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+//
+//   Equations are stored as flat postfix lists, where a subexpression that
+//   appears several times is copied each time. Symbolic transformations such
+//   as differentiation of products duplicate subexpressions at each step,
+//   so that the size of the result may grow exponentially.
+//
+//   The DAG form instead keeps a single copy of each distinct subexpression.
+//   Nodes are hash-consed: building a node that already exists returns the
+//   existing one. This makes equality checks trivial, and allows results
+//   computed for a node, like its derivative, to be memoized.
+//
+//   Memory layout, all in the scratchpad:
+//   - A hash table with HASH_SIZE node indexes
+//   - A memoization table with MAX_NODES entries
+//   - The nodes themselves, MAX_NODES entries
+//   Leaves (names and numbers) are pushed on the RPL stack, which keeps them
+//   safe from garbage collection, and are dropped when the DAG is destroyed.
+//   Since the scratchpad may move, tables are accessed by index only.
+//
+//   The DAG is turned back into a postfix equation only once, at the end.
+
+#include "equation.h"
+#include "runtime.h"
+#include "symbol.h"
+
+
+struct dag
+// ----------------------------------------------------------------------------
+//   A hash-consed DAG of operators and leaves
+// ----------------------------------------------------------------------------
+{
+    typedef uint16_t node_id;
+    enum
+    {
+        MAX_NODES       = 256,          // Maximum number of distinct nodes
+        HASH_SIZE       = 512,          // Power of two, larger than MAX_NODES
+        NONE            = 0xFFFF,       // Invalid node
+        LEAF            = object::ID_object, // Operator for leaves
+    };
+
+    dag();
+    ~dag();
+
+    // Build from an expression and linearize back to an equation
+    node_id     build(object_p expr);
+    object_p    linearize(node_id root);
+
+    // Create nodes, sharing existing ones and folding trivial cases
+    node_id     leaf(object_p obj);
+    node_id     make(object::id op, node_id left, node_id right = NONE);
+
+    // Symbolic differentiation
+    node_id     derivative(node_id expr, symbol_r var);
+
+    uint        count() const   { return nodes; }
+
+protected:
+    struct node
+    {
+        uint16_t        op;     // Operator, or LEAF
+        node_id         left;   // First argument, or leaf stack index
+        node_id         right;  // Second argument, or NONE
+    };
+
+    node        get(node_id n) const;
+    object_p    leaf_object(node_id n) const;
+    bool        is_integer(node_id n) const;
+    node_id     fold(object::id op, node_id left, node_id right);
+    node_id     insert(const node &n, uint hash, object_p obj);
+    node_id     differentiate(node_id expr, symbol_r var);
+    node_id     angle_factor(bool inverse);
+    bool        emit(node_id n);
+
+    byte       *hash_table() const;
+    byte       *memo_table() const;
+    byte       *node_table() const;
+
+protected:
+    scribble    scr;
+    uint        base;           // Stack depth when we started
+    uint        nodes;          // Number of nodes
+    node_id     zero, one, two; // Frequently used constants
+};
+
+
+COMMAND_DECLARE(Derivative);
+
+#endif // DAG_H
@@ -63,24 +63,111 @@ int  last_key            = 0;
 
 RECORDER(main,          16, "Main RPL thread");
 RECORDER(main_error,    16, "Errors in the main RPL thread");
+RECORDER(refresh,       16, "Lines sent to or skipped for the LCD");
+
+
+// Checksum of the lines last sent to the LCD, valid if bit is set
+static uint32_t refresh_hash[LCD_H];
+static uint32_t refresh_valid[(LCD_H + 31) / 32];
+static uint     refresh_sent    = 0;
+static uint     refresh_skipped = 0;
+
+
+static uint32_t refresh_line_hash(coord y)
+// ----------------------------------------------------------------------------
+//   Compute a FNV-1a hash of the pixel words in a screen line
+// ----------------------------------------------------------------------------
+{
+    const pixword *p    = (const pixword *) lcd_line_addr(y);
+    uint32_t       hash = 2166136261u;
+    for (uint w = 0; w < LCD_SCANLINE / 32; w++)
+        hash = (hash ^ p[w]) * 16777619u;
+    return hash;
+}
+
+
+void refresh_invalidate()
+// ----------------------------------------------------------------------------
+//   Forget what was sent to the LCD, e.g. if something else drew on it
+// ----------------------------------------------------------------------------
+//   This must be called by any code that sends the LCD buffer directly,
+//   e.g. with lcd_refresh(), or that lets DMCP draw, e.g. file selection.
+{
+    for (uint w = 0; w < (LCD_H + 31) / 32; w++)
+        refresh_valid[w] = 0;
+}
+
+
+#if SIMULATOR
+void refresh_counts(uint &sent, uint &skipped)
+// ----------------------------------------------------------------------------
+//   Return the number of lines sent to and skipped for the LCD, for tests
+// ----------------------------------------------------------------------------
+{
+    sent = refresh_sent;
+    skipped = refresh_skipped;
+}
+#endif // SIMULATOR
+
+
+static bool refresh_changed(coord y)
+// ----------------------------------------------------------------------------
+//   Check if a line differs from what was last sent to the LCD
+// ----------------------------------------------------------------------------
+{
+    uint32_t hash  = refresh_line_hash(y);
+    uint32_t bit   = 1U << (y % 32);
+    bool     valid = refresh_valid[y / 32] & bit;
+    if (valid && refresh_hash[y] == hash)
+        return false;
+    refresh_hash[y] = hash;
+    refresh_valid[y / 32] |= bit;
+    return true;
+}
+
 
 void refresh_dirty()
 // ----------------------------------------------------------------------------
-//  Send an LCD refresh request for the area dirtied by drawing
+//  Send an LCD refresh request for each span of lines dirtied by drawing
 // ----------------------------------------------------------------------------
+//  We get garbagge on screen if we pass anything outside of it, but
+//  the spans we get from the user interface are always within the screen.
+//  Lines that are identical to what was last sent are not sent again.
 {
-    rect dirty = ui.draw_dirty();
-    if (!dirty.empty())
+    uint  sent    = refresh_sent;
+    uint  skipped = refresh_skipped;
+    coord top     = 0;
+    coord bottom  = 0;
+    while (ui.draw_dirty_lines(top, bottom))
     {
-        // We get garbagge on screen if we pass anything outside of it
-        coord top = dirty.y1;
-        coord bottom = dirty.y2;
-        coord height = LCD_H - 1;
-        top = max(coord(0), min(height, top));
-        bottom = max(coord(0), min(height, bottom));
-        lcd_refresh_lines(top, bottom - top);
+        coord start = -1;
+        for (coord y = top; y <= bottom; y++)
+        {
+            if (refresh_changed(y))
+            {
+                if (start < 0)
+                    start = y;
+                refresh_sent++;
+            }
+            else
+            {
+                if (start >= 0)
+                    lcd_refresh_lines(start, y - start);
+                start = -1;
+                refresh_skipped++;
+            }
+        }
+        if (start >= 0)
+            lcd_refresh_lines(start, bottom + 1 - start);
+        top = bottom + 1;
     }
     ui.draw_clean();
+
+    if (refresh_sent != sent || refresh_skipped != skipped)
+        record(refresh,
+               "Sent %u lines, skipped %u, total sent %u skipped %u",
+               refresh_sent - sent, refresh_skipped - skipped,
+               refresh_sent, refresh_skipped);
 }
 
 
@@ -93,6 +180,10 @@ void redraw_lcd(bool force)
 
     record(main, "Begin redraw at %u", now);
 
+    // A forced redraw sends everything, e.g. after a system menu
+    if (force)
+        refresh_invalidate();
+
     // Draw the various components handled by the user interface
     ui.draw_start(force);
     ui.draw_header();
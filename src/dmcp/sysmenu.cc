@@ -106,6 +106,7 @@ void about_dialog()
     lcd_putsR(t20, "    Press EXIT key to continue...");
 
     lcd_refresh();
+    refresh_invalidate();
 
     wait_for_key_press();
 }
@@ -233,6 +234,7 @@ static int state_save_callback(cstring fpath,
     lcd_puts(t24,"Saving state...");
     lcd_puts(t24, fname);
     lcd_refresh();
+    refresh_invalidate();
 
     // Store the state file name so that we automatically reload it
     set_reset_state_file(fpath);
@@ -291,7 +293,10 @@ static int state_save()
 {
     // Check if we have enough power to write flash disk
     if (power_check_screen())
+    {
+        refresh_invalidate();
         return 0;
+    }
 
     bool display_new = true;
     bool overwrite_check = true;
@@ -301,6 +306,7 @@ static int state_save()
                                     state_save_callback,
                                     display_new, overwrite_check,
                                     user_data);
+    refresh_invalidate();
     return ret;
 }
 
@@ -331,6 +337,7 @@ static bool danger_will_robinson(cstring header,
     lcd_puts(t24, msg7);
     lcd_puts(t24, "Press [ENTER] to confirm.");
     lcd_refresh();
+    refresh_invalidate();
 
     wait_for_key_release(-1);
 
@@ -376,6 +383,7 @@ static int state_load_callback(cstring path, cstring name, void *merge)
     lcd_puts(t24,"Loading state...");
     lcd_puts(t24, name);
     lcd_refresh();
+    refresh_invalidate();
 
     // Store the state file name
     file prog;
@@ -421,6 +429,7 @@ static int state_load_callback(cstring path, cstring name, void *merge)
                     lcd_puts(t24, (cstring) rt.error());
                     lcd_print(t24, "executing %s", rt.command());
                     lcd_refresh();
+                    refresh_invalidate();
                     wait_for_key_press();
                     return 1;
                 }
@@ -437,6 +446,7 @@ static int state_load_callback(cstring path, cstring name, void *merge)
                 lcd_print(t24, "Error at byte %u", pos - ed);
                 lcd_puts(t24, rt.error() ? (cstring) rt.error() : "");
                 lcd_refresh();
+                refresh_invalidate();
                 beep(3300, 100);
                 wait_for_key_press();
 
@@ -452,6 +462,7 @@ static int state_load_callback(cstring path, cstring name, void *merge)
         {
             lcd_print(t24, "Out of memory");
             lcd_refresh();
+            refresh_invalidate();
             beep(3300, 100);
             wait_for_key_press();
             return 1;
@@ -476,6 +487,7 @@ static int state_load(bool merge)
                                     state_load_callback,
                                     display_new, overwrite_check,
                                     user_data);
+    refresh_invalidate();
     return ret;
 }
 
@@ -77,6 +77,10 @@ bool                  save_system_state();
 void                  power_off();
 void                  system_setup();
 void                  refresh_dirty();
+void                  refresh_invalidate();
+#if SIMULATOR
+void                  refresh_counts(uint &sent, uint &skipped);
+#endif // SIMULATOR
 void                  redraw_lcd(bool force);
 
 #endif // SYSMENU_H
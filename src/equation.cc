@@ -36,6 +36,7 @@
 
 RECORDER(equation, 16, "Processing of equations and algebraic objects");
 RECORDER(equation_error, 16, "Errors with equations");
+RECORDER(equation_memo, 16, "Memoization of expand, collect and simplify");
 
 // ============================================================================
 //
@@ -60,130 +61,210 @@ PARSE_BODY(equation)
 }
 
 
-symbol_g equation::parentheses(symbol_g arg)
+// ============================================================================
+//
+//   Equation rendering
+//
+// ============================================================================
+//
+//   The components of the equation are pushed on the stack, so that the
+//   outermost operator is on top. Popping them visits the tree from the
+//   root, with the rightmost argument first. The text is therefore emitted
+//   backwards, i.e. last character first, which lets each operator decide
+//   about parentheses and separators before or after rendering each of its
+//   arguments, without building intermediate symbols. The result is then
+//   reversed once in place. This is linear in the size of the output.
+
+int equation::precedence(object_p obj)
 // ----------------------------------------------------------------------------
-//   Render, putting parentheses around an argument
+//   Return the precedence of the text rendered for a given component
 // ----------------------------------------------------------------------------
 {
-    symbol_g open = symbol::make('(');
-    symbol_g close = symbol::make(')');
-    return open + arg + close;
+    int prec = obj->precedence();
+    switch(obj->arity())
+    {
+    case 0:
+        // Symbols and other non-algebraics, e.g. numbers
+        return prec == precedence::NONE ? precedence::SYMBOL : prec;
+    case 1:
+        switch(obj->type())
+        {
+        case ID_sq:
+        case ID_cubed:
+        case ID_inv:    return precedence::FUNCTION_POWER;
+        case ID_neg:    return precedence::ADDITIVE;
+        case ID_fact:   return precedence::SYMBOL;
+        default:        return precedence::FUNCTION;
+        }
+    case 2:
+        return prec;
+    default:
+        return precedence::FUNCTION;
+    }
 }
 
 
-symbol_g equation::space(symbol_g arg)
+static bool put_reversed(renderer &r, gcutf8 text, size_t len)
 // ----------------------------------------------------------------------------
-//   Render, putting parentheses around an argument
+//   Emit text backwards
 // ----------------------------------------------------------------------------
 {
-    return symbol::make(' ') + arg;
+    while (len--)
+        if (!r.put(char(text.Safe()[len])))
+            return false;
+    return true;
 }
 
 
-symbol_g equation::render(uint depth, int &precedence, bool editing)
+static bool put_reversed(renderer &r, cstring text)
 // ----------------------------------------------------------------------------
-//   Render an object as a symbol at a given precedence
+//   Emit a C string backwards
 // ----------------------------------------------------------------------------
 {
-    while (rt.depth() > depth)
+    size_t len = strlen(text);
+    while (len--)
+        if (!r.put(text[len]))
+            return false;
+    return true;
+}
+
+
+static bool put_reversed(renderer &r, object_p obj, bool editing)
+// ----------------------------------------------------------------------------
+//   Emit the text for a component backwards
+// ----------------------------------------------------------------------------
+{
+    object::id ty = obj->type();
+    if (ty == object::ID_symbol)
     {
-        if (object_g obj = rt.pop())
+        size_t len = 0;
+        gcutf8 txt = symbol_p(obj)->value(&len);
+        return put_reversed(r, txt, len);
+    }
+
+    // Operators render directly into a small buffer
+    if (obj->arity())
+    {
+        char buffer[32];
+        size_t len = obj->render(buffer, sizeof(buffer) - 1);
+        buffer[len] = 0;
+        return put_reversed(r, buffer);
+    }
+
+    // Other values, e.g. numbers, are rendered in equation mode
+    symbol_g sym = obj->as_symbol(editing);
+    if (!sym)
+        return false;
+    size_t len = 0;
+    gcutf8 txt = sym->value(&len);
+    return put_reversed(r, txt, len);
+}
+
+
+bool equation::render_reversed(renderer &r, uint depth, bool editing)
+// ----------------------------------------------------------------------------
+//   Render the sub-expression on top of the stack, backwards
+// ----------------------------------------------------------------------------
+{
+    if (rt.depth() <= depth)
+        return false;
+    object_g obj = rt.pop();
+    if (!obj)
+        return false;
+
+    int arity = obj->arity();
+    switch(arity)
+    {
+    case 0:
+        return put_reversed(r, obj, editing);
+
+    case 1:
+    {
+        if (rt.depth() <= depth)
+            return false;
+        id   oid   = obj->type();
+        int  argp  = precedence(rt.top());
+        int  maxp  = oid == ID_neg ? precedence::FUNCTION : precedence::SYMBOL;
+        bool paren = argp < maxp;
+        switch(oid)
         {
-            int arity = obj->arity();
-            switch(arity)
-            {
-            case 0:
-                // Symbols and other non-algebraics, e.g. numbers
-                precedence = obj->precedence();
-                if (precedence == precedence::NONE)
-                    precedence = precedence::SYMBOL;
-                if (obj->type() == ID_symbol)
-                    return symbol_p(object_p(obj));
-                return obj->as_symbol(editing);
-
-            case 1:
-            {
-                int      argp = 0;
-                id       oid  = obj->type();
-                symbol_g fn   = obj->as_symbol(editing);
-                symbol_g arg  = render(depth, argp, editing);
-                int      maxp =
-                    oid == ID_neg ? precedence::FUNCTION : precedence::SYMBOL;
-                if (argp < maxp)
-                    arg = parentheses(arg);
-                precedence = precedence::FUNCTION;
-                switch(oid)
-                {
-                case ID_sq:
-                    precedence = precedence::FUNCTION_POWER;
-                    return arg + symbol::make("²");
-                case ID_cubed:
-                    precedence = precedence::FUNCTION_POWER;
-                    return arg + symbol::make("³");
-                case ID_neg:
-                    precedence = precedence::ADDITIVE;
-                    return symbol::make('-') + arg;
-                case ID_fact:
-                    precedence = precedence::SYMBOL;
-                    return arg + symbol::make("!");
-                case ID_inv:
-                    precedence = precedence::FUNCTION_POWER;
-                    return arg + symbol::make("⁻¹");
-                default:
-                    break;
-                }
-                if (argp >= precedence::FUNCTION)
-                    arg = space(arg);
-                return fn + arg;
-            }
-            break;
-            case 2:
-            {
-                int lprec = 0, rprec = 0;
-                symbol_g op = obj->as_symbol(editing);
-                symbol_g rtxt = render(depth, rprec, editing);
-                symbol_g ltxt = render(depth, lprec, editing);
-                int prec = obj->precedence();
-                if (prec != precedence::FUNCTION)
-                {
-                    if (lprec < prec)
-                        ltxt = parentheses(ltxt);
-                    if (rprec <= prec)
-                        rtxt = parentheses(rtxt);
-                    precedence = prec;
-                    return ltxt + op + rtxt;
-                }
-                else
-                {
-                    symbol_g arg = ltxt + symbol::make(';') + rtxt;
-                    arg = parentheses(arg);
-                    precedence = precedence::FUNCTION;
-                    return op + arg;
-                }
-            }
+        case ID_sq:     if (!put_reversed(r, "²"))  return false; break;
+        case ID_cubed:  if (!put_reversed(r, "³"))  return false; break;
+        case ID_fact:   if (!put_reversed(r, "!"))  return false; break;
+        case ID_inv:    if (!put_reversed(r, "⁻¹")) return false; break;
+        default:                                                  break;
+        }
+        if (paren && !r.put(')'))
+            return false;
+        if (!render_reversed(r, depth, editing))
+            return false;
+        if (paren && !r.put('('))
+            return false;
+        switch(oid)
+        {
+        case ID_sq:
+        case ID_cubed:
+        case ID_fact:
+        case ID_inv:
+            return true;
+        case ID_neg:
+            return r.put('-');
+        default:
             break;
-            default:
-            {
-                symbol_g op = obj->as_symbol(editing);
-                symbol_g args = nullptr;
-                for (int a = 0; a < arity; a++)
-                {
-                    int prec = 0;
-                    symbol_g arg = render(depth, prec, editing);
-                    if (a)
-                        args = arg + symbol::make(';') + args;
-                    else
-                        args = arg;
-                }
-                args = parentheses(args);
-                precedence = precedence::FUNCTION;
-                return op + args;
-            }
-            }
         }
+        if (argp >= precedence::FUNCTION && !r.put(' '))
+            return false;
+        return put_reversed(r, obj, editing);
     }
 
-    return nullptr;
+    case 2:
+    {
+        if (rt.depth() < depth + 2)
+            return false;
+        int prec = obj->precedence();
+        if (prec != precedence::FUNCTION)
+        {
+            bool rparen = precedence(rt.top()) <= prec;
+            if (rparen && !r.put(')'))
+                return false;
+            if (!render_reversed(r, depth, editing))
+                return false;
+            if (rparen && !r.put('('))
+                return false;
+            if (!put_reversed(r, obj, editing))
+                return false;
+            if (rt.depth() <= depth)
+                return false;
+            bool lparen = precedence(rt.top()) < prec;
+            if (lparen && !r.put(')'))
+                return false;
+            if (!render_reversed(r, depth, editing))
+                return false;
+            return !lparen || r.put('(');
+        }
+        // Function with two arguments, e.g. atan2(X;Y)
+        return r.put(')')
+            && render_reversed(r, depth, editing)
+            && r.put(';')
+            && render_reversed(r, depth, editing)
+            && r.put('(')
+            && put_reversed(r, obj, editing);
+    }
+
+    default:
+    {
+        if (!r.put(')'))
+            return false;
+        for (int a = 0; a < arity; a++)
+        {
+            if (a && !r.put(';'))
+                return false;
+            if (!render_reversed(r, depth, editing))
+                return false;
+        }
+        return r.put('(') && put_reversed(r, obj, editing);
+    }
+    }
 }
 
 
@@ -213,20 +294,58 @@ RENDER_BODY(equation)
         return 0;
     }
 
-    int precedence = 0;
-    symbol_g result = render(depth, precedence, r.editing());
-    if (size_t remove = rt.depth() - depth)
+    // Render backwards in the scratchpad, then reverse the result in place
+    // Rendering backwards produces the end first, so that when only the tail
+    // is needed, we can stop as soon as the budget is exhausted
+    symbol_g result;
+    bool     cut = false;
     {
-        record(equation_error, "Malformed equation, %u removed", remove);
-        rt.drop(remove);
+        renderer out(nullptr, r.tail() ? r.budget() : ~0U);
+        ok = render_reversed(out, depth, r.editing());
+        cut = out.truncated();
+        if (cut)
+            ok = true;
+        if (size_t remove = rt.depth() - depth)
+        {
+            if (!cut)
+                record(equation_error, "Malformed equation, %u removed",
+                       remove);
+            rt.drop(remove);
+        }
+        size_t size = out.size();
+        if (ok && size)
+        {
+            byte *first = (byte *) out.text();
+            byte *last  = first + size;
+            while (first < last)
+            {
+                byte tmp = *first;
+                *first++ = *--last;
+                *last = tmp;
+            }
+            gcutf8 txt = out.text();
+            result = rt.make<symbol>(ID_symbol, txt, size);
+        }
     }
     if (!result)
         return 0;
 
     size_t len = 0;
     utf8 txt = result->value(&len);
-    if (!r.equation())
+    if (cut)
+    {
+        // Skip partial UTF-8 sequence at the beginning of the tail
+        while (len && (*txt & 0xC0) == 0x80)
+        {
+            txt++;
+            len--;
+        }
+        r.truncate();
+    }
+    else if (!r.equation())
+    {
         r.put('\'');
+    }
     r.put(txt, len);
     if (!r.equation())
         r.put('\'');
@@ -594,6 +713,108 @@ static size_t check_match(size_t eq, size_t eqsz,
 }
 
 
+static size_t push_flattened(object_p obj)
+// ----------------------------------------------------------------------------
+//   Push an object on the stack, expanding equations into their components
+// ----------------------------------------------------------------------------
+{
+    if (equation_p eq = obj->as<equation>())
+    {
+        size_t count = 0;
+        for (object_p item : *eq)
+        {
+            if (!rt.push(item))
+                return 0;
+            count++;
+        }
+        return count;
+    }
+    return rt.push(obj) ? 1 : 0;
+}
+
+
+static equation_p equation_from_stack(size_t size)
+// ----------------------------------------------------------------------------
+//   Build an equation from the postfix components on top of the stack
+// ----------------------------------------------------------------------------
+{
+    scribble scr;
+    for (size_t level = size; level--; )
+    {
+        object_p obj = rt.stack(level);
+        if (!obj || !rt.append(obj->size(), byte_p(obj)))
+            return nullptr;
+    }
+    list_p list = list::make(object::ID_equation, scr.scratch(), scr.growth());
+    return equation_p(list);
+}
+
+
+static size_t push_replacement(equation_r to, size_t locals, bool &compute)
+// ----------------------------------------------------------------------------
+//   Push the components of `to` with symbols replaced by their bindings
+// ----------------------------------------------------------------------------
+//   Returns the number of components pushed, or 0 in case of error
+{
+    size_t pushed = 0;
+    for (object_p tobj : *to)
+    {
+        if (tobj->type() == object::ID_symbol)
+        {
+            // Check if we find the matching pattern in local
+            symbol_p name = symbol_p(tobj);
+            object_p found = nullptr;
+            size_t symbols = rt.locals() - locals;
+            for (size_t l = 0; !found && l < symbols; l += 2)
+            {
+                symbol_p existing = symbol_p(rt.local(l));
+                if (!existing)
+                    continue;
+                if (existing->is_same_as(name))
+                    found = rt.local(l+1);
+            }
+            if (found)
+            {
+                tobj = found;
+                if (must_be_integer(name))
+                    compute = true;
+            }
+        }
+
+        size_t count = push_flattened(tobj);
+        if (!count)
+            return 0;
+        pushed += count;
+    }
+    return pushed;
+}
+
+
+static size_t evaluate_replacement(size_t size)
+// ----------------------------------------------------------------------------
+//   Evaluate the replacement on top of stack, e.g. to compute 3-1 as 2
+// ----------------------------------------------------------------------------
+//   Returns the number of components of the result, or 0 in case of error
+{
+    equation_g eq = equation_from_stack(size);
+    if (!eq || !rt.drop(size))
+        return 0;
+
+    size_t depth = rt.depth();
+    if (eq->execute() != object::OK)
+        return 0;
+    if (rt.depth() != depth + 1)
+        return 0;
+    object_p computed = rt.pop();
+    if (!computed)
+        return 0;
+    algebraic_g eqa = computed->as_algebraic();
+    if (!eqa.Safe())
+        return 0;
+    return push_flattened(eqa.Safe());
+}
+
+
 equation_p equation::rewrite(equation_r from, equation_r to) const
 // ----------------------------------------------------------------------------
 //   If we match pattern in `from`, then rewrite using pattern in `to`
@@ -601,6 +822,17 @@ equation_p equation::rewrite(equation_r from, equation_r to) const
 //   For example, if this equation is `3 + sin(X + Y)`, from is `A + B` and
 //   to is `B + A`, then the output will be `sin(Y + X) + 3`.
 //
+//   Sub-expressions are normalized bottom-up, i.e. innermost first, which
+//   is the postfix order of the components on the stack. When a node is
+//   replaced, the replacement is spliced on the stack in place of the
+//   matched components, and the scan resumes at the start of the
+//   replacement. Components before it are already normalized, and the
+//   ones after it are the parents and siblings that remain to be visited.
+//   The resulting equation is built only once, at the end.
+//
+//   When the pattern binds names that must be integers, e.g. `N` in
+//   `X^N` -> `X*X^(N-1)`, only the replacement is evaluated, in order to
+//   compute `3-1` as `2`. The rest of the equation is never evaluated.
 {
     // Remember the current stack depth and locals
     size_t     locals   = rt.locals();
@@ -608,176 +840,334 @@ equation_p equation::rewrite(equation_r from, equation_r to) const
 
     // Need a GC pointer since stack operations may move us
     equation_g eq       = this;
+    equation_g result   = this;
 
     // Information about part we replace
     bool       replaced = false;
-    size_t     matchsz  = 0;
     uint       rewrites = Settings.maxrewrites;
-
-    // Loop while there are replacements found
-    do
+    size_t     eqsz     = 0;
+    size_t     fromsz   = 0;
+    size_t     index    = 0;
+
+    // Expand 'from' on the stack
+    for (object_p obj : *from)
+        if (!rt.push(obj))
+            goto err;
+    fromsz = rt.depth() - depth;
+
+    // Expand this equation on the stack
+    for (object_p obj : *eq)
+        if (!rt.push(obj))
+            goto err;
+    eqsz = rt.depth() - depth - fromsz;
+
+    // Scan the components in postfix order, children before parents
+    while (index < eqsz && !interrupted())
     {
-        // Location of expanded equation
-        size_t eqsz = 0, fromsz = 0;
-        size_t eqst = 0, fromst = 0;
-        bool compute = false;
+        size_t level   = eqsz - 1 - index;
+        size_t matchsz = check_match(level, eqsz - level, eqsz, fromsz);
+        if (!matchsz)
+        {
+            // Drop bindings from a partial match, check next component
+            rt.unlocals(rt.locals() - locals);
+            index++;
+            continue;
+        }
 
-        replaced = false;
+        // Build the replacement on top of the stack
+        bool   compute = false;
+        size_t newsz   = push_replacement(to, locals, compute);
+        if (!newsz)
+            goto err;
+        rt.unlocals(rt.locals() - locals);
 
-        // Expand 'from' on the stack and remember where it starts
-        for (object_p obj : *from)
-            if (!rt.push(obj))
+        // If we had an integer matched and replaced, evaluate replacement
+        if (compute)
+        {
+            newsz = evaluate_replacement(newsz);
+            if (!newsz)
                 goto err;
-        fromsz = rt.depth() - depth;
+        }
 
-        // Expand this equation on the stack, and remember where it starts
-        for (object_p obj : *eq)
-            if (!rt.push(obj))
-                goto err;
-        eqsz = rt.depth() - depth - fromsz;
+        // Splice the replacement in place of the matched components
+        if (!rt.splice(level, matchsz, newsz))
+            goto err;
+        eqsz = eqsz - matchsz + newsz;
+        index = index + 1 - matchsz;
+        replaced = true;
 
-        // Keep checking sub-expressions until we find a match
-        size_t eqlen = eqsz;
-        fromst = eqst + eqsz;
-        while (eqsz)
+        // Check if we are looping forever
+        if (rewrites-- == 0)
         {
-            // Check if there is a match of this sub-equation
-            matchsz = check_match(eqst, eqsz, fromst, fromsz);
-            if (matchsz)
-                break;
-
-            // Check next step in the equation
-            eqst++;
-            eqsz--;
+            rt.too_many_rewrites_error();
+            goto err;
         }
+    }
 
-        // We don't need the on-stack copies of 'eq' and 'to' anymore
-        ASSERT(rt.depth() >= depth);
-        rt.drop(rt.depth() - depth);
+    // Build the result from the components on the stack
+    if (replaced)
+        result = equation_from_stack(eqsz);
 
-        // If we matched a sub-equation, perform replacement
-        if (matchsz)
-        {
-            scribble scr;
-            size_t   where  = 0;
+err:
+    ASSERT(rt.depth() >= depth);
+    rt.drop(rt.depth() - depth);
+    rt.unlocals(rt.locals() - locals);
+    return result;
+}
 
-            // We matched from the back of the equation object
-            eqst = eqlen - matchsz - eqst;
 
-            // Copy from the original
-            for (equation::iterator it = eq->begin(); it != eq->end(); ++it)
-            {
-                ASSERT(*it);
-                if (where < eqst || where >= eqst + matchsz)
-                {
-                    // Copy from source equation directly
-                    object_p obj = *it;
-                    if (!rt.append(obj->size(), byte_p(obj)))
-                        return nullptr;
-                }
-                else if (!replaced)
-                {
-                    // Insert a version of 'to' where symbols are replaced
-                    for (object_p tobj : *to)
-                    {
-                        if (tobj->type() == ID_symbol)
-                        {
-                            // Check if we find the matching pattern in local
-                            symbol_p name = symbol_p(tobj);
-                            object_p found = nullptr;
-                            size_t symbols = rt.locals() - locals;
-                            for (size_t l = 0; !found && l < symbols; l += 2)
-                            {
-                                symbol_p existing = symbol_p(rt.local(l));
-                                if (!existing)
-                                    continue;
-                                if (existing->is_same_as(name))
-                                    found = rt.local(l+1);
-                            }
-                            if (found)
-                            {
-                                tobj = found;
-                                if (must_be_integer(name))
-                                    compute = true;
-                            }
-                        }
-
-                        // Only copy the payload of equations
-                        size_t tobjsize = tobj->size();
-                        if (equation_p teq = tobj->as<equation>())
-                            tobj = object_p(teq->value(&tobjsize));
-                        if (!rt.append(tobjsize, byte_p(tobj)))
-                            return nullptr;
-                    }
+// ============================================================================
+//
+//   Rule index for sets of rewrites
+//
+// ============================================================================
+//
+//   Rule sets like the ones used by expand(), collect() or simplify() have
+//   20 or more rules, and most of them do not apply to a given equation.
+//   Rather than expanding every pattern and the equation on the stack for
+//   each rule in turn, the patterns are expanded once, and the equation is
+//   traversed once to find all the rules that can possibly apply.
+//
+//   At each position in the equation, only rules whose root operator is
+//   the object at that position are considered (this root is computed at
+//   compile time for the built-in rules, see eq::root()). A structural
+//   match is then checked, where symbols match any sub-expression. This
+//   ignores the binding and naming constraints checked by check_match(),
+//   so it selects a superset of the rules that will actually rewrite.
+
+static object::id pattern_root(equation_p pattern)
+// ----------------------------------------------------------------------------
+//   Compute the root of a pattern at runtime, ID_object for a lone symbol
+// ----------------------------------------------------------------------------
+{
+    object_p last = nullptr;
+    for (object_p obj : *pattern)
+        last = obj;
+    if (!last)
+        return object::ID_object;
+    object::id ty = last->type();
+    return ty == object::ID_symbol ? object::ID_object : ty;
+}
 
-                    replaced = true;
-                }
-                where++;
+
+static bool structure_match(size_t eq, size_t eqsz, size_t from, size_t fromsz)
+// ----------------------------------------------------------------------------
+//   Check if the structure of the pattern at `from` matches `eq`
+// ----------------------------------------------------------------------------
+{
+    while (fromsz && eqsz)
+    {
+        object_p ftop = rt.stack(from);
+        if (ftop->type() == object::ID_symbol)
+        {
+            // A symbol matches any complete sub-expression
+            size_t arity = 1;
+            while (arity && eqsz)
+            {
+                arity--;
+                arity += rt.stack(eq)->arity();
+                eq++;
+                eqsz--;
             }
+            if (arity)
+                return false;
+        }
+        else
+        {
+            if (!rt.stack(eq)->is_same_as(ftop))
+                return false;
+            eq++;
+            eqsz--;
+        }
+        from++;
+        fromsz--;
+    }
+    return fromsz == 0;
+}
+
+
+struct rule_index
+// ----------------------------------------------------------------------------
+//   Patterns of a rule set, expanded on the stack once for all passes
+// ----------------------------------------------------------------------------
+{
+    enum { MAX_RULES = 64 };
+    typedef uint64_t mask;
+
+    rule_index(): depth(rt.depth()), rules(0) {}
+    ~rule_index()
+    {
+        rt.drop(rt.depth() - depth);
+    }
 
-            // Restart anew with replaced equation
-            eq = equation_p(list::make(ID_equation,
-                                       scr.scratch(), scr.growth()));
+    bool add(equation_p pattern, object::id root)
+    // ------------------------------------------------------------------------
+    //   Expand a pattern on the stack and record its root
+    // ------------------------------------------------------------------------
+    {
+        // Rules beyond what the mask can represent are always tried
+        if (rules >= MAX_RULES)
+            return true;
+        size_t start = rt.depth();
+        for (object_p obj : *pattern)
+            if (!rt.push(obj))
+                return false;
+        roots[rules] = root;
+        sizes[rules] = rt.depth() - start;
+        tops[rules] = rt.depth() - depth;
+        rules++;
+        return true;
+    }
 
-            // If we had an integer matfched and replaced, execute equation
-            if (compute)
+    mask candidates(equation_r eq) const
+    // ------------------------------------------------------------------------
+    //   Traverse the equation once to find the rules that may apply
+    // ------------------------------------------------------------------------
+    {
+        size_t base = rt.depth();
+        for (object_p obj : *eq)
+        {
+            if (!rt.push(obj))
             {
-                // Need to evaluate e.g. 3-1 to get 2
-                if (eq->execute() != object::OK)
-                    goto err;
-                if (rt.depth() != depth+1)
-                    goto err;
-                object_p computed = rt.pop();
-                if (!computed)
-                    goto err;
-                algebraic_g eqa = computed->as_algebraic();
-                if (!eqa.Safe())
-                    goto err;
-                eq = eqa->as<equation>();
-                if (!eq)
-                    eq = equation::make(eqa);
+                rt.drop(rt.depth() - base);
+                return ~mask(0);
             }
+        }
 
-            // Drop the local names, we will recreate them on next match
-            rt.unlocals(rt.locals() - locals);
-
-            // Check if we are looping forever
-            if (rewrites-- == 0)
+        size_t eqsz   = rt.depth() - base;
+        size_t top    = rt.depth() - depth;
+        mask   all    = rules < MAX_RULES ? (mask(1) << rules) - 1 : ~mask(0);
+        mask   result = rules < MAX_RULES ? ~all : 0;
+        for (size_t e = 0; e < eqsz && result != ~mask(0); e++)
+        {
+            object::id ty = rt.stack(e)->type();
+            for (size_t r = 0; r < rules; r++)
             {
-                rt.too_many_rewrites_error();
-                goto err;
+                mask bit = mask(1) << r;
+                if (result & bit)
+                    continue;
+                if (roots[r] != object::ID_object && roots[r] != ty)
+                    continue;
+                size_t from = top - tops[r];
+                if (structure_match(e, eqsz - e, from, sizes[r]))
+                    result |= bit;
             }
         }
-    } while (replaced && !interrupted());
+        rt.drop(eqsz);
+        return result;
+    }
 
-err:
-    ASSERT(rt.depth() >= depth);
-    rt.drop(rt.depth() - depth);
-    rt.unlocals(rt.locals() - locals);
-    return eq;;
+    static bool candidate(mask m, size_t rule)
+    {
+        return rule >= MAX_RULES || (m & (mask(1) << rule));
+    }
+
+    size_t      depth;
+    size_t      rules;
+    object::id  roots[MAX_RULES];
+    uint16_t    sizes[MAX_RULES];
+    uint16_t    tops[MAX_RULES];
+};
+
+
+struct builtin_rules
+// ----------------------------------------------------------------------------
+//   Rules built at compile time with the eq<> templates
+// ----------------------------------------------------------------------------
+{
+    builtin_rules(size_t size, const byte_p rewrites[], const object::id roots[])
+        : size(size), rewrites(rewrites), roots(roots) {}
+
+    size_t count() const                { return size / 2; }
+    equation_p from(size_t r) const     { return equation_p(rewrites[2*r]); }
+    equation_p to(size_t r) const       { return equation_p(rewrites[2*r+1]); }
+    object::id root(size_t r) const
+    {
+        return roots ? roots[2*r] : pattern_root(from(r));
+    }
+
+    size_t              size;
+    const byte_p *      rewrites;
+    const object::id *  roots;
+};
+
+
+struct list_rules
+// ----------------------------------------------------------------------------
+//   Rules given by the user as a list of 'From' 'To' pairs
+// ----------------------------------------------------------------------------
+{
+    list_rules(list_r rules): rules(rules) {}
+
+    size_t count() const                { return rules->items() / 2; }
+    equation_p from(size_t r) const     { return equation_p(rules->at(2*r)); }
+    equation_p to(size_t r) const       { return equation_p(rules->at(2*r+1)); }
+    object::id root(size_t r) const     { return pattern_root(from(r)); }
+
+    list_g rules;
+};
+
+
+template <typename Rules>
+static bool rewrite_index(Rules &rules, rule_index &index)
+// ----------------------------------------------------------------------------
+//   Build the index for a rule set
+// ----------------------------------------------------------------------------
+{
+    size_t count = rules.count();
+    for (size_t r = 0; r < count; r++)
+        if (!index.add(rules.from(r), rules.root(r)))
+            return false;
+    return true;
 }
 
 
-equation_p equation::rewrite(size_t size, const byte_p rewrites[]) const
+template <typename Rules>
+static equation_p rewrite_pass(equation_r in, Rules &rules, rule_index &index)
 // ----------------------------------------------------------------------------
-//   Apply a series of rewrites
+//   Apply the rules that may match in sequence
 // ----------------------------------------------------------------------------
 {
-    equation_g eq = this;
-    for (size_t i = 0; eq && i < size; i += 2)
-        eq = eq->rewrite(equation_p(rewrites[i]), equation_p(rewrites[i+1]));
+    equation_g       eq         = in;
+    size_t           count      = rules.count();
+    rule_index::mask candidates = index.candidates(eq);
+    for (size_t r = 0; eq && r < count; r++)
+    {
+        if (!index.candidate(candidates, r))
+            continue;
+        equation_g from = rules.from(r);
+        equation_g to   = rules.to(r);
+        equation_g next = eq->rewrite(from, to);
+        if (next.Safe() != eq.Safe())
+        {
+            eq = next;
+            if (eq)
+                candidates = index.candidates(eq);
+        }
+    }
     return eq;
 }
 
 
-equation_p equation::rewrite_all(size_t size, const byte_p rewrites[]) const
+template <typename Rules>
+static equation_p rewrite_fixpoint(equation_r in, Rules &rules)
 // ----------------------------------------------------------------------------
 //   Loop on the rewrites until the result stabilizes
 // ----------------------------------------------------------------------------
+//   Each pass still applies every candidate rule to the whole equation.
+//   Within one rule, a splice only revisits the replacement and its
+//   ancestors, but the next rule or pass starts again from the leaves.
+//   Revisiting only the path from the changed node to the root across
+//   rules is not implemented; the rule index limits the cost by skipping
+//   rules that cannot match anywhere in the equation.
 {
+    rule_index index;
+    if (!rewrite_index(rules, index))
+        return nullptr;
+
     uint count = 0;
     equation_g last = nullptr;
-    equation_g eq = this;
+    equation_g eq = in;
     while (count++ < Settings.maxrewrites && eq && eq.Safe() != last.Safe())
     {
         // Check if we produced the same value
@@ -785,7 +1175,7 @@ equation_p equation::rewrite_all(size_t size, const byte_p rewrites[]) const
             break;
 
         last = eq;
-        eq = eq->rewrite(size, rewrites);
+        eq = rewrite_pass(eq, rules, index);
     }
     if (count >= Settings.maxrewrites)
         rt.too_many_rewrites_error();
@@ -793,13 +1183,85 @@ equation_p equation::rewrite_all(size_t size, const byte_p rewrites[]) const
 }
 
 
+equation_p equation::rewrite(size_t size,
+                             const byte_p rewrites[],
+                             const id roots[]) const
+// ----------------------------------------------------------------------------
+//   Apply a series of rewrites
+// ----------------------------------------------------------------------------
+{
+    builtin_rules rules(size, rewrites, roots);
+    rule_index    index;
+    if (!rewrite_index(rules, index))
+        return nullptr;
+    return rewrite_pass(this, rules, index);
+}
+
+
+equation_p equation::rewrite_all(size_t size,
+                                 const byte_p rewrites[],
+                                 const id roots[]) const
+// ----------------------------------------------------------------------------
+//   Loop on the rewrites until the result stabilizes
+// ----------------------------------------------------------------------------
+{
+    builtin_rules rules(size, rewrites, roots);
+    return rewrite_fixpoint(this, rules);
+}
+
+
+equation_p equation::rewrite_all(list_r rules) const
+// ----------------------------------------------------------------------------
+//   Apply rules given as a list of alternating 'From' and 'To' patterns
+// ----------------------------------------------------------------------------
+{
+    size_t count = 0;
+    for (object_p obj : *rules)
+    {
+        if (obj->type() != ID_equation)
+        {
+            rt.type_error();
+            return nullptr;
+        }
+        count++;
+    }
+    if (count % 2)
+    {
+        rt.value_error();
+        return nullptr;
+    }
+    list_rules lrules(rules);
+    return rewrite_fixpoint(this, lrules);
+}
+
+
 COMMAND_BODY(Rewrite)
 // ----------------------------------------------------------------------------
 //   Rewrite (From, To, Value): Apply rewrites
 // ----------------------------------------------------------------------------
+//   The rules can also be given as a list { From To From To ... }
 {
     object_p x = rt.stack(0);
     object_p y = rt.stack(1);
+    if (!x || !y)
+        return ERROR;
+    if (x->type() == ID_list)
+    {
+        list_g     rules = list_p(x);
+        equation_g eq    = y->as<equation>();
+        if (!eq)
+        {
+            rt.type_error();
+            return ERROR;
+        }
+        eq = eq->rewrite_all(rules);
+        if (!eq)
+            return ERROR;
+        if (!rt.drop() || !rt.top(eq.Safe()))
+            return ERROR;
+        return OK;
+    }
+
     object_p z = rt.stack(2);
     if (!x || !y || !z)
         return ERROR;
@@ -823,6 +1285,152 @@ COMMAND_BODY(Rewrite)
 
 
 
+// ============================================================================
+//
+//    Memoization of rule set results
+//
+// ============================================================================
+//
+//    Programs often simplify or expand the same expression repeatedly.
+//    The most recent results are kept in a small direct-mapped table, keyed
+//    by a hash of the input equation, the rule set and the settings that
+//    may change the result. A hit is confirmed by comparing the input.
+//
+//    Entries are GC-safe pointers, so they keep inputs and outputs alive.
+//    The table is purged by garbage collection, see runtime::gc(), and
+//    when global variables or the current directory change, since rewrites
+//    may evaluate variables. Directories move as objects are collected, so
+//    a directory address cannot identify the context of an entry.
+//    Equations that refer to local variables are not memoized, since the
+//    values of the locals change from one invocation to the next.
+
+struct memo_entry
+// ----------------------------------------------------------------------------
+//   An entry in the memo table
+// ----------------------------------------------------------------------------
+{
+    uint32_t    key;
+    equation_g  input;
+    equation_g  output;
+};
+
+static const uint MEMO_ENTRIES = 8;
+static memo_entry memo_table[MEMO_ENTRIES];
+static uint       memo_hits   = 0;
+static uint       memo_misses = 0;
+
+
+static bool memo_local(equation_p eq)
+// ----------------------------------------------------------------------------
+//   Check if an equation refers to local variables
+// ----------------------------------------------------------------------------
+{
+    for (object_p obj : *eq)
+        if (obj->type() == object::ID_local)
+            return true;
+    return false;
+}
+
+
+static uint32_t memo_key(object::id rules, equation_p eq)
+// ----------------------------------------------------------------------------
+//   Compute a FNV-1a hash of the equation, rules and relevant settings
+// ----------------------------------------------------------------------------
+{
+    uint32_t hash = 2166136261u;
+    byte_p   p    = byte_p(eq);
+    size_t   size = eq->size();
+    uint32_t settings[] =
+    {
+        uint32_t(rules),
+        Settings.maxrewrites,
+        Settings.auto_simplify,
+        uint32_t(Settings.angle_mode),
+        Settings.precision
+    };
+    for (uint32_t s : settings)
+        hash = (hash ^ s) * 16777619u;
+    while (size--)
+        hash = (hash ^ *p++) * 16777619u;
+    return hash;
+}
+
+
+equation_p equation::memo_lookup(id rules) const
+// ----------------------------------------------------------------------------
+//   Return a memoized result for the given rule set, or nullptr
+// ----------------------------------------------------------------------------
+{
+    if (memo_local(this))
+        return nullptr;
+    uint32_t    key   = memo_key(rules, this);
+    memo_entry &entry = memo_table[key % MEMO_ENTRIES];
+    if (entry.key == key && entry.input && entry.output &&
+        entry.input->is_same_as(this))
+    {
+        memo_hits++;
+        record(equation_memo, "Hit %+s, %u hits %u misses",
+               name(rules), memo_hits, memo_misses);
+        return entry.output;
+    }
+    memo_misses++;
+    record(equation_memo, "Miss %+s, %u hits %u misses",
+           name(rules), memo_hits, memo_misses);
+    return nullptr;
+}
+
+
+void equation::memo_store(id rules, equation_r input, equation_r output)
+// ----------------------------------------------------------------------------
+//   Remember the result of applying a rule set to an input
+// ----------------------------------------------------------------------------
+{
+    if (!input.Safe() || !output.Safe() || rt.error())
+        return;
+    if (memo_local(input))
+        return;
+    uint32_t    key   = memo_key(rules, input);
+    memo_entry &entry = memo_table[key % MEMO_ENTRIES];
+    entry.key = key;
+    entry.input = input;
+    entry.output = output;
+}
+
+
+bool equation::memo_purge()
+// ----------------------------------------------------------------------------
+//   Purge the memo table, return true if this may free some memory
+// ----------------------------------------------------------------------------
+{
+    bool purged = false;
+    for (memo_entry &entry : memo_table)
+    {
+        if (entry.input || entry.output)
+            purged = true;
+        entry.input = nullptr;
+        entry.output = nullptr;
+    }
+    if (purged)
+        record(equation_memo, "Purged, %u hits %u misses",
+               memo_hits, memo_misses);
+    return purged;
+}
+
+
+uint equation::memo_entries()
+// ----------------------------------------------------------------------------
+//   Return the number of entries currently in the memo table
+// ----------------------------------------------------------------------------
+{
+    uint count = 0;
+    for (memo_entry &entry : memo_table)
+        if (entry.input && entry.output)
+            count++;
+    return count;
+}
+
+
+
 // ============================================================================
 //
 //    Actual rewrites for various rules
@@ -849,7 +1457,10 @@ equation_p equation::expand() const
 //   Run various rewrites to expand equation
 // ----------------------------------------------------------------------------
 {
-    return rewrite_all(
+    if (equation_p memo = memo_lookup(ID_Expand))
+        return memo;
+    equation_g input = this;
+    equation_g output = rewrite_all(
         (x+y)*z,     x*z+y*z,
         x*(y+z),     x*y+x*z,
         (x-y)*z,     x*z-y*z,
@@ -869,6 +1480,8 @@ equation_p equation::expand() const
         x + (y + z), (x + y) + z,
         x + (y - z), (x + y) - z
         );
+    memo_store(ID_Expand, input, output);
+    return output;
 }
 
 
@@ -877,7 +1490,10 @@ equation_p equation::collect() const
 //    Run various rewrites to collect terms / factor equation
 // ----------------------------------------------------------------------------
 {
-    return rewrite_all(
+    if (equation_p memo = memo_lookup(ID_Collect))
+        return memo;
+    equation_g input = this;
+    equation_g output = rewrite_all(
         x*z+y*z,                (x+y)*z,
         x*y+x*z,                x*(y+z),
         x*z-y*z,                (x-y)*z,
@@ -904,6 +1520,8 @@ equation_p equation::collect() const
         (x ^ n) * (y + x),      (x^(n+one)) + (x^n) * y,
         x + x,                  two * x
         );
+    memo_store(ID_Collect, input, output);
+    return output;
 }
 
 
@@ -912,7 +1530,10 @@ equation_p equation::simplify() const
 //   Run various rewrites to simplify equation
 // ----------------------------------------------------------------------------
 {
-    return rewrite_all(
+    if (equation_p memo = memo_lookup(ID_Simplify))
+        return memo;
+    equation_g input = this;
+    equation_g output = rewrite_all(
         x + zero,    x,
         zero + x,    x,
         x - zero,    x,
@@ -933,4 +1554,6 @@ equation_p equation::simplify() const
         x ^ mone,    inv(x),
         (x^n)*(x^m), x ^ (n+m)
         );
+    memo_store(ID_Simplify, input, output);
+    return output;
 }
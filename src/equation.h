@@ -93,8 +93,11 @@ struct equation : program
     {
         return rewrite(equation_g(from), equation_g(to));
     }
-    equation_p rewrite(size_t size, const byte_p rewrites[]) const;
-    equation_p rewrite_all(size_t size, const byte_p rewrites[]) const;
+    equation_p rewrite(size_t size, const byte_p rewrites[],
+                       const id roots[] = nullptr) const;
+    equation_p rewrite_all(size_t size, const byte_p rewrites[],
+                           const id roots[] = nullptr) const;
+    equation_p rewrite_all(list_r rules) const;
 
     static equation_p rewrite(equation_r eq, equation_r from, equation_r to)
     {
@@ -105,24 +108,31 @@ struct equation : program
     equation_p rewrite(args... rest) const
     {
         static constexpr byte_p rewrites[] = { rest.as_bytes()... };
-        return rewrite(sizeof...(rest), rewrites);
+        static constexpr id     roots[]    = { args::root()... };
+        return rewrite(sizeof...(rest), rewrites, roots);
     }
 
     template <typename ...args>
     equation_p rewrite_all(args... rest) const
     {
         static constexpr byte_p rewrites[] = { rest.as_bytes()... };
-        return rewrite_all(sizeof...(rest), rewrites);
+        static constexpr id     roots[]    = { args::root()... };
+        return rewrite_all(sizeof...(rest), rewrites, roots);
     }
 
     equation_p expand() const;
     equation_p collect() const;
     equation_p simplify() const;
 
+    // Memoization of expand, collect and simplify results
+    equation_p  memo_lookup(id rules) const;
+    static void memo_store(id rules, equation_r input, equation_r output);
+    static bool memo_purge();
+    static uint memo_entries();
+
 protected:
-    static symbol_g render(uint depth, int &precedence, bool edit);
-    static symbol_g parentheses(symbol_g what);
-    static symbol_g space(symbol_g what);
+    static int  precedence(object_p obj);
+    static bool render_reversed(renderer &r, uint depth, bool edit);
 
 public:
     OBJECT_DECL(equation);
@@ -160,6 +170,18 @@ struct eq
         return equation_p(object_data);
     }
 
+    // Operator at the root of the pattern, used to index rewrite rules
+    // A lone symbol matches anything, and is indexed as ID_object
+    static constexpr object::id root()
+    {
+        return sizeof...(args) == 3 && object_data[2] == object::ID_symbol
+            ? object::ID_object
+            : sizeof...(args) == 2 && (object_data[2] == object::ID_integer ||
+                                       object_data[2] == object::ID_neg_integer)
+            ? object::id(object_data[2])
+            : object::id(object_data[sizeof...(args) + 1]);
+    }
+
     // Negation operation
     eq<args..., object::ID_neg>
     operator-()         { return eq<args..., object::ID_neg>(); }
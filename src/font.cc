@@ -43,6 +43,7 @@ RECORDER(sparse_fonts,  16, "Information about sparse fonts");
 RECORDER(dense_fonts,   16, "Information about dense fonts");
 RECORDER(dmcp_fonts,    16, "Information about DMCP fonts");
 RECORDER(fonts_error,   16, "Information about fonts");
+RECORDER(font_cache,    16, "Glyph metrics cache");
 
 
 static const byte dmcpFontRPL[]
@@ -92,14 +93,28 @@ font_p HelpTitleFont;
 font_p HelpSubTitleFont;
 
 
+static struct
+// ----------------------------------------------------------------------------
+//   Built-in fonts that have precomputed offsets
+// ----------------------------------------------------------------------------
+{
+    font_p              fobj;
+    const font_offsets *offsets;
+} FontOffsets[3];
+
+
 void font_defaults()
 // ----------------------------------------------------------------------------
 //    Initialize the fonts for the user interface
 // ----------------------------------------------------------------------------
 {
-#define GENERATED_FONT(name)                    \
-    extern byte name##_sparse_font_data[];      \
-    name = (font_p) name##_sparse_font_data;
+    uint offsets = 0;
+#define GENERATED_FONT(name)                                            \
+    extern byte name##_sparse_font_data[];                              \
+    extern const font_offsets name##_sparse_font_offsets;               \
+    name = (font_p) name##_sparse_font_data;                            \
+    FontOffsets[offsets].fobj = name;                                   \
+    FontOffsets[offsets++].offsets = &name##_sparse_font_offsets;
 
     GENERATED_FONT(EditorFont);
     GENERATED_FONT(HelpFont);
@@ -118,15 +133,60 @@ void font_defaults()
 }
 
 
+const font_offsets *font::offsets() const
+// ----------------------------------------------------------------------------
+//   Return the precomputed offsets for built-in fonts
+// ----------------------------------------------------------------------------
+{
+    for (auto &fo : FontOffsets)
+        if (fo.fobj == this)
+            return fo.offsets;
+    return nullptr;
+}
+
+
+bool font_offsets::find(unicode codepoint, uint &index) const
+// ----------------------------------------------------------------------------
+//   Find the index of a glyph in the glyph table
+// ----------------------------------------------------------------------------
+{
+    // Binary search for the last range starting at or before codepoint
+    uint lo = 0;
+    uint hi = nranges;
+    while (lo < hi)
+    {
+        uint mid = (lo + hi) / 2;
+        if (ranges[mid].first <= codepoint)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (!lo)
+        return false;
+
+    const range &r = ranges[lo - 1];
+    if (codepoint >= unicode(r.first + r.count))
+        return false;
+    index = r.index + codepoint - r.first;
+    return index < nglyphs;
+}
+
+
 struct font_cache
 // ----------------------------------------------------------------------------
-//   A data structure to accelerate access to font offsets for a given font
+//   A direct-mapped cache of glyph metrics for several fonts at once
 // ----------------------------------------------------------------------------
+//   Text on screen frequently alternates between fonts (e.g. level numbers
+//   and stack contents) and between codepoint ranges (e.g. ASCII and arrows).
+//   Entries are indexed by a combination of font and codepoint, so that all
+//   glyphs in use remain cached with a fixed memory budget.
 {
     // Use same size as font data
     using fint  = font::fint;
     using fuint = font::fuint;
 
+    enum { ENTRIES = 256 };     // Number of entries, must be a power of two
+
     struct data
     // ------------------------------------------------------------------------
     //   Data in the cache
@@ -150,83 +210,72 @@ struct font_cache
         fuint  advance;         // Advance to next character
     };
 
-    font_cache(): fobj(), first(0), last(0), cache() {}
-
-    font_p cachedFont()
-    // ------------------------------------------------------------------------
-    //   Return the currently cached font
-    // ------------------------------------------------------------------------
-    {
-        return fobj;
-    }
-
-    fint firstCodePoint()
+    struct entry
     // ------------------------------------------------------------------------
-    //   Return first cached code point
+    //   An entry in the cache, identifying the font and codepoint
     // ------------------------------------------------------------------------
     {
-        return first;
-    }
+        font_p  fobj;           // Font for this entry, null if unused
+        unicode codepoint;      // Codepoint for this entry
+        data    glyph;          // Cached glyph data
+    };
 
+    font_cache(): entries(), hits(0), misses(0) {}
 
-    fint lastCodePoint()
+    static uint index(font_p f, unicode codepoint)
     // ------------------------------------------------------------------------
-    //   Return last cached code point
+    //   Index in the cache, keeping consecutive codepoints in distinct entries
     // ------------------------------------------------------------------------
     {
-        return last;
+        uint32_t hash = uint32_t(uintptr_t(f)) * 2654435761u;
+        return (codepoint + (hash >> 24)) & (ENTRIES - 1);
     }
 
-
-    data *range(font_p f, fuint firstCP, fuint lastCP)
+    data *get(font_p f, unicode codepoint)
     // ------------------------------------------------------------------------
-    //   Set the currently cached range in the font
+    //  Return cached data, or nullptr if not in the cache
     // ------------------------------------------------------------------------
     {
-        if (f != fobj || firstCP != first || lastCP != last)
+        entry &e = entries[index(f, codepoint)];
+        if (e.fobj == f && e.codepoint == codepoint)
         {
-            fuint count = lastCP - firstCP;
-            fobj = f;
-            first = firstCP;
-            last = lastCP;
-            cache = (data *) realloc(cache, count * sizeof(data));
-            data *ecache = cache + count;
-            for (data *p = cache; p < ecache; p++)
-                p->set(nullptr, 0, 0, 0, 0, 0);
+            hits++;
+            return &e.glyph;
         }
-        return cache;
+        misses++;
+        record(font_cache, "Miss %p codepoint %u, %u hits %u misses",
+               f, codepoint, hits, misses);
+        return nullptr;
     }
 
-    data *get(fint glyph) const
+    data *insert(font_p f, unicode codepoint)
     // ------------------------------------------------------------------------
-    //  Return cached data
+    //   Return the entry for a glyph, evicting what was there
     // ------------------------------------------------------------------------
     {
-        if (glyph >= first && glyph < last)
-            return cache + glyph - first;
-        return nullptr;
+        entry &e = entries[index(f, codepoint)];
+        e.fobj = f;
+        e.codepoint = codepoint;
+        return &e.glyph;
     }
 
-
-    bool set(fint glyph, byte_p bm, fint x, fint y, fuint w, fuint h, fuint a)
+    data *prefetch(font_p f, unicode codepoint)
     // ------------------------------------------------------------------------
-    //   Set the offset of the glyph in the font
+    //   Return the entry for a nearby glyph only if it does not evict another
     // ------------------------------------------------------------------------
     {
-        if (glyph >= first && glyph < last)
-        {
-            data *p = cache + glyph - first;
-            p->set(bm, x, y, w, h, a);
-            return true;
-        }
-        return false;
+        entry &e = entries[index(f, codepoint)];
+        if (e.fobj)
+            return nullptr;
+        e.fobj = f;
+        e.codepoint = codepoint;
+        return &e.glyph;
     }
 
 private:
-    font_p fobj;
-    fuint   first;
-    fuint   last;
-    data  *cache;
+    entry entries[ENTRIES];
+    uint  hits;
+    uint  misses;
 } FontCache;
 
 
@@ -253,10 +302,30 @@ bool sparse_font::glyph(unicode codepoint, glyph_info &g) const
     size_t UNUSED     size   = leb128<size_t>(p);
     fuint             height = leb128<fuint>(p);
 
-    // Check if cached
-    font_cache::data *data = FontCache.cachedFont() == this
-        ? FontCache.get(codepoint)
-        : nullptr;
+    // Direct access for fonts with precomputed offsets, otherwise use cache
+    font_cache::data  direct;
+    font_cache::data *data = nullptr;
+    if (const font_offsets *offsets = font::offsets())
+    {
+        uint index = 0;
+        if (!offsets->find(codepoint, index))
+        {
+            record(sparse_fonts, "Code point %u not in offsets", codepoint);
+            return false;
+        }
+        byte_p gp = byte_p(this) + offsets->glyphs[index];
+        fint   x  = leb128<fint>(gp);
+        fint   y  = leb128<fint>(gp);
+        fuint  w  = leb128<fuint>(gp);
+        fuint  h  = leb128<fuint>(gp);
+        fuint  a  = leb128<fuint>(gp);
+        direct.set(gp, x, y, w, h, a);
+        data = &direct;
+    }
+    else
+    {
+        data = FontCache.get(this, codepoint);
+    }
 
     record(sparse_fonts, "Looking up %u, got cache %p", codepoint, data);
     while (!data)
@@ -278,12 +347,7 @@ bool sparse_font::glyph(unicode codepoint, glyph_info &g) const
         fuint lastCP = firstCP + numCPs;
         bool  in = codepoint >= firstCP && codepoint < lastCP;
 
-        // Initialize cache for range of current code point
-        font_cache::data *cache = in
-            ? FontCache.range(this, firstCP, lastCP)
-            : nullptr;
-        if (cache)
-            record(sparse_fonts, "Caching in %p", cache);
+        // Cache the code point, and neighbours that do not evict anything
         for (fuint cp = firstCP; cp < lastCP; cp++)
         {
             fint  x = leb128<fint>(p);
@@ -291,15 +355,20 @@ bool sparse_font::glyph(unicode codepoint, glyph_info &g) const
             fuint w = leb128<fuint>(p);
             fuint h = leb128<fuint>(p);
             fuint a = leb128<fuint>(p);
-            if (cache)
+            if (in)
             {
-                cache->set(p, x, y, w, h, a);
-                if (cp == codepoint)
+                font_cache::data *cache = cp == codepoint
+                    ? FontCache.insert(this, cp)
+                    : FontCache.prefetch(this, cp);
+                if (cache)
                 {
-                    record(sparse_fonts, "Cache data is at %p", cache);
-                    data = cache;
+                    cache->set(p, x, y, w, h, a);
+                    if (cp == codepoint)
+                    {
+                        record(sparse_fonts, "Cache data is at %p", cache);
+                        data = cache;
+                    }
                 }
-                cache++;
             }
             size_t sparseBitmapBits = w * h;
             size_t sparseBitmapBytes = (sparseBitmapBits + 7) / 8;
@@ -353,10 +422,26 @@ bool dense_font::glyph(unicode codepoint, glyph_info &g) const
     fuint             width      = leb128<fuint>(p);
     byte_p            bitmap     = p;
 
-    // Check if cached
-    font_cache::data *data = FontCache.cachedFont() == this
-        ? FontCache.get(codepoint)
-        : nullptr;
+    // Direct access for fonts with precomputed offsets, otherwise use cache
+    font_cache::data  direct;
+    font_cache::data *data = nullptr;
+    if (const font_offsets *offsets = font::offsets())
+    {
+        uint index = 0;
+        if (!offsets->find(codepoint, index) || index + 1 >= offsets->nglyphs)
+        {
+            record(dense_fonts, "Code point %u not in offsets", codepoint);
+            return false;
+        }
+        fint  x  = offsets->glyphs[index];
+        fuint cw = offsets->glyphs[index + 1] - x;
+        direct.set(bitmap, x, 0, cw, height, cw);
+        data = &direct;
+    }
+    else
+    {
+        data = FontCache.get(this, codepoint);
+    }
 
     // Scan the font data
     fint   x          = 0;
@@ -379,19 +464,21 @@ bool dense_font::glyph(unicode codepoint, glyph_info &g) const
         fuint lastCP = firstCP + numCPs;
         bool in = codepoint >= firstCP && codepoint < lastCP;
 
-        // Initialize cache for range of current code point
-        font_cache::data *cache = in
-            ? FontCache.range(this, firstCP, lastCP)
-            : nullptr;
+        // Cache the code point, and neighbours that do not evict anything
         for (fuint cp = firstCP; cp < lastCP; cp++)
         {
             fuint cw = leb128<fuint>(p);
-            if (cache)
+            if (in)
             {
-                cache->set(bitmap, x, 0, cw, height, cw);
-                if (cp == codepoint)
-                    data = cache;
-                cache++;
+                font_cache::data *cache = cp == codepoint
+                    ? FontCache.insert(this, cp)
+                    : FontCache.prefetch(this, cp);
+                if (cache)
+                {
+                    cache->set(bitmap, x, 0, cw, height, cw);
+                    if (cp == codepoint)
+                        data = cache;
+                }
             }
             x += cw;
         }
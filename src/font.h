@@ -36,6 +36,30 @@
 RECORDER_DECLARE(fonts);
 RECORDER_DECLARE(fonts_error);
 
+// Two-byte LEB128 encoding of a font type, used in generated font data
+#define FONT_TYPE_ID(id)        (((id) & 0x7F) | 0x80), (((id) >> 7) & 0x7F)
+
+struct font_offsets
+// ----------------------------------------------------------------------------
+//   Precomputed glyph offsets emitted by ttf2font for direct glyph access
+// ----------------------------------------------------------------------------
+{
+    struct range
+    {
+        uint16_t first;         // First code point in range
+        uint16_t count;         // Number of code points in range
+        uint32_t index;         // Index of the first glyph in glyph table
+    };
+
+    const range    *ranges;     // Ranges, sorted by code point
+    uint            nranges;    // Number of ranges
+    const uint32_t *glyphs;     // Sparse: offset of glyph data, dense: X
+    uint            nglyphs;    // Number of entries in glyph table
+
+    bool find(unicode codepoint, uint &index) const;
+};
+
+
 struct font : object
 // ----------------------------------------------------------------------------
 //   Shared by all font objects
@@ -92,6 +116,9 @@ struct font : object
     }
     fuint height() const;
 
+    // Precomputed offsets for built-in fonts, nullptr for other fonts
+    const font_offsets *offsets() const;
+
 public:
     SIZE_DECL(font)
     {
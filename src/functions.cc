@@ -31,12 +31,17 @@
 
 #include "arithmetic.h"
 #include "array.h"
+#include "big_decimal.h"
 #include "bignum.h"
+#include "decimal-32.h"
+#include "decimal-64.h"
 #include "decimal128.h"
 #include "equation.h"
 #include "fraction.h"
+#include "hwdouble.h"
 #include "integer.h"
 #include "list.h"
+#include "polynomial.h"
 
 
 bool function::should_be_symbolic(id type)
@@ -59,7 +64,11 @@ algebraic_p function::symbolic(id op, algebraic_r x)
 }
 
 
-object::result function::evaluate(id op, bid128_fn op128, complex_fn zop)
+object::result function::evaluate(id         op,
+                                  bid128_fn  op128,
+                                  bid64_fn   op64,
+                                  bid32_fn   op32,
+                                  complex_fn zop)
 // ----------------------------------------------------------------------------
 //   Shared code for evaluation of all common math functions
 // ----------------------------------------------------------------------------
@@ -67,7 +76,7 @@ object::result function::evaluate(id op, bid128_fn op128, complex_fn zop)
     algebraic_g x = algebraic_p(rt.top());
     if (!x)
         return ERROR;
-    x = evaluate(x, op ,op128, zop);
+    x = evaluate(x, op, op128, op64, op32, zop);
     if (x && rt.top(x))
         return OK;
     return ERROR;
@@ -138,6 +147,66 @@ void function::adjust_to_angle(bid128 &x)
 }
 
 
+void function::adjust_from_angle(bid64 &x)
+// ----------------------------------------------------------------------------
+//   Adjust a decimal64 angle value, using decimal128 for the constants
+// ----------------------------------------------------------------------------
+{
+    if (Settings.angle_mode != Settings.RADIANS)
+    {
+        bid128 wide;
+        bid64_to_bid128(&wide.value, &x.value);
+        adjust_from_angle(wide);
+        bid128_to_bid64(&x.value, &wide.value);
+    }
+}
+
+
+void function::adjust_from_angle(bid32 &x)
+// ----------------------------------------------------------------------------
+//   Adjust a decimal32 angle value, using decimal128 for the constants
+// ----------------------------------------------------------------------------
+{
+    if (Settings.angle_mode != Settings.RADIANS)
+    {
+        bid128 wide;
+        bid32_to_bid128(&wide.value, &x.value);
+        adjust_from_angle(wide);
+        bid128_to_bid32(&x.value, &wide.value);
+    }
+}
+
+
+void function::adjust_to_angle(bid64 &x)
+// ----------------------------------------------------------------------------
+//   Adjust a decimal64 result from asin/acos/atan
+// ----------------------------------------------------------------------------
+{
+    if (Settings.angle_mode != Settings.RADIANS)
+    {
+        bid128 wide;
+        bid64_to_bid128(&wide.value, &x.value);
+        adjust_to_angle(wide);
+        bid128_to_bid64(&x.value, &wide.value);
+    }
+}
+
+
+void function::adjust_to_angle(bid32 &x)
+// ----------------------------------------------------------------------------
+//   Adjust a decimal32 result from asin/acos/atan
+// ----------------------------------------------------------------------------
+{
+    if (Settings.angle_mode != Settings.RADIANS)
+    {
+        bid128 wide;
+        bid32_to_bid128(&wide.value, &x.value);
+        adjust_to_angle(wide);
+        bid128_to_bid32(&x.value, &wide.value);
+    }
+}
+
+
 bool function::adjust_to_angle(algebraic_g &x)
 // ----------------------------------------------------------------------------
 //   Adjust an angle value for asin/acos/atan
@@ -145,6 +214,21 @@ bool function::adjust_to_angle(algebraic_g &x)
 {
     if (!init)
         adjust_init();
+    if (x->type() == ID_hwdouble)
+    {
+        if (Settings.angle_mode == Settings.RADIANS)
+            return false;
+        x = hwdouble::to_angle(x);
+        return true;
+    }
+    if (x->type() == ID_big_decimal)
+    {
+        // Convert with all the digits of the current precision
+        if (Settings.angle_mode == Settings.RADIANS)
+            return false;
+        x = big_decimal::to_angle(x);
+        return true;
+    }
     if (x->is_real())
     {
         bid128 *adjust = nullptr;
@@ -241,9 +325,66 @@ bool function::exact_trig(id op, algebraic_g &x)
 }
 
 
+static inline bool is_finite(bid128 &x)
+// ----------------------------------------------------------------------------
+//   Check if a bid128 result is finite
+// ----------------------------------------------------------------------------
+{
+    int finite = false;
+    bid128_isFinite(&finite, &x.value);
+    return finite;
+}
+
+
+static inline bool is_finite(bid64 &x)
+// ----------------------------------------------------------------------------
+//   Check if a bid64 result is finite
+// ----------------------------------------------------------------------------
+{
+    int finite = false;
+    bid64_isFinite(&finite, &x.value);
+    return finite;
+}
+
+
+static inline bool is_finite(bid32 &x)
+// ----------------------------------------------------------------------------
+//   Check if a bid32 result is finite
+// ----------------------------------------------------------------------------
+{
+    int finite = false;
+    bid32_isFinite(&finite, &x.value);
+    return finite;
+}
+
+
+template <typename Dec, typename Bid, typename Fn>
+static algebraic_p decimal_evaluate(algebraic_r x, object::id op, Fn fn)
+// ----------------------------------------------------------------------------
+//   Evaluate a library function on a decimal of the matching size
+// ----------------------------------------------------------------------------
+{
+    Bid xv = ((const Dec *) x.Safe())->value();
+    Bid res;
+    if (op == object::ID_sin || op == object::ID_cos || op == object::ID_tan)
+        function::adjust_from_angle(xv);
+    fn(&res.value, &xv.value);
+    if (!is_finite(res))
+    {
+        rt.domain_error();
+        return nullptr;
+    }
+    if (op == object::ID_asin || op == object::ID_acos || op == object::ID_atan)
+        function::adjust_to_angle(res);
+    return rt.make<Dec>(Dec::static_id, res);
+}
+
+
 algebraic_p function::evaluate(algebraic_r xr,
                                id          op,
                                bid128_fn   op128,
+                               bid64_fn    op64,
+                               bid32_fn    op32,
                                complex_fn  zop)
 // ----------------------------------------------------------------------------
 //   Shared code for evaluation of all common math functions
@@ -280,27 +421,40 @@ algebraic_p function::evaluate(algebraic_r xr,
         }
     }
 
-    // Call the right function
-    // We need to only call the bid128 functions here, because the 32 and 64
-    // variants are not in the DM42's QSPI, and take too much space here
+    // Select the decimal type from the precision, keeping input precision
+    id ty = real_type();
+    if (is_decimal(xt) && xt > ty)
+        ty = xt;
+
+    // Hardware floating-point and variable-precision decimals have kernels
+    if (ty == ID_hwdouble && real_promotion(x, ty))
+        return hwdouble::evaluate(op, x, op128);
+    if (ty == ID_big_decimal && real_promotion(x, ty))
+        return big_decimal::evaluate(op, x, op128);
+
+    // Use the native 32 and 64 variants when they are available
+    if (ty == ID_decimal32 && op32 && real_promotion(x, ty))
+        return decimal_evaluate<decimal32, bid32>(x, op, op32);
+    if (ty == ID_decimal64 && op64 && real_promotion(x, ty))
+        return decimal_evaluate<decimal64, bid64>(x, op, op64);
+
+    // Otherwise compute with bid128, and narrow the result to the target type
     if (real_promotion(x, ID_decimal128))
     {
-        bid128 xv = decimal128_p(algebraic_p(x))->value();
-        bid128 res;
-        if (op == ID_sin || op == ID_cos || op == ID_tan)
-            adjust_from_angle(xv);
-        op128(&res.value, &xv.value);
-        int finite = false;
-        bid128_isFinite(&finite, &res.value);
-        if (!finite)
+        x = decimal_evaluate<decimal128, bid128>(x, op, op128);
+        if (!x || ty == ID_decimal128)
+            return x;
+
+        bid128 wide = decimal128_p(algebraic_p(x))->value();
+        if (ty == ID_decimal64)
         {
-            rt.domain_error();
-            return nullptr;
+            bid64 res;
+            bid128_to_bid64(&res.value, &wide.value);
+            return rt.make<decimal64>(ID_decimal64, res);
         }
-        if (op == ID_asin || op == ID_acos || op == ID_atan)
-            adjust_to_angle(res);
-        x = rt.make<decimal128>(ID_decimal128, res);
-        return x;
+        bid32 res;
+        bid128_to_bid32(&res.value, &wide.value);
+        return rt.make<decimal32>(ID_decimal32, res);
     }
 
     // All other cases: report an error
@@ -375,7 +529,11 @@ FUNCTION_BODY(abs)
     }
 
     // Fall-back to floating-point abs
-    return function::evaluate(x, ID_abs, bid128_abs, nullptr);
+    return function::evaluate(x, ID_abs,
+                              bid128_abs,
+                              DECIMAL_FUNCTION(64, abs),
+                              DECIMAL_FUNCTION(32, abs),
+                              nullptr);
 }
 
 
@@ -657,8 +815,17 @@ FUNCTION_BODY(Expand)
 {
     if (!x.Safe())
         return nullptr;
-    if (equation_p eq = x->as<equation>())
+    if (equation_g eq = x->as<equation>())
+    {
+        // Univariate polynomials are put in canonical form directly.
+        // Anything else, e.g. '(A+B)^N', goes through the rewrite rules,
+        // where the number of terms still grows exponentially with N
+        if (polynomial_g poly = polynomial::make(eq))
+            return poly->as_algebraic();
+        if (rt.error())
+            return nullptr;
         return algebraic_p(eq->expand());
+    }
     if (x->is_algebraic())
         return x;
     rt.type_error();
@@ -673,8 +840,15 @@ FUNCTION_BODY(Collect)
 {
     if (!x.Safe())
         return nullptr;
-    if (equation_p eq = x->as<equation>())
+    if (equation_g eq = x->as<equation>())
+    {
+        // Univariate polynomials are put in canonical form directly
+        if (polynomial_g poly = polynomial::make(eq))
+            return poly->as_algebraic();
+        if (rt.error())
+            return nullptr;
         return algebraic_p(eq->collect());
+    }
     if (x->is_algebraic())
         return x;
     rt.type_error();
@@ -722,6 +896,12 @@ FUNCTION_BODY(ToDecimal)
             (mod->is_fraction() || arithmetic::real_promotion(arg)))
             return polar::make(mod, arg, settings::PI_RADIANS);
     }
+    else if (xg->type() == ID_hwdouble)
+    {
+        // Explicit conversion of a hardware floating-point value to decimal
+        if (arithmetic::real_promotion(xg, arithmetic::real_type(false)))
+            return xg;
+    }
     else if (arithmetic::real_promotion(xg))
     {
         return xg;
@@ -36,6 +36,24 @@
 #include "runtime.h"
 
 
+#ifndef CONFIG_NATIVE_DECIMAL_FUNCTIONS
+// Linking the bid32 and bid64 variants of the library functions on DM42 adds
+// about 124K of code to the 704K program flash, and 41K of initialized data
+// (private copies of the argument reduction tables in sin, cos and tan) to
+// an 8K RAM region. On that target, we compute with bid128 and narrow
+#ifdef SIMULATOR
+#define CONFIG_NATIVE_DECIMAL_FUNCTIONS         1
+#else
+#define CONFIG_NATIVE_DECIMAL_FUNCTIONS         0
+#endif
+#endif // CONFIG_NATIVE_DECIMAL_FUNCTIONS
+
+#if CONFIG_NATIVE_DECIMAL_FUNCTIONS
+#define DECIMAL_FUNCTION(size, fn)      bid##size##_##fn
+#else
+#define DECIMAL_FUNCTION(size, fn)      ((bid##size##_fn) nullptr)
+#endif // CONFIG_NATIVE_DECIMAL_FUNCTIONS
+
 struct function : algebraic
 // ----------------------------------------------------------------------------
 //   Shared logic for all standard functions
@@ -47,13 +65,16 @@ struct function : algebraic
 public:
     typedef complex_g (*complex_fn)(complex_r x);
 
-    static result evaluate(id op, bid128_fn op128, complex_fn zop);
+    static result evaluate(id op,
+                           bid128_fn op128, bid64_fn op64, bid32_fn op32,
+                           complex_fn zop);
     // ------------------------------------------------------------------------
     //   Stack-based evaluation for all functions implemented in BID library
     // ------------------------------------------------------------------------
 
     static algebraic_p evaluate(algebraic_r x, id op,
-                                bid128_fn op128, complex_fn zop);
+                                bid128_fn op128, bid64_fn op64, bid32_fn op32,
+                                complex_fn zop);
     // ------------------------------------------------------------------------
     //   C++ evaluation for all functions implemented in BID library
     // ------------------------------------------------------------------------
@@ -76,7 +97,11 @@ public:
     static bool exact_trig(id op, algebraic_g &x);
 
     static void adjust_from_angle(bid128 &x);
+    static void adjust_from_angle(bid64 &x);
+    static void adjust_from_angle(bid32 &x);
     static void adjust_to_angle(bid128 &x);
+    static void adjust_to_angle(bid64 &x);
+    static void adjust_to_angle(bid32 &x);
     static bool adjust_to_angle(algebraic_g &x);
 
     static const bool does_matrices = false;
@@ -92,6 +117,8 @@ struct derived : function                                               \
     derived(id i = ID_##derived) : function(i) {}                       \
                                                                         \
     static constexpr auto bid128_op = bid128_##derived;                 \
+    static constexpr auto bid64_op = DECIMAL_FUNCTION(64, derived);     \
+    static constexpr auto bid32_op = DECIMAL_FUNCTION(32, derived);     \
     static constexpr complex_fn zop = complex::derived;                 \
                                                                         \
 public:                                                                 \
@@ -110,7 +137,8 @@ public:                                                                 \
     static algebraic_g run(algebraic_r x) { return evaluate(x); }       \
     static algebraic_p evaluate(algebraic_r x)                          \
     {                                                                   \
-        return function::evaluate(x, ID_##derived, bid128_op, zop);     \
+        return function::evaluate(x, ID_##derived,                      \
+                                  bid128_op, bid64_op, bid32_op, zop);  \
     }                                                                   \
 }
 
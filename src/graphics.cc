@@ -99,6 +99,8 @@ static coord to_coord(object_g pos, uint scaling)
     case object::ID_decimal32:
     case object::ID_decimal64:
     case object::ID_decimal128:
+    case object::ID_big_decimal:
+    case object::ID_hwdouble:
     {
         algebraic_g ya = algebraic_p(pos.Safe());
         if (algebraic::real_promotion(ya, object::ID_decimal128))
@@ -0,0 +1,505 @@
+// ****************************************************************************
+//  hwdouble.cc                                                   DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Real numbers using hardware binary floating-point
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "hwdouble.h"
+
+#include "bignum.h"
+#include "decimal-32.h"
+#include "decimal-64.h"
+#include "decimal128.h"
+#include "fraction.h"
+#include "integer.h"
+#include "parser.h"
+#include "renderer.h"
+#include "settings.h"
+#include "utf8.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+RECORDER(hwdouble, 16, "Hardware floating-point numbers");
+
+
+// Largest number of digits needed to identify a double
+static const int HWDOUBLE_DIGITS = 17;
+
+
+static double bignum_value(bignum_p b, int &scale)
+// ----------------------------------------------------------------------------
+//   Convert a bignum to the nearest double, times 2^scale
+// ----------------------------------------------------------------------------
+//   Large values are scaled down as we go so that the result never overflows.
+//   Low bytes that are scaled down beyond the double precision are lost.
+{
+    size_t size   = 0;
+    byte_p bytes  = b->value(&size);
+    double result = 0.0;
+    scale = 0;
+    while (size--)
+    {
+        result = result * 256.0 + std::ldexp(double(bytes[size]), -scale);
+        if (result > 0x1p512)
+        {
+            result = std::ldexp(result, -512);
+            scale += 512;
+        }
+    }
+    if (b->type() == object::ID_neg_bignum)
+        result = -result;
+    return result;
+}
+
+
+static hwdouble_p make_finite(double value)
+// ----------------------------------------------------------------------------
+//   Build a hardware floating-point value, error if out of range
+// ----------------------------------------------------------------------------
+{
+    if (!std::isfinite(value))
+    {
+        rt.number_too_big_error();
+        return nullptr;
+    }
+    return hwdouble::make(value);
+}
+
+
+static double radians(double x, bool to)
+// ----------------------------------------------------------------------------
+//   Convert between the current angle mode and radians
+// ----------------------------------------------------------------------------
+{
+    double factor = 1.0;
+    switch(Settings.angle_mode)
+    {
+    case settings::DEGREES:     factor = M_PI / 180.0;  break;
+    case settings::GRADS:       factor = M_PI / 200.0;  break;
+    case settings::PI_RADIANS:  factor = M_PI;          break;
+    default:                                            break;
+    }
+    return to ? x * factor : x / factor;
+}
+
+
+
+// ============================================================================
+//
+//   Conversions
+//
+// ============================================================================
+
+hwdouble_p hwdouble::make(algebraic_r xr)
+// ----------------------------------------------------------------------------
+//   Convert a real value to hardware floating-point
+// ----------------------------------------------------------------------------
+{
+    if (!xr.Safe())
+        return nullptr;
+
+    algebraic_g x  = xr;
+    id          xt = x->type();
+    switch(xt)
+    {
+    case ID_hwdouble:
+        return hwdouble_p(x.Safe());
+
+    case ID_integer:
+        return make(double(integer_p(x.Safe())->value<ularge>()));
+    case ID_neg_integer:
+        return make(-double(integer_p(x.Safe())->value<ularge>()));
+
+    case ID_bignum:
+    case ID_neg_bignum:
+    {
+        int    scale = 0;
+        double value = bignum_value(bignum_p(x.Safe()), scale);
+        return make_finite(std::ldexp(value, scale));
+    }
+
+    case ID_fraction:
+    case ID_neg_fraction:
+    case ID_big_fraction:
+    case ID_neg_big_fraction:
+    {
+        // Divide the scaled values, so that large operands do not give NaN
+        fraction_g f  = fraction_p(x.Safe());
+        bignum_g   n  = f->numerator();
+        bignum_g   d  = f->denominator();
+        int        ns = 0;
+        int        ds = 0;
+        double     nv = bignum_value(n, ns);
+        double     dv = bignum_value(d, ds);
+        return make_finite(std::ldexp(nv / dv, ns - ds));
+    }
+
+    case ID_decimal32:
+    case ID_decimal64:
+    case ID_decimal128:
+    case ID_big_decimal:
+    {
+        // The BID library emits strings like +12345E-2 that strtod accepts
+        if (!real_promotion(x, ID_decimal128))
+            return nullptr;
+        bid128 v = decimal128_p(x.Safe())->value();
+        char buf[64];
+        bid128_to_string(buf, &v.value);
+        return make(strtod(buf, nullptr));
+    }
+
+    default:
+        break;
+    }
+
+    rt.type_error();
+    return nullptr;
+}
+
+
+size_t hwdouble::shortest(char *buf, size_t len, double value)
+// ----------------------------------------------------------------------------
+//   Emit the shortest digits that read back as the same value
+// ----------------------------------------------------------------------------
+//   The output uses the format of the BID library, e.g. +12345E-2, so that
+//   it can be given to decimal_format or to bidXX_from_string
+{
+    if (std::isnan(value))
+        return snprintf(buf, len, "+NaN");
+    if (std::isinf(value))
+        return snprintf(buf, len, "%cInf", value < 0 ? '-' : '+');
+    if (value == 0.0)
+        return snprintf(buf, len, "+0E0");
+
+    char tmp[32];
+    for (int digits = 1; digits <= HWDOUBLE_DIGITS; digits++)
+    {
+        snprintf(tmp, sizeof(tmp), "%.*e", digits - 1, value);
+        if (strtod(tmp, nullptr) == value)
+            break;
+    }
+
+    // Convert -d.ddde+XX into -dddEYY
+    char *in  = tmp;
+    char *out = buf;
+    char *end = buf + len - 1;
+    *out++ = *in == '-' ? *in++ : '+';
+    int count = 0;
+    while (*in && *in != 'e' && out < end)
+    {
+        if (*in >= '0' && *in <= '9')
+        {
+            *out++ = *in;
+            count++;
+        }
+        in++;
+    }
+    int exponent = *in == 'e' ? atoi(in + 1) : 0;
+    out += snprintf(out, end - out + 1, "E%d", exponent - (count - 1));
+    return out - buf;
+}
+
+
+algebraic_p hwdouble::to_decimal(id type) const
+// ----------------------------------------------------------------------------
+//   Convert to the given decimal type, using the shortest representation
+// ----------------------------------------------------------------------------
+//   This way, 0.1 converts to the decimal 0.1 and not 0.1000000000000000055
+{
+    char buf[64];
+    shortest(buf, sizeof(buf), value());
+    switch(type)
+    {
+    case ID_decimal32:
+    {
+        bid32 v;
+        bid32_from_string(&v.value, buf);
+        return rt.make<decimal32>(ID_decimal32, v);
+    }
+    case ID_decimal64:
+    {
+        bid64 v;
+        bid64_from_string(&v.value, buf);
+        return rt.make<decimal64>(ID_decimal64, v);
+    }
+    case ID_decimal128:
+    {
+        bid128 v;
+        bid128_from_string(&v.value, buf);
+        return rt.make<decimal128>(ID_decimal128, v);
+    }
+    default:
+        break;
+    }
+    rt.type_error();
+    return nullptr;
+}
+
+
+
+// ============================================================================
+//
+//   Evaluation of arithmetic and functions
+//
+// ============================================================================
+
+algebraic_p hwdouble::evaluate(id op, algebraic_r xr, algebraic_r yr)
+// ----------------------------------------------------------------------------
+//   Arithmetic operations, called from arithmetic::evaluate
+// ----------------------------------------------------------------------------
+{
+    if (!xr.Safe() || !yr.Safe())
+        return nullptr;
+    double x = hwdouble_p(xr.Safe())->value();
+    double y = hwdouble_p(yr.Safe())->value();
+    double r;
+    switch(op)
+    {
+    case ID_add:        r = x + y;                      break;
+    case ID_sub:        r = x - y;                      break;
+    case ID_mul:        r = x * y;                      break;
+    case ID_div:
+    case ID_mod:
+    case ID_rem:
+        if (y == 0.0)
+        {
+            rt.zero_divide_error();
+            return nullptr;
+        }
+        if (op == ID_div)
+        {
+            r = x / y;
+        }
+        else
+        {
+            // For mod, the result has the sign of the divisor
+            r = std::fmod(x, y);
+            if (op == ID_mod && r != 0.0 && (r < 0.0) != (y < 0.0))
+                r += y;
+        }
+        break;
+    case ID_pow:        r = std::pow(x, y);             break;
+    case ID_hypot:      r = std::hypot(x, y);           break;
+    case ID_atan2:      r = std::atan2(x, y);           break;
+    default:
+        rt.type_error();
+        return nullptr;
+    }
+
+    if (!std::isfinite(r))
+    {
+        rt.domain_error();
+        return nullptr;
+    }
+    return make(r);
+}
+
+
+algebraic_p hwdouble::evaluate(id op, algebraic_r xr, bid128_fn op128)
+// ----------------------------------------------------------------------------
+//   Functions, called from function::evaluate
+// ----------------------------------------------------------------------------
+{
+    if (!xr.Safe())
+        return nullptr;
+    double x = hwdouble_p(xr.Safe())->value();
+    double r;
+    switch(op)
+    {
+    case ID_abs:        r = std::fabs(x);                       break;
+    case ID_sqrt:       r = std::sqrt(x);                       break;
+    case ID_cbrt:       r = std::cbrt(x);                       break;
+    case ID_sin:        r = std::sin(radians(x, true));         break;
+    case ID_cos:        r = std::cos(radians(x, true));         break;
+    case ID_tan:        r = std::tan(radians(x, true));         break;
+    case ID_asin:       r = radians(std::asin(x), false);       break;
+    case ID_acos:       r = radians(std::acos(x), false);       break;
+    case ID_atan:       r = radians(std::atan(x), false);       break;
+    case ID_sinh:       r = std::sinh(x);                       break;
+    case ID_cosh:       r = std::cosh(x);                       break;
+    case ID_tanh:       r = std::tanh(x);                       break;
+    case ID_asinh:      r = std::asinh(x);                      break;
+    case ID_acosh:      r = std::acosh(x);                      break;
+    case ID_atanh:      r = std::atanh(x);                      break;
+    case ID_log1p:      r = std::log1p(x);                      break;
+    case ID_expm1:      r = std::expm1(x);                      break;
+    case ID_log:        r = std::log(x);                        break;
+    case ID_log10:      r = std::log10(x);                      break;
+    case ID_log2:       r = std::log2(x);                       break;
+    case ID_exp:        r = std::exp(x);                        break;
+    case ID_exp10:      r = std::pow(10.0, x);                  break;
+    case ID_exp2:       r = std::exp2(x);                       break;
+    case ID_erf:        r = std::erf(x);                        break;
+    case ID_erfc:       r = std::erfc(x);                       break;
+    case ID_tgamma:     r = std::tgamma(x);                     break;
+    case ID_lgamma:     r = std::lgamma(x);                     break;
+
+    default:
+    {
+        // Functions without a hardware equivalent go through decimal128
+        if (!op128)
+        {
+            rt.type_error();
+            return nullptr;
+        }
+        algebraic_g d = hwdouble_p(xr.Safe())->to_decimal(ID_decimal128);
+        if (!d)
+            return nullptr;
+        bid128 v = decimal128_p(d.Safe())->value();
+        bid128 res;
+        op128(&res.value, &v.value);
+        char buf[64];
+        bid128_to_string(buf, &res.value);
+        r = strtod(buf, nullptr);
+        break;
+    }
+    }
+
+    if (!std::isfinite(r))
+    {
+        rt.domain_error();
+        return nullptr;
+    }
+    return make(r);
+}
+
+
+algebraic_p hwdouble::to_angle(algebraic_r x)
+// ----------------------------------------------------------------------------
+//   Convert a result in radians to the current angle mode
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe())
+        return nullptr;
+    return make(radians(hwdouble_p(x.Safe())->value(), false));
+}
+
+
+
+// ============================================================================
+//
+//   Object interface
+//
+// ============================================================================
+
+SIZE_BODY(hwdouble)
+// ----------------------------------------------------------------------------
+//    Compute size for a hardware double payload
+// ----------------------------------------------------------------------------
+{
+    return ptrdiff(o->payload(), o) + sizeof(double);
+}
+
+
+PARSE_BODY(hwdouble)
+// ----------------------------------------------------------------------------
+//    Parse real numbers when hardware floating-point is selected
+// ----------------------------------------------------------------------------
+//    Numbers that do not fit in a double, or need more digits than it can
+//    represent, are left to the decimal parsers.
+{
+    if (algebraic::real_type() != ID_hwdouble)
+        return SKIP;
+
+    utf8 source = p.source;
+    utf8 s      = source;
+    utf8 last   = source + p.length;
+    char buf[64];
+    char *out   = buf;
+    char *end   = buf + sizeof(buf) - 8;
+
+    // Skip leading sign
+    if (*s == '+' || *s == '-')
+    {
+        // In an equation, `1 + 3` should interpret `+` as an infix
+        if (p.precedence < 0)
+            return SKIP;
+        *out++ = *s++;
+    }
+
+    // Mantissa, with an optional decimal separator
+    int  digits  = 0;
+    bool nonzero = false;
+    while (s < last && *s >= '0' && *s <= '9' && out < end)
+    {
+        nonzero |= *s != '0';
+        digits++;
+        *out++ = *s++;
+    }
+    if (s < last && *s == Settings.decimal_mark)
+    {
+        *out++ = '.';
+        s++;
+        while (s < last && *s >= '0' && *s <= '9' && out < end)
+        {
+            nonzero |= *s != '0';
+            digits++;
+            *out++ = *s++;
+        }
+    }
+    if (!digits || digits > HWDOUBLE_DIGITS)
+        return SKIP;
+
+    // Exponent
+    if (s < last &&
+        (*s == 'e' || *s == 'E' || utf8_codepoint(s) == Settings.exponent_mark))
+    {
+        s = utf8_next(s);
+        *out++ = 'e';
+        if (*s == '+' || *s == '-')
+            *out++ = *s++;
+        utf8 expval = s;
+        while (s < last && *s >= '0' && *s <= '9' && out < end)
+            *out++ = *s++;
+        if (s == expval)
+            return SKIP;
+    }
+    *out = 0;
+
+    // Leave overflow and underflow to decimal types
+    double value = strtod(buf, nullptr);
+    if (!std::isfinite(value) || (nonzero && value == 0.0))
+        return SKIP;
+
+    record(hwdouble, "Parsed [%s] as %g", buf, value);
+    p.end = s - source;
+    p.out = make(value);
+    return p.out ? OK : ERROR;
+}
+
+
+RENDER_BODY(hwdouble)
+// ----------------------------------------------------------------------------
+//   Render using the shortest representation and the decimal formatting
+// ----------------------------------------------------------------------------
+{
+    char buf[256];
+    shortest(buf, sizeof(buf), o->value());
+    size_t sz = decimal_format(buf, sizeof(buf), !r.stack(), r.file_save());
+    return r.put(buf, sz) ? sz : 0;
+}
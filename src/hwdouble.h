@@ -0,0 +1,99 @@
+#ifndef HWDOUBLE_H
+#define HWDOUBLE_H
+// ****************************************************************************
+//  hwdouble.h                                                    DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Real numbers using hardware binary floating-point (IEEE-754 double)
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+//
+// Payload format:
+//
+//   A copy of the 64-bit binary representation follows the type.
+//   As for decimal128, the payload may be misaligned, so it is copied.
+//
+//   These objects are only created when HardwareFloatingPoint is set and
+//   the precision is 16 digits or less. They trade decimal exactness
+//   (e.g. 0.1 is not exactly representable) for speed.
+
+#include "algebraic.h"
+#include "runtime.h"
+
+#include <cstring>
+
+GCP(hwdouble);
+
+struct hwdouble : algebraic
+// ----------------------------------------------------------------------------
+//    Floating-point numbers in IEEE-754 double representation
+// ----------------------------------------------------------------------------
+{
+    hwdouble(double value, id type = ID_hwdouble): algebraic(type)
+    {
+        byte *p = (byte *) payload(this);
+        memcpy(p, &value, sizeof(value));
+    }
+
+    static size_t required_memory(id i, double UNUSED value)
+    {
+        return leb128size(i) + sizeof(double);
+    }
+
+    double value() const
+    {
+        double result;
+        memcpy(&result, payload(), sizeof(result));
+        return result;
+    }
+
+    static hwdouble_p make(double value)
+    {
+        return rt.make<hwdouble>(ID_hwdouble, value);
+    }
+
+    // Conversion from other real types, and back to decimal types
+    static hwdouble_p   make(algebraic_r x);
+    algebraic_p         to_decimal(id type) const;
+
+    // Shortest text that converts back to the same value, in BID format
+    static size_t       shortest(char *buf, size_t len, double value);
+
+    bool is_zero() const        { return value() == 0.0; }
+    bool is_one() const         { return value() == 1.0; }
+    bool is_negative() const    { return value() < 0.0; }
+
+    // Evaluation of arithmetic and functions
+    static algebraic_p  evaluate(id op, algebraic_r x, algebraic_r y);
+    static algebraic_p  evaluate(id op, algebraic_r x, bid128_fn op128);
+    static algebraic_p  to_angle(algebraic_r x);
+
+public:
+    OBJECT_DECL(hwdouble);
+    PARSE_DECL(hwdouble);
+    SIZE_DECL(hwdouble);
+    RENDER_DECL(hwdouble);
+};
+
+#endif // HWDOUBLE_H
@@ -0,0 +1,263 @@
+// ****************************************************************************
+//  integrate.cc                                                  DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Numerical integration
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "integrate.h"
+
+#include "compiled.h"
+#include "program.h"
+#include "recorder.h"
+#include "settings.h"
+
+#include <cstring>
+
+
+RECORDER(integrate, 16, "Numerical integration");
+
+
+// Maximum number of pending intervals, which bounds the subdivision depth
+static const uint INTEGRATE_MAX_INTERVALS = 48;
+
+
+struct interval
+// ----------------------------------------------------------------------------
+//   An interval pending subdivision, stored in the scratchpad
+// ----------------------------------------------------------------------------
+{
+    bid128      low;
+    bid128      high;
+    bid128      value;
+    bid128      error;
+};
+
+
+// Kronrod nodes, with Gauss nodes at odd indices, and the center last
+static cstring kronrod_nodes[8] =
+{
+    "0.991455371120812639206854697526329",
+    "0.949107912342758524526189684047851",
+    "0.864864423359769072789712788640926",
+    "0.741531185599394439863864773280788",
+    "0.586087235467691130294144845693013",
+    "0.405845151377397166906606412076961",
+    "0.207784955007898467600689403773245",
+    "0",
+};
+
+// Weights for the 15-points Kronrod rule
+static cstring kronrod_weights[8] =
+{
+    "0.022935322010529224963732008058970",
+    "0.063092092629978553290700663189204",
+    "0.104790010322250183839876322541518",
+    "0.140653259715525918745189590510238",
+    "0.169004726639267902826583426598550",
+    "0.190350578064785409913256402421014",
+    "0.204432940075298892414161999234649",
+    "0.209482141084727828012999174891714",
+};
+
+// Weights for the embedded 7-points Gauss rule
+static cstring gauss_weights[4] =
+{
+    "0.129484966168869693270611432679082",
+    "0.279705391489276667901467771423780",
+    "0.381830050505118944950369775488975",
+    "0.417959183673469387755102040816327",
+};
+
+
+static bool kronrod(const compiled &fn, interval &iv)
+// ----------------------------------------------------------------------------
+//   Compute the Gauss-Kronrod estimate and error for an interval
+// ----------------------------------------------------------------------------
+{
+    static bool   init = false;
+    static bid128 xk[8], wk[8], wg[4];
+    if (!init)
+    {
+        for (uint i = 0; i < 8; i++)
+        {
+            bid128_from_string(&xk[i].value, (char *) kronrod_nodes[i]);
+            bid128_from_string(&wk[i].value, (char *) kronrod_weights[i]);
+        }
+        for (uint i = 0; i < 4; i++)
+            bid128_from_string(&wg[i].value, (char *) gauss_weights[i]);
+        init = true;
+    }
+
+    bid128 half   = compiled::integer(1) / compiled::integer(2);
+    bid128 center = (iv.low + iv.high) * half;
+    bid128 radius = (iv.high - iv.low) * half;
+
+    bid128 fc;
+    if (!fn.evaluate(center, fc))
+        return false;
+    bid128 rk = fc * wk[7];
+    bid128 rg = fc * wg[3];
+
+    for (uint j = 0; j < 7; j++)
+    {
+        bid128 dx = radius * xk[j];
+        bid128 f1, f2;
+        if (!fn.evaluate(center - dx, f1) || !fn.evaluate(center + dx, f2))
+            return false;
+        bid128 sum = f1 + f2;
+        rk = rk + wk[j] * sum;
+        if (j & 1)
+            rg = rg + wg[j / 2] * sum;
+    }
+
+    iv.value = rk * radius;
+    iv.error = compiled::abs((rk - rg) * radius);
+    return true;
+}
+
+
+bool integrate(const object_g &expr, symbol_r name,
+               bid128 low, bid128 high, bid128 &result)
+// ----------------------------------------------------------------------------
+//   Adaptive Gauss-Kronrod integration
+// ----------------------------------------------------------------------------
+{
+    compiled fn;
+    if (!fn.prepare(expr, name))
+        return false;
+
+    // The tolerance is tied to the number of displayed digits
+    uint digits = Settings.displayed;
+    if (digits > Settings.precision)
+        digits = Settings.precision;
+    if (digits > BID128_MAXDIGITS)
+        digits = BID128_MAXDIGITS;
+    bid128 eps  = compiled::epsilon(digits);
+    bid128 zero = compiled::integer(0);
+    bid128 half = compiled::integer(1) / compiled::integer(2);
+
+    interval iv = { low, high, zero, zero };
+    if (!kronrod(fn, iv))
+        return false;
+
+    bid128 width = high - low;
+    if (width == zero)
+    {
+        result = zero;
+        return true;
+    }
+    bid128 tolerance = eps * compiled::abs(iv.value);
+    if (tolerance == zero)
+        tolerance = eps;
+
+    // Pending intervals are kept in the scratchpad, which may move during GC
+    scribble scr;
+    uint     count = 0;
+    uint     evaluations = 15;
+    bid128   total = zero;
+    if (!rt.allocate(sizeof(interval)))
+        return false;
+    memcpy(scr.scratch(), &iv, sizeof(iv));
+    count++;
+
+    while (count)
+    {
+        if (program::interrupted())
+        {
+            rt.interrupted_error();
+            return false;
+        }
+
+        count--;
+        memcpy(&iv, scr.scratch() + count * sizeof(iv), sizeof(iv));
+        rt.free(sizeof(iv));
+
+        // Accept the interval if it is precise enough or cannot be split
+        bid128 local = tolerance * compiled::abs((iv.high - iv.low) / width);
+        if (!(local < iv.error) || count + 2 > INTEGRATE_MAX_INTERVALS)
+        {
+            total = total + iv.value;
+            continue;
+        }
+
+        bid128 mid = (iv.low + iv.high) * half;
+        interval left  = { iv.low, mid, zero, zero };
+        interval right = { mid, iv.high, zero, zero };
+        if (!kronrod(fn, left) || !kronrod(fn, right))
+            return false;
+        evaluations += 30;
+
+        // Push right first so that the left interval is processed first
+        if (!rt.allocate(2 * sizeof(interval)))
+            return false;
+        byte *top = scr.scratch() + count * sizeof(interval);
+        memcpy(top, &right, sizeof(right));
+        memcpy(top + sizeof(right), &left, sizeof(left));
+        count += 2;
+    }
+
+    record(integrate, "Integrated with %u evaluations, compiled=%d",
+           evaluations, fn.is_compiled());
+    result = total;
+    return true;
+}
+
+
+COMMAND_BODY(Integrate)
+// ----------------------------------------------------------------------------
+//   Numerical integration: Low High 'Expr' 'Name' ▶ Integral
+// ----------------------------------------------------------------------------
+{
+    object_g low  = rt.stack(3);
+    object_g high = rt.stack(2);
+    object_g expr = rt.stack(1);
+    object_g name = rt.stack(0);
+    if (!low || !high || !expr || !name)
+        return ERROR;
+
+    symbol_g var = name->as_quoted<symbol>();
+    if (!var)
+    {
+        rt.type_error();
+        return ERROR;
+    }
+
+    bid128 lowv, highv;
+    if (!compiled::to_bid128(low, lowv) || !compiled::to_bid128(high, highv))
+    {
+        rt.type_error();
+        return ERROR;
+    }
+
+    bid128 integral;
+    if (!integrate(expr, var, lowv, highv, integral))
+        return ERROR;
+
+    algebraic_g value = compiled::to_real(integral);
+    if (!value || !rt.drop(3) || !rt.top(value.Safe()))
+        return ERROR;
+    return OK;
+}
@@ -0,0 +1,53 @@
+#ifndef INTEGRATE_H
+#define INTEGRATE_H
+// ****************************************************************************
+//  integrate.h                                                   DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Numerical integration
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+//
+//   Integration uses an adaptive 7/15 points Gauss-Kronrod rule.
+//   On each interval, the difference between the 15-points Kronrod estimate
+//   and the embedded 7-points Gauss estimate gives an error estimate.
+//   Intervals where the error is too large are split in two, using a stack
+//   of pending intervals kept in the scratchpad.
+//
+//   The integrand is evaluated through a compiled program, so that samples
+//   are computed in bid128 registers without allocating objects.
+
+#include "algebraic.h"
+#include "command.h"
+#include "symbol.h"
+#include "types.h"
+
+
+// Integrate the expression for the given variable between two bounds
+bool integrate(const object_g &expr, symbol_r name,
+               bid128 low, bid128 high, bid128 &result);
+
+COMMAND_DECLARE(Integrate);
+
+#endif // INTEGRATE_H
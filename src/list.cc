@@ -316,13 +316,39 @@ intptr_t list::list_render(renderer &r, unicode open, unicode close) const
 //   Render the list into the given buffer
 // ----------------------------------------------------------------------------
 {
+    // When only rendering the tail, skip items that cannot be visible
+    size_t skip = 0;
+    if (r.tail())
+    {
+        size_t count = 0;
+        for (object_p obj UNUSED : *this)
+            count++;
+        size_t keep = r.budget() / 2;
+        if (count > keep)
+            skip = count - keep;
+    }
+
     // Write the header, e.g. "{ "
-    if (open)
+    if (skip)
+        open = 1;
+    else if (open)
         r.put(open);
 
     // Loop on all objects inside the list
     for (object_p obj : *this)
     {
+        // Skip items before the tail, stop once the head is full
+        if (skip)
+        {
+            skip--;
+            continue;
+        }
+        if (r.full())
+        {
+            r.truncate();
+            return r.size();
+        }
+
         // Add space separator (except on first object when no separator)
         if (open)
             r.put(' ');
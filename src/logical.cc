@@ -57,6 +57,8 @@ object::result logical::evaluate(binary_fn native, big_binary_fn big)
     case ID_decimal128:
     case ID_decimal64:
     case ID_decimal32:
+    case ID_big_decimal:
+    case ID_hwdouble:
     {
         // Logical truth
         int xv = x->as_truth();
@@ -159,6 +161,8 @@ object::result logical::evaluate(unary_fn native, big_unary_fn big)
     case ID_decimal128:
     case ID_decimal64:
     case ID_decimal32:
+    case ID_big_decimal:
+    case ID_hwdouble:
     {
         int xv = x->as_truth();
         if (xv < 0)
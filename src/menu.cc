@@ -337,7 +337,7 @@ MENU(VectorMenu,
 //   Operations on vectors
 // ----------------------------------------------------------------------------
      "Norm",    ID_abs,
-     "Dot",     ID_Unimplemented,
+     "Dot",     ID_dot,
      "Cross",   ID_Unimplemented,
      "→Vec2",   ID_Unimplemented,
      "→Vec3",   ID_Unimplemented,
@@ -550,8 +550,8 @@ MENU(SymbolicMenu,
      "↑Match",  ID_Unimplemented,
      "↓Match",  ID_Unimplemented,
 
-     "∂",       ID_Unimplemented,
-     "∫",       ID_Unimplemented,
+     "∂",       ID_Derivative,
+     "∫",       ID_Integrate,
      "∑",       ID_Unimplemented,
      "∏",       ID_Unimplemented,
      "∆",       ID_Unimplemented,
@@ -817,7 +817,7 @@ MENU(SolverMenu,
 
      "Eq",      ID_Unimplemented,
      "Indep",   ID_Unimplemented,
-     "Root",    ID_Unimplemented,
+     "Root",    ID_Root,
      "MultiR",  ID_Unimplemented,
      "PolyR",   ID_Unimplemented,
 
@@ -830,7 +830,7 @@ MENU(NumericalSolverMenu,
 // ----------------------------------------------------------------------------
      "Eq",      ID_Unimplemented,
      "Indep",   ID_Unimplemented,
-     "Root",    ID_Unimplemented,
+     "Root",    ID_Root,
 
      ID_SolverMenu);
 
@@ -927,8 +927,10 @@ MENU(PlotMenu,
 // ----------------------------------------------------------------------------
 //   Plot and drawing menu
 // ----------------------------------------------------------------------------
-     "Plot",    ID_Unimplemented,
-     "Clear",   ID_Unimplemented,
+     "Plot",    ID_FunctionPlot,
+     "Polar",   ID_PolarPlot,
+     "Param",   ID_ParametricPlot,
+     "Clear",   ID_cllcd,
      "Axes",    ID_Unimplemented,
      "Auto",    ID_Unimplemented);
 
@@ -1018,6 +1020,8 @@ MENU(ModesMenu,
      "KeepAll", ID_NoAutoSimplify,
      MaxBigNumBits::menu_label, ID_MaxBigNumBits,
      MaxRewrites::menu_label, ID_MaxRewrites,
+     "HW FP",   ID_HardwareFloatingPoint,
+     "Dec FP",  ID_SoftwareFloatingPoint,
 
      ID_Modes);
 
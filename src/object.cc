@@ -32,11 +32,13 @@
 #include "algebraic.h"
 #include "arithmetic.h"
 #include "array.h"
+#include "big_decimal.h"
 #include "bignum.h"
 #include "catalog.h"
 #include "compare.h"
 #include "complex.h"
 #include "conditionals.h"
+#include "dag.h"
 #include "decimal-32.h"
 #include "decimal-64.h"
 #include "decimal128.h"
@@ -45,6 +47,8 @@
 #include "fraction.h"
 #include "functions.h"
 #include "graphics.h"
+#include "hwdouble.h"
+#include "integrate.h"
 #include "integer.h"
 #include "list.h"
 #include "locals.h"
@@ -52,10 +56,13 @@
 #include "loops.h"
 #include "menu.h"
 #include "parser.h"
+#include "plot.h"
+#include "polynomial.h"
 #include "program.h"
 #include "renderer.h"
 #include "runtime.h"
 #include "settings.h"
+#include "solve.h"
 #include "stack-cmds.h"
 #include "symbol.h"
 #include "text.h"
@@ -271,6 +278,19 @@ uint32_t object::as_uint32(uint32_t def, bool err) const
         bid128_to_uint32_int(&result, &v.value);
         return result;
     }
+    case ID_big_decimal:
+        if (object_p d = big_decimal_p(this)->to_decimal128())
+            return d->as_uint32(def, err);
+        return def;
+    case ID_hwdouble:
+    {
+        double v = hwdouble_p(this)->value();
+        if (v >= 0.0 && v < 4294967296.0)
+            return uint32_t(v);
+        if (err)
+            rt.value_error();
+        return def;
+    }
     case ID_decimal64:
     {
         uint result = def;
@@ -312,6 +332,19 @@ int32_t object::as_int32 (int32_t  def, bool err)  const
         bid128_to_int32_int(&result, &v.value);
         return result;
     }
+    case ID_big_decimal:
+        if (object_p d = big_decimal_p(this)->to_decimal128())
+            return d->as_int32(def, err);
+        return def;
+    case ID_hwdouble:
+    {
+        double v = hwdouble_p(this)->value();
+        if (v > -2147483649.0 && v < 2147483648.0)
+            return int32_t(v);
+        if (err)
+            rt.value_error();
+        return def;
+    }
     case ID_decimal64:
     {
         int result = def;
@@ -510,6 +543,8 @@ int object::as_truth(bool error) const
     case ID_neg_fraction:
     case ID_big_fraction:
     case ID_neg_big_fraction:
+    case ID_hwdouble:
+    case ID_big_decimal:
     case ID_decimal128:
     case ID_decimal64:
     case ID_decimal32:
@@ -562,6 +597,10 @@ bool object::is_zero(bool error) const
     case ID_big_fraction:
     case ID_neg_big_fraction:
         return big_fraction_p(this)->numerator()->is_zero();
+    case ID_hwdouble:
+        return hwdouble_p(this)->is_zero();
+    case ID_big_decimal:
+        return big_decimal_p(this)->is_zero();
     case ID_decimal128:
         return decimal128_p(this)->is_zero();
     case ID_decimal64:
@@ -608,6 +647,10 @@ bool object::is_one(bool error) const
         return bignum_p(this)->is_one();
     case ID_fraction:
         return fraction_p(this)->is_one();
+    case ID_hwdouble:
+        return hwdouble_p(this)->is_one();
+    case ID_big_decimal:
+        return big_decimal_p(this)->is_one();
     case ID_decimal128:
         return decimal128_p(this)->is_one();
     case ID_decimal64:
@@ -662,6 +705,10 @@ bool object::is_negative(bool error) const
     case ID_neg_fraction:
     case ID_neg_big_fraction:
         return !fraction_p(this)->is_zero();
+    case ID_hwdouble:
+        return hwdouble_p(this)->is_negative();
+    case ID_big_decimal:
+        return big_decimal_p(this)->is_negative();
     case ID_decimal128:
         return decimal128_p(this)->is_negative();
     case ID_decimal64:
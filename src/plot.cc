@@ -0,0 +1,428 @@
+// ****************************************************************************
+//  plot.cc                                                       DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Function, polar and parametric plots
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "plot.h"
+
+#include "blitter.h"
+#include "compiled.h"
+#include "functions.h"
+#include "list.h"
+#include "program.h"
+#include "recorder.h"
+#include "settings.h"
+#include "symbol.h"
+#include "sysmenu.h"
+#include "target.h"
+#include "user_interface.h"
+
+
+RECORDER(plot, 16, "Plotting functions");
+
+
+enum plot_kind
+// ----------------------------------------------------------------------------
+//   The kinds of plot we know how to draw
+// ----------------------------------------------------------------------------
+{
+    PLOT_FUNCTION,              // y = f(x)
+    PLOT_POLAR,                 // r = f(θ)
+    PLOT_PARAMETRIC,            // x = f(t), y = g(t)
+};
+
+
+enum plot_limits
+// ----------------------------------------------------------------------------
+//   Parameters for plotting
+// ----------------------------------------------------------------------------
+{
+    PLOT_XMIN           = -10,  // Default horizontal range
+    PLOT_XMAX           = 10,
+    PLOT_YMIN           = -6,   // Default vertical range
+    PLOT_YMAX           = 6,
+    PLOT_STEPS          = 128,  // Initial steps for polar and parametric
+    PLOT_MAX_SEGMENT    = 4,    // Split segments longer than this in pixels
+    PLOT_MAX_DEPTH      = 5,    // Maximum number of splits for a segment
+    PLOT_REFRESH        = 8,    // Steps between two screen refreshes
+    PLOT_LIMIT          = 4 * LCD_W, // Clamp coordinates far off screen
+};
+
+
+struct plotter
+// ----------------------------------------------------------------------------
+//   Sample and draw an equation
+// ----------------------------------------------------------------------------
+{
+    plotter(plot_kind kind): kind(kind), drawn(0), undefined(0) {}
+
+    bool        prepare(const object_g &expr, const object_g &indep);
+    bool        draw();
+
+protected:
+    bool        sample(bid128 t, point &p);
+    void        segment(bid128 t0, point p0, bool ok0,
+                        bid128 t1, point p1, bool ok1, uint depth);
+    void        line(point p0, point p1);
+    static coord pixel(bid128 v);
+
+protected:
+    plot_kind   kind;
+    compiled    fx, fy;
+    bid128      tmin, tmax;
+    bid128      xmin, ymax;
+    bid128      xscale, yscale;
+    uint        drawn;
+    uint        undefined;
+};
+
+
+bool plotter::prepare(const object_g &expr, const object_g &indep)
+// ----------------------------------------------------------------------------
+//   Prepare the equations and ranges from the stack arguments
+// ----------------------------------------------------------------------------
+//   The independent variable is either a name or a list { Name Low High }
+{
+    symbol_g name;
+    bool     range = false;
+    if (list_g spec = indep->as<list>())
+    {
+        object_p first = spec->at(0);
+        name = first ? first->as_quoted<symbol>() : nullptr;
+        range = true;
+        if (!name || spec->at(3) ||
+            !compiled::to_bid128(spec->at(1), tmin) ||
+            !compiled::to_bid128(spec->at(2), tmax))
+        {
+            rt.value_error();
+            return false;
+        }
+    }
+    else
+    {
+        name = indep->as_quoted<symbol>();
+    }
+    if (!name)
+    {
+        rt.type_error();
+        return false;
+    }
+
+    // Parametric plots take a list { X(t) Y(t) }
+    if (kind == PLOT_PARAMETRIC)
+    {
+        list_g   both = expr->as<list>();
+        object_g x    = both ? both->at(0) : nullptr;
+        object_g y    = both ? both->at(1) : nullptr;
+        if (!x || !y || both->at(2))
+        {
+            rt.type_error();
+            return false;
+        }
+        if (!fx.prepare(x, name) || !fy.prepare(y, name))
+            return false;
+    }
+    else if (!fx.prepare(expr, name))
+    {
+        return false;
+    }
+
+    // Window on screen
+    xmin = compiled::integer(PLOT_XMIN);
+    ymax = compiled::integer(PLOT_YMAX);
+    bid128 xmax = compiled::integer(PLOT_XMAX);
+    bid128 ymin = compiled::integer(PLOT_YMIN);
+
+    // Default range for the independent variable
+    if (kind == PLOT_FUNCTION)
+    {
+        if (range)
+        {
+            xmin = tmin;
+            xmax = tmax;
+        }
+        else
+        {
+            tmin = xmin;
+            tmax = xmax;
+        }
+    }
+    else if (!range)
+    {
+        // A full turn in the current angle mode
+        tmin = compiled::integer(0);
+        switch(Settings.angle_mode)
+        {
+        case settings::DEGREES:         tmax = compiled::integer(360); break;
+        case settings::GRADS:           tmax = compiled::integer(400); break;
+        case settings::PI_RADIANS:      tmax = compiled::integer(2); break;
+        default:
+        {
+            algebraic_g pi = algebraic::pi();
+            if (!compiled::to_bid128(pi.Safe(), tmax))
+                return false;
+            tmax = tmax * compiled::integer(2);
+            break;
+        }
+        }
+    }
+
+    if (xmin == xmax)
+    {
+        rt.value_error();
+        return false;
+    }
+    xscale = compiled::integer(LCD_W - 1) / (xmax - xmin);
+    yscale = compiled::integer(LCD_H - 1) / (ymax - ymin);
+    return true;
+}
+
+
+coord plotter::pixel(bid128 v)
+// ----------------------------------------------------------------------------
+//   Convert a value to pixel coordinates, clamping values far off-screen
+// ----------------------------------------------------------------------------
+{
+    bid128 limit = compiled::integer(PLOT_LIMIT);
+    if (limit < v)
+        return PLOT_LIMIT;
+    if (v < -limit)
+        return -PLOT_LIMIT;
+    int result = 0;
+    bid128_to_int32_int(&result, &v.value);
+    return result;
+}
+
+
+bool plotter::sample(bid128 t, point &p)
+// ----------------------------------------------------------------------------
+//   Compute the point on screen for a value of the independent variable
+// ----------------------------------------------------------------------------
+//   Returns false where the function is not defined, e.g. sqrt(-1).
+//   Other errors, e.g. running out of memory, are left set to stop the plot
+{
+    bid128 x, y;
+    bool   ok = true;
+    switch(kind)
+    {
+    case PLOT_FUNCTION:
+        x = t;
+        ok = fx.evaluate(t, y);
+        break;
+
+    case PLOT_POLAR:
+    {
+        bid128 r;
+        ok = fx.evaluate(t, r);
+        if (ok)
+        {
+            bid128 a = t, c, s;
+            function::adjust_from_angle(a);
+            bid128_cos(&c.value, &a.value);
+            bid128_sin(&s.value, &a.value);
+            x = r * c;
+            y = r * s;
+        }
+        break;
+    }
+
+    case PLOT_PARAMETRIC:
+        ok = fx.evaluate(t, x) && fy.evaluate(t, y);
+        break;
+    }
+
+    if (!ok)
+    {
+        if (rt.is_domain_error() || rt.is_zero_divide_error())
+        {
+            rt.clear_error();
+            undefined++;
+        }
+        return false;
+    }
+    p.x = pixel((x - xmin) * xscale);
+    p.y = pixel((ymax - y) * yscale);
+    return true;
+}
+
+
+void plotter::line(point p0, point p1)
+// ----------------------------------------------------------------------------
+//   Draw a segment on screen and mark it as dirty
+// ----------------------------------------------------------------------------
+{
+    coord x1 = p0.x < p1.x ? p0.x : p1.x;
+    coord x2 = p0.x < p1.x ? p1.x : p0.x;
+    coord y1 = p0.y < p1.y ? p0.y : p1.y;
+    coord y2 = p0.y < p1.y ? p1.y : p0.y;
+    if (x2 < 0 || x1 >= LCD_W || y2 < 0 || y1 >= LCD_H)
+        return;
+
+    x1 = x1 < 0 ? 0 : x1;
+    y1 = y1 < 0 ? 0 : y1;
+    x2 = x2 >= LCD_W ? LCD_W - 1 : x2;
+    y2 = y2 >= LCD_H ? LCD_H - 1 : y2;
+    Screen.line(p0.x, p0.y, p1.x, p1.y, pattern::black);
+    ui.draw_dirty(x1, y1, x2, y2);
+    drawn++;
+}
+
+
+void plotter::segment(bid128 t0, point p0, bool ok0,
+                      bid128 t1, point p1, bool ok1, uint depth)
+// ----------------------------------------------------------------------------
+//   Draw a segment, splitting it where it spans too many pixels
+// ----------------------------------------------------------------------------
+{
+    if (ok0 && ok1)
+    {
+        coord dx = p1.x - p0.x;
+        coord dy = p1.y - p0.y;
+        if (dx < 0)
+            dx = -dx;
+        if (dy < 0)
+            dy = -dy;
+        if ((dx <= PLOT_MAX_SEGMENT && dy <= PLOT_MAX_SEGMENT) ||
+            depth >= PLOT_MAX_DEPTH)
+        {
+            line(p0, p1);
+            return;
+        }
+    }
+    else if ((!ok0 && !ok1) || depth >= PLOT_MAX_DEPTH)
+    {
+        // Leave a gap where the function is not defined
+        return;
+    }
+
+    bid128 tm = (t0 + t1) / compiled::integer(2);
+    point  pm;
+    bool   okm = sample(tm, pm);
+    if (!okm && rt.error())
+        return;
+    segment(t0, p0, ok0, tm, pm, okm, depth + 1);
+    segment(tm, pm, okm, t1, p1, ok1, depth + 1);
+}
+
+
+bool plotter::draw()
+// ----------------------------------------------------------------------------
+//   Draw the axes and the plot, refreshing the screen as we progress
+// ----------------------------------------------------------------------------
+{
+    ui.draw_start(false);
+    ui.draw_user_screen();
+    Screen.fill(0, 0, LCD_W - 1, LCD_H - 1, pattern::white);
+
+    bid128 zero = compiled::integer(0);
+    coord  ox   = pixel((zero - xmin) * xscale);
+    coord  oy   = pixel(ymax * yscale);
+    if (ox >= 0 && ox < LCD_W)
+        Screen.fill(ox, 0, ox, LCD_H - 1, pattern::gray50);
+    if (oy >= 0 && oy < LCD_H)
+        Screen.fill(0, oy, LCD_W - 1, oy, pattern::gray50);
+    ui.draw_dirty(0, 0, LCD_W - 1, LCD_H - 1);
+    refresh_dirty();
+
+    // Function plots start with one sample every other column
+    uint   steps = kind == PLOT_FUNCTION ? LCD_W / 2 : PLOT_STEPS;
+    bid128 dt    = (tmax - tmin) / compiled::integer(steps);
+    bid128 t0    = tmin;
+    point  p0;
+    bool   ok0   = sample(t0, p0);
+    for (uint i = 1; i <= steps && !rt.error(); i++)
+    {
+        bid128 t1 = tmin + dt * compiled::integer(i);
+        point  p1;
+        bool   ok1 = sample(t1, p1);
+        segment(t0, p0, ok0, t1, p1, ok1, 0);
+        t0 = t1;
+        p0 = p1;
+        ok0 = ok1;
+
+        if (i % PLOT_REFRESH == 0)
+        {
+            refresh_dirty();
+            if (program::interrupted())
+            {
+                rt.interrupted_error();
+                return false;
+            }
+        }
+    }
+    refresh_dirty();
+
+    record(plot, "Drew %u segments, %u undefined samples, compiled=%d",
+           drawn, undefined, fx.is_compiled());
+    return !rt.error();
+}
+
+
+static object::result plot(plot_kind kind)
+// ----------------------------------------------------------------------------
+//   Shared code for all plot commands: 'Expr' Indep ▶
+// ----------------------------------------------------------------------------
+{
+    object_g expr  = rt.stack(1);
+    object_g indep = rt.stack(0);
+    if (!expr || !indep)
+        return object::ERROR;
+
+    plotter engine(kind);
+    if (!engine.prepare(expr, indep) || !engine.draw())
+        return object::ERROR;
+    if (!rt.drop(2))
+        return object::ERROR;
+    return object::OK;
+}
+
+
+COMMAND_BODY(FunctionPlot)
+// ----------------------------------------------------------------------------
+//   Plot a function y = f(x)
+// ----------------------------------------------------------------------------
+{
+    return plot(PLOT_FUNCTION);
+}
+
+
+COMMAND_BODY(PolarPlot)
+// ----------------------------------------------------------------------------
+//   Plot a polar curve r = f(θ)
+// ----------------------------------------------------------------------------
+{
+    return plot(PLOT_POLAR);
+}
+
+
+COMMAND_BODY(ParametricPlot)
+// ----------------------------------------------------------------------------
+//   Plot a parametric curve given as { x(t) y(t) }
+// ----------------------------------------------------------------------------
+{
+    return plot(PLOT_PARAMETRIC);
+}
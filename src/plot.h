@@ -0,0 +1,45 @@
+#ifndef PLOT_H
+#define PLOT_H
+// ****************************************************************************
+//  plot.h                                                        DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Function, polar and parametric plots
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+//
+//   Plots evaluate the equation through a compiled program. Sampling starts
+//   with a regular step, and segments that span too many pixels, e.g. near
+//   steep slopes, are recursively split in two. Segments are drawn as lines
+//   directly on screen, and the screen is refreshed every few steps, so that
+//   a slow plot shows progress and can be interrupted with the EXIT key.
+
+#include "command.h"
+
+
+COMMAND_DECLARE(FunctionPlot);
+COMMAND_DECLARE(PolarPlot);
+COMMAND_DECLARE(ParametricPlot);
+
+#endif // PLOT_H
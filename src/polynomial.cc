@@ -0,0 +1,590 @@
+// ****************************************************************************
+//  polynomial.cc                                                 DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Dense univariate polynomials with exact coefficients
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "polynomial.h"
+
+#include "arithmetic.h"
+#include "bignum.h"
+#include "integer.h"
+#include "recorder.h"
+
+
+RECORDER(polynomial, 16, "Polynomial operations");
+
+
+
+// ============================================================================
+//
+//    Object interface
+//
+// ============================================================================
+
+PARSE_BODY(polynomial)
+// ----------------------------------------------------------------------------
+//   Polynomials are built from equations, they are never parsed
+// ----------------------------------------------------------------------------
+{
+    return SKIP;
+}
+
+
+RENDER_BODY(polynomial)
+// ----------------------------------------------------------------------------
+//   Render a polynomial as the equivalent expression
+// ----------------------------------------------------------------------------
+{
+    algebraic_g expr = o->as_algebraic();
+    if (!expr)
+        return 0;
+    return expr->render(r);
+}
+
+
+
+// ============================================================================
+//
+//    Coefficients
+//
+// ============================================================================
+
+bool polynomial::is_exact(object_p obj)
+// ----------------------------------------------------------------------------
+//   Check if an object can be used as an exact coefficient
+// ----------------------------------------------------------------------------
+{
+    return obj->is_fractionable();
+}
+
+
+bool polynomial::is_zero(object_p obj)
+// ----------------------------------------------------------------------------
+//   Check if a coefficient is zero
+// ----------------------------------------------------------------------------
+{
+    switch(obj->type())
+    {
+    case ID_integer:
+    case ID_neg_integer:
+        return integer_p(obj)->is_zero();
+    case ID_bignum:
+    case ID_neg_bignum:
+        return bignum_p(obj)->is_zero();
+    default:
+        return false;
+    }
+}
+
+
+static bool coefficient_is_negative(object_p obj)
+// ----------------------------------------------------------------------------
+//   Check if a coefficient is negative
+// ----------------------------------------------------------------------------
+{
+    switch(obj->type())
+    {
+    case object::ID_neg_integer:
+    case object::ID_neg_bignum:
+    case object::ID_neg_fraction:
+    case object::ID_neg_big_fraction:
+        return true;
+    default:
+        return false;
+    }
+}
+
+
+symbol_p polynomial::variable() const
+// ----------------------------------------------------------------------------
+//   The variable is the first item in the polynomial
+// ----------------------------------------------------------------------------
+{
+    return symbol_p(at(0));
+}
+
+
+uint polynomial::degree() const
+// ----------------------------------------------------------------------------
+//   The degree is the number of coefficients minus one
+// ----------------------------------------------------------------------------
+{
+    return items() - 2;
+}
+
+
+bool polynomial::is_zero() const
+// ----------------------------------------------------------------------------
+//   Only the zero polynomial has a zero highest-degree coefficient
+// ----------------------------------------------------------------------------
+{
+    object_p last = at(1);
+    return !at(2) && last && is_zero(last);
+}
+
+
+polynomial_p polynomial::build(symbol_r var, uint count)
+// ----------------------------------------------------------------------------
+//   Build a polynomial from the coefficients on the stack, and drop them
+// ----------------------------------------------------------------------------
+//   The coefficient of degree 0 is the deepest on the stack
+{
+    // Strip zero coefficients of highest degree
+    while (count > 1 && is_zero(rt.stack(0)))
+    {
+        rt.drop();
+        count--;
+    }
+
+    polynomial_p result = nullptr;
+    {
+        scribble scr;
+        bool     ok = rt.append(var->size(), byte_p(var.Safe()));
+        for (uint level = count; ok && level-- > 0; )
+        {
+            object_p coef = rt.stack(level);
+            ok = coef && rt.append(coef->size(), byte_p(coef));
+        }
+        if (ok)
+            result = polynomial_p(list::make(ID_polynomial,
+                                             scr.scratch(), scr.growth()));
+    }
+    rt.drop(count);
+    return result;
+}
+
+
+polynomial_p polynomial::make(symbol_r var, algebraic_r constant)
+// ----------------------------------------------------------------------------
+//   Build a constant polynomial
+// ----------------------------------------------------------------------------
+{
+    if (!var.Safe() || !constant.Safe() || !rt.push(constant.Safe()))
+        return nullptr;
+    return build(var, 1);
+}
+
+
+
+// ============================================================================
+//
+//    Kernels
+//
+// ============================================================================
+
+polynomial_p polynomial::combine(polynomial_r x, polynomial_r y, bool sub)
+// ----------------------------------------------------------------------------
+//   Add or subtract two polynomials
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe() || !y.Safe())
+        return nullptr;
+    symbol_g var = x->variable();
+    if (!var->is_same_as(y->variable()))
+    {
+        rt.value_error();
+        return nullptr;
+    }
+
+    uint           dx = x->degree();
+    uint           dy = y->degree();
+    uint           n  = (dx > dy ? dx : dy) + 1;
+    algebraic_g    zero = integer::make(0);
+    list::iterator xi(x.Safe(), size_t(1));
+    list::iterator yi(y.Safe(), size_t(1));
+    for (uint k = 0; k < n; k++)
+    {
+        object_p    xo = *xi;
+        object_p    yo = *yi;
+        algebraic_g a  = xo ? algebraic_p(xo) : zero.Safe();
+        algebraic_g b  = yo ? algebraic_p(yo) : zero.Safe();
+        ++xi;
+        ++yi;
+        a = sub ? a - b : a + b;
+        if (!a || !rt.push(a.Safe()))
+        {
+            if (k)
+                rt.drop(k);
+            return nullptr;
+        }
+    }
+    return build(var, n);
+}
+
+
+polynomial_p polynomial::add(polynomial_r x, polynomial_r y)
+// ----------------------------------------------------------------------------
+//   Add two polynomials
+// ----------------------------------------------------------------------------
+{
+    return combine(x, y, false);
+}
+
+
+polynomial_p polynomial::sub(polynomial_r x, polynomial_r y)
+// ----------------------------------------------------------------------------
+//   Subtract two polynomials
+// ----------------------------------------------------------------------------
+{
+    return combine(x, y, true);
+}
+
+
+polynomial_p polynomial::neg(polynomial_r x)
+// ----------------------------------------------------------------------------
+//   Negate all coefficients
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe())
+        return nullptr;
+    symbol_g var = x->variable();
+    uint     n   = 0;
+    for (list::iterator xi(x.Safe(), size_t(1)); *xi; ++xi)
+    {
+        algebraic_g c = algebraic_p(*xi);
+        c = -c;
+        if (!c || !rt.push(c.Safe()))
+        {
+            if (n)
+                rt.drop(n);
+            return nullptr;
+        }
+        n++;
+    }
+    return build(var, n);
+}
+
+
+polynomial_p polynomial::mul(polynomial_r x, polynomial_r y)
+// ----------------------------------------------------------------------------
+//   Multiply two polynomials, accumulating products on the stack
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe() || !y.Safe())
+        return nullptr;
+    symbol_g var = x->variable();
+    if (!var->is_same_as(y->variable()))
+    {
+        rt.value_error();
+        return nullptr;
+    }
+
+    uint        n    = x->degree() + y->degree() + 1;
+    algebraic_g zero = integer::make(0);
+    for (uint k = 0; k < n; k++)
+    {
+        if (!rt.push(zero.Safe()))
+        {
+            if (k)
+                rt.drop(k);
+            return nullptr;
+        }
+    }
+
+    uint i = 0;
+    for (list::iterator xi(x.Safe(), size_t(1)); *xi; ++xi, ++i)
+    {
+        algebraic_g a = algebraic_p(*xi);
+        if (is_zero(a.Safe()))
+            continue;
+        uint j = 0;
+        for (list::iterator yi(y.Safe(), size_t(1)); *yi; ++yi, ++j)
+        {
+            algebraic_g b     = algebraic_p(*yi);
+            uint        level = n - 1 - (i + j);
+            algebraic_g acc   = algebraic_p(rt.stack(level));
+            acc = acc + a * b;
+            if (!acc || !rt.stack(level, acc.Safe()))
+            {
+                rt.drop(n);
+                return nullptr;
+            }
+        }
+    }
+    return build(var, n);
+}
+
+
+bool polynomial::divmod(polynomial_r x, polynomial_r y,
+                        polynomial_g &quotient, polynomial_g &remainder)
+// ----------------------------------------------------------------------------
+//   Euclidean division, exact since coefficients are rational
+// ----------------------------------------------------------------------------
+{
+    if (!x.Safe() || !y.Safe())
+        return false;
+    symbol_g var = x->variable();
+    if (!var->is_same_as(y->variable()))
+    {
+        rt.value_error();
+        return false;
+    }
+    if (y->is_zero())
+    {
+        rt.zero_divide_error();
+        return false;
+    }
+
+    uint        dx   = x->degree();
+    uint        dy   = y->degree();
+    algebraic_g zero = integer::make(0);
+    if (dx < dy)
+    {
+        quotient = make(var, zero);
+        remainder = x;
+        return quotient.Safe();
+    }
+
+    // Remainder coefficients first, then quotient coefficients
+    uint nr = dx + 1;
+    uint nq = dx - dy + 1;
+    if (!x->expand())
+        return false;
+    rt.roll(nr + 1);
+    rt.drop();
+    for (uint k = 0; k < nq; k++)
+    {
+        if (!rt.push(zero.Safe()))
+        {
+            rt.drop(nr + k);
+            return false;
+        }
+    }
+
+    algebraic_g lead = algebraic_p(y->at(dy + 1));
+    for (uint k = nq; k-- > 0; )
+    {
+        algebraic_g c = algebraic_p(rt.stack(nq + dx - (k + dy)));
+        c = c / lead;
+        if (!c || !rt.stack(nq - 1 - k, c.Safe()))
+        {
+            rt.drop(nr + nq);
+            return false;
+        }
+
+        uint j = 0;
+        for (list::iterator yi(y.Safe(), size_t(1)); *yi; ++yi, ++j)
+        {
+            algebraic_g b     = algebraic_p(*yi);
+            uint        level = nq + dx - (k + j);
+            algebraic_g r     = algebraic_p(rt.stack(level));
+            r = r - c * b;
+            if (!r || !rt.stack(level, r.Safe()))
+            {
+                rt.drop(nr + nq);
+                return false;
+            }
+        }
+    }
+
+    quotient = build(var, nq);
+    if (!quotient)
+    {
+        rt.drop(nr);
+        return false;
+    }
+    remainder = build(var, nr);
+    return remainder.Safe();
+}
+
+
+polynomial_p polynomial::power(polynomial_r x, polynomial_r n)
+// ----------------------------------------------------------------------------
+//   Raise a polynomial to a small positive integer power
+// ----------------------------------------------------------------------------
+//   Returns nullptr without an error if the result is not a polynomial
+{
+    if (!x.Safe() || !n.Safe() || n->degree())
+        return nullptr;
+    object_p exponent = n->at(1);
+    if (exponent->type() != ID_integer)
+        return nullptr;
+    uint count = integer_p(exponent)->value<uint>();
+    if (count > MAX_DEGREE || x->degree() * count > MAX_DEGREE)
+        return nullptr;
+
+    symbol_g     var    = x->variable();
+    polynomial_g result = make(var, integer::make(1));
+    polynomial_g square = x;
+    while (count && result && square)
+    {
+        if (count & 1)
+            result = mul(result, square);
+        count >>= 1;
+        if (count)
+            square = mul(square, square);
+    }
+    return result;
+}
+
+
+// ============================================================================
+//
+//    Conversion from and to equations
+//
+// ============================================================================
+
+polynomial_p polynomial::make(equation_r eq)
+// ----------------------------------------------------------------------------
+//   Build a polynomial from an equation, or return nullptr
+// ----------------------------------------------------------------------------
+//   This does not set an error if the equation is not a polynomial with
+//   exact coefficients in exactly one variable
+{
+    if (!eq.Safe())
+        return nullptr;
+
+    // Find the variable, and check that leaves are symbols or exact numbers
+    symbol_g var;
+    for (object_p obj : *eq)
+    {
+        if (obj->type() == ID_symbol)
+        {
+            if (!var)
+                var = symbol_p(obj);
+            else if (!var->is_same_as(obj))
+                return nullptr;
+        }
+        else if (!obj->arity() && !is_exact(obj))
+        {
+            return nullptr;
+        }
+    }
+    if (!var)
+        return nullptr;
+
+    // Evaluate the equation with polynomials on the stack
+    uint depth = rt.depth();
+    for (object_p obj : *eq)
+    {
+        id           ty = obj->type();
+        uint         arity = obj->arity();
+        polynomial_g p;
+        if (ty == ID_symbol)
+        {
+            algebraic_g zero = integer::make(0);
+            algebraic_g one  = integer::make(1);
+            if (zero && one && rt.push(zero.Safe()) && rt.push(one.Safe()))
+                p = build(var, 2);
+        }
+        else if (!arity)
+        {
+            p = make(var, algebraic_g(algebraic_p(obj)));
+        }
+        else if (arity <= 2 && rt.depth() >= depth + arity)
+        {
+            polynomial_g x = polynomial_p(rt.stack(arity - 1));
+            polynomial_g y = arity == 2 ? polynomial_p(rt.stack(0)) : nullptr;
+            polynomial_g q, r;
+            switch(ty)
+            {
+            case ID_add:        p = add(x, y);                  break;
+            case ID_sub:        p = sub(x, y);                  break;
+            case ID_mul:        p = mul(x, y);                  break;
+            case ID_neg:        p = neg(x);                     break;
+            case ID_sq:         p = mul(x, x);                  break;
+            case ID_cubed:      p = mul(x, x); p = mul(p, x);   break;
+            case ID_pow:        p = power(x, y);                break;
+            case ID_div:
+                // Exact divisions only, e.g. (X^2-1)/(X-1)
+                if (!y->is_zero() && divmod(x, y, q, r) && r->is_zero())
+                    p = q;
+                break;
+            default:
+                break;
+            }
+            if (p)
+                rt.drop(arity);
+        }
+        if (!p || rt.error() || !rt.push(p.Safe()))
+        {
+            record(polynomial, "Not a polynomial at %+s", object::name(ty));
+            if (rt.depth() > depth)
+                rt.drop(rt.depth() - depth);
+            return nullptr;
+        }
+    }
+
+    if (rt.depth() != depth + 1)
+    {
+        if (rt.depth() > depth)
+            rt.drop(rt.depth() - depth);
+        return nullptr;
+    }
+    record(polynomial, "Polynomial of degree %u", polynomial_p(rt.stack(0))
+           ->degree());
+    return polynomial_p(rt.pop());
+}
+
+
+algebraic_p polynomial::as_algebraic() const
+// ----------------------------------------------------------------------------
+//   Build a canonical expression, with terms in decreasing degree
+// ----------------------------------------------------------------------------
+{
+    size_t n = expand();
+    if (!n)
+        return nullptr;
+
+    // The variable is at level n-1, the coefficient of degree k at deg-k
+    uint        deg = n - 2;
+    algebraic_g x   = algebraic_p(rt.stack(n - 1));
+    algebraic_g result;
+    for (uint k = deg + 1; k-- > 0; )
+    {
+        algebraic_g c = algebraic_p(rt.stack(deg - k));
+        if (is_zero(c.Safe()))
+            continue;
+        bool negative = coefficient_is_negative(c.Safe());
+        if (negative)
+            c = -c;
+
+        algebraic_g term = c;
+        if (k)
+        {
+            algebraic_g power = x;
+            if (k > 1)
+            {
+                algebraic_g exponent = integer::make(k);
+                power = pow(x, exponent);
+            }
+            bool one = c->type() == ID_integer && integer_p(c.Safe())->is_one();
+            term = one ? power : c * power;
+        }
+
+        if (!result)
+            result = negative ? -term : term;
+        else
+            result = negative ? result - term : result + term;
+        if (!result)
+            break;
+    }
+    rt.drop(n);
+    if (!result && !rt.error())
+        result = integer::make(0);
+    return result;
+}
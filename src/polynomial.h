@@ -0,0 +1,96 @@
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+// ****************************************************************************
+//  polynomial.h                                                  DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//     Dense univariate polynomials with exact coefficients
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+//
+// Payload format:
+//
+//   A polynomial is a list containing:
+//   - The variable, a symbol
+//   - The coefficients, from degree 0 to the highest degree
+//
+//   Coefficients are exact numbers, i.e. integers, bignums or fractions, so
+//   that arithmetic on polynomials does not accumulate rounding errors.
+//   The highest degree coefficient is never zero, except for the zero
+//   polynomial, which has a single zero coefficient.
+//
+//   Kernels work on coefficients pushed on the RPL stack, which gives
+//   constant-time access to each coefficient and keeps them safe from GC.
+
+#include "algebraic.h"
+#include "equation.h"
+#include "list.h"
+#include "symbol.h"
+
+
+GCP(polynomial);
+
+struct polynomial : list
+// ----------------------------------------------------------------------------
+//   A univariate polynomial with exact coefficients
+// ----------------------------------------------------------------------------
+{
+    polynomial(gcbytes bytes, size_t len, id type = ID_polynomial)
+        : list(bytes, len, type) {}
+
+    enum { MAX_DEGREE = 128 };  // Largest degree we build from equations
+
+    // Conversion from and to equations
+    static polynomial_p make(equation_r eq);
+    static polynomial_p make(symbol_r var, algebraic_r constant);
+    algebraic_p         as_algebraic() const;
+
+    // Accessors
+    symbol_p            variable() const;
+    uint                degree() const;
+    bool                is_zero() const;
+
+    // Kernels
+    static polynomial_p add(polynomial_r x, polynomial_r y);
+    static polynomial_p sub(polynomial_r x, polynomial_r y);
+    static polynomial_p mul(polynomial_r x, polynomial_r y);
+    static polynomial_p neg(polynomial_r x);
+    static bool         divmod(polynomial_r x, polynomial_r y,
+                               polynomial_g &quotient,
+                               polynomial_g &remainder);
+
+protected:
+    static bool         is_exact(object_p obj);
+    static bool         is_zero(object_p obj);
+    static polynomial_p build(symbol_r var, uint count);
+    static polynomial_p combine(polynomial_r x, polynomial_r y, bool sub);
+    static polynomial_p power(polynomial_r x, polynomial_r n);
+
+public:
+    OBJECT_DECL(polynomial);
+    PARSE_DECL(polynomial);
+    RENDER_DECL(polynomial);
+};
+
+#endif // POLYNOMIAL_H
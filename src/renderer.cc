@@ -35,6 +35,7 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wctype.h>
 
 renderer::~renderer()
@@ -59,8 +60,11 @@ bool renderer::put(char c)
             put('+');
     }
 
-    if (written >= length)
+    if (written >= length && !tailing)
+    {
+        cut = true;
         return false;
+    }
 
 
     // Render flat for stack display: collect all spaces in one
@@ -95,6 +99,8 @@ bool renderer::put(char c)
             return false;
         *p = c;
         written++;
+        if (tailing && written >= 2 * length)
+            trim();
     }
     if (c == '\n')
     {
@@ -186,6 +192,11 @@ size_t renderer::printf(const char *format, ...)
         va_end(va);
 
         // Check if we can allocate enough for the output
+        if (written + size > length && !tailing)
+        {
+            cut = true;
+            return 0;
+        }
         byte *p = rt.allocate(size);
         if (!p)
             return 0;
@@ -204,6 +215,8 @@ size_t renderer::printf(const char *format, ...)
             va_end(va);
         }
         written += size;
+        if (tailing && written >= 2 * length)
+            trim();
         return size;
     }
 }
@@ -223,3 +236,21 @@ utf8 renderer::text() const
 #endif // SIMULATOR
     return (utf8) rt.scratchpad() - written;
 }
+
+
+void renderer::trim()
+// ----------------------------------------------------------------------------
+//   When only keeping the tail, drop the oldest part of the output
+// ----------------------------------------------------------------------------
+//   This is only called with twice the length written, so that the cost of
+//   moving data around remains proportional to the amount of output
+{
+    byte  *start = rt.scratchpad() - written;
+    size_t drop  = written - length;
+    while (drop < written && (start[drop] & 0xC0) == 0x80)
+        drop++;                 // Do not keep partial UTF-8 sequences
+    memmove(start, start + drop, written - drop);
+    rt.free(drop);
+    written -= drop;
+    cut = true;
+}
@@ -41,16 +41,19 @@ struct renderer
 //  Arguments to the RENDER command
 // ----------------------------------------------------------------------------
 {
-    renderer(char *buffer = nullptr, size_t length = ~0U, bool flat = false)
+    renderer(char *buffer = nullptr, size_t length = ~0U, bool flat = false,
+             bool tail = false)
         : target(buffer), length(length), written(0), saving(), tabs(0),
           edit(buffer == nullptr),
-          eq(false), flat(flat), space(false), sign(false) {}
+          eq(false), flat(flat), space(false), sign(false),
+          tailing(tail && !buffer), cut(false) {}
     renderer(bool equation, bool edit = false, bool flat = false)
         : target(nullptr), length(~0U), written(0), saving(), tabs(0),
-          edit(edit), eq(equation), flat(flat), space(false), sign(false) {}
+          edit(edit), eq(equation), flat(flat), space(false), sign(false),
+          tailing(false), cut(false) {}
     renderer(file *f): target(), length(~0U), written(0), saving(f), tabs(0),
                        edit(true), eq(false), flat(false),
-                       space(false), sign(false) {}
+                       space(false), sign(false), tailing(false), cut(false) {}
     ~renderer();
 
     bool put(char c);
@@ -87,6 +90,16 @@ struct renderer
     void   need_sign()                  { sign = true; }
     utf8   text() const;
 
+    // Bounded rendering, e.g. for objects wider than the screen
+    bool   tail() const                 { return tailing; }
+    bool   full() const                 { return !tailing && written>=length; }
+    bool   truncated() const            { return cut; }
+    void   truncate()                   { cut = true; }
+    size_t budget() const
+    {
+        return tailing ? length : written < length ? length - written : 0;
+    }
+
     size_t printf(const char *format, ...);
     void   indent(int i)
     {
@@ -114,6 +127,10 @@ protected:
     bool        flat  : 1;      // Flat (for stack rendering)
     bool        space : 1;      // Had a space
     bool        sign  : 1;      // Need to insert '+' if next char is not '-'
+    bool        tailing : 1;    // Only keep the last `length` bytes
+    bool        cut   : 1;      // Some output was dropped
+
+    void        trim();
 };
 
 #endif // RENDERER_H
@@ -30,7 +30,9 @@
 #include "runtime.h"
 
 #include "user_interface.h"
+#include "equation.h"
 #include "object.h"
+#include "stack.h"
 #include "variables.h"
 
 #include <cstring>
@@ -68,6 +70,8 @@ runtime::runtime(byte *mem, size_t size)
       Globals(),
       Temporaries(),
       Editing(),
+      Gap(),
+      GapOffset(),
       Scratch(),
       Stack(),
       Undos(),
@@ -103,6 +107,8 @@ void runtime::memory(byte *memory, size_t size)
     Globals = home->skip();                     // Globals after home
     Temporaries = Globals;                      // Area for temporaries
     Editing = 0;                                // No editor
+    Gap = 0;                                    // No gap in editor
+    GapOffset = 0;
     Scratch = 0;                                // No scratchpad
 
     record(runtime, "Memory %p-%p size %u (%uK)",
@@ -132,7 +138,7 @@ size_t runtime::available()
 //   Return the size available for temporaries
 // ----------------------------------------------------------------------------
 {
-    size_t aboveTemps = Editing + Scratch + redzone;
+    size_t aboveTemps = Editing + Gap + Scratch + redzone;
     return (byte *) Stack - (byte *) Temporaries - aboveTemps;
 }
 
@@ -146,6 +152,19 @@ size_t runtime::available(size_t size)
     {
         gc();
         size_t avail = available();
+        if (avail < size)
+        {
+            // Cached renderings and the editor gap are only kept while
+            // there is room for them
+            bool purged = stack::cache_purge();
+            if (gap_purge())
+                purged = true;
+            if (purged)
+            {
+                gc();
+                avail = available();
+            }
+        }
         if (avail < size)
             out_of_memory_error();
         return avail;
@@ -304,6 +323,9 @@ size_t runtime::gc()
 
     record(gc, "Garbage collection, available %u, range %p-%p",
            available(), first, last);
+
+    // Memoized results would keep their inputs and outputs alive
+    equation::memo_purge();
 #ifdef SIMULATOR
     if (!integrity_test(first, last, Stack, Returns))
     {
@@ -375,10 +397,10 @@ size_t runtime::gc()
     }
 
     // Move the command line and scratch buffer
-    if (Editing + Scratch)
+    if (Editing + Gap + Scratch)
     {
         object_p edit = Temporaries;
-        move(edit - recycled, edit, Editing + Scratch, true);
+        move(edit - recycled, edit, Editing + Gap + Scratch, true);
     }
 
     // Adjust Temporaries
@@ -495,6 +517,95 @@ void runtime::move_globals(object_p to, object_p from)
 //    Editor
 //
 // ============================================================================
+//
+//   The editor is a gap buffer: the text before the gap starts at
+//   Temporaries, the text after the gap ends where the scratchpad begins.
+//   Edits happen at the gap, so that typing or loading a file one character
+//   at a time does not move the rest of the editor and scratchpad for every
+//   character. The gap grows geometrically when memory allows.
+
+static const size_t EDITOR_GAP = 64;    // Minimum gap growth
+
+
+byte *runtime::editor(size_t contiguous)
+// ----------------------------------------------------------------------------
+//   Return the editor buffer, with the given size stored contiguously
+// ----------------------------------------------------------------------------
+{
+    if (contiguous > Editing)
+        contiguous = Editing;
+    if (Gap && GapOffset < contiguous)
+        gap_move(contiguous);
+    return (byte *) Temporaries;
+}
+
+
+void runtime::gap_move(size_t offset)
+// ----------------------------------------------------------------------------
+//   Move the editor gap to the given offset
+// ----------------------------------------------------------------------------
+//   This only moves the text between the old and new gap positions
+{
+    byte *ed = (byte *) Temporaries;
+    if (Gap)
+    {
+        if (offset < GapOffset)
+            memmove(ed + offset + Gap, ed + offset, GapOffset - offset);
+        else if (offset > GapOffset)
+            memmove(ed + GapOffset, ed + GapOffset + Gap, offset - GapOffset);
+    }
+    GapOffset = offset;
+}
+
+
+bool runtime::gap_grow(size_t size)
+// ----------------------------------------------------------------------------
+//   Make sure that the gap can hold the given size
+// ----------------------------------------------------------------------------
+{
+    while (Gap < size)
+    {
+        // Reserve extra room if we can do it without garbage collection
+        size_t need    = size - Gap;
+        size_t reserve = Editing / 4 > EDITOR_GAP ? Editing / 4 : EDITOR_GAP;
+        if (available() >= need + reserve)
+            need += reserve;
+
+        // Check memory, which may release the gap if memory is tight
+        size_t gap = Gap;
+        if (available(need) < need)
+            return false;
+        if (Gap != gap)
+            continue;
+
+        // Move text after the gap and the scratchpad up
+        byte *after = (byte *) Temporaries + GapOffset + Gap;
+        move(object_p(after + need), object_p(after),
+             Editing - GapOffset + Scratch, true);
+        Gap += need;
+        record(editor, "Gap grown by %u to %u at offset %u",
+               need, Gap, GapOffset);
+    }
+    return true;
+}
+
+
+bool runtime::gap_purge()
+// ----------------------------------------------------------------------------
+//   Release the editor gap, e.g. when running low on memory
+// ----------------------------------------------------------------------------
+{
+    if (!Gap)
+        return false;
+    record(editor, "Releasing gap of %u bytes", Gap);
+    gap_move(Editing);
+    byte *end = (byte *) Temporaries + Editing;
+    if (Scratch)
+        move(object_p(end), object_p(end + Gap), Scratch, true);
+    Gap = 0;
+    return true;
+}
+
 
 size_t runtime::insert(size_t offset, utf8 data, size_t len)
 // ----------------------------------------------------------------------------
@@ -506,13 +617,15 @@ size_t runtime::insert(size_t offset, utf8 data, size_t len)
            len, offset, data[0], available());
     if (offset <= Editing)
     {
-        if (available(len) >= len)
+        gcutf8 source = data;   // Growing the gap may move the data
+        if (gap_grow(len))
         {
-            size_t moved = Scratch + Editing - offset;
-            byte_p edr = (byte_p) editor() + offset;
-            move(object_p(edr + len), object_p(edr), moved);
-            memcpy(editor() + offset, data, len);
+            gap_move(offset);
+            memcpy((byte *) Temporaries + offset, source.Safe(), len);
+            GapOffset += len;
+            Gap -= len;
             Editing += len;
+            ui.editor_inserted(offset, len);
             return len;
         }
     }
@@ -538,10 +651,16 @@ void runtime::remove(size_t offset, size_t len)
     if (offset > end)
         offset = end;
     len = end - offset;
-    size_t moving = Scratch + Editing - end;
-    byte_p edr = (byte_p) editor() + offset;
-    move(object_p(edr), object_p(edr + len), moving);
+    ui.editor_removing(offset, len);
+
+    // Removed text joins the gap
+    gap_move(offset);
+    Gap += len;
     Editing -= len;
+
+    // An empty editor is a closed editor, which does not keep a gap
+    if (!Editing)
+        gap_purge();
 }
 
 
@@ -553,6 +672,9 @@ utf8 runtime::close_editor(bool convert)
 //   a string. After that, it is safe to allocate temporaries without
 //   overwriting the editor
 {
+    // Make the editor contiguous
+    gap_purge();
+
     // Compute the extra size we need for a string header
     size_t hdrsize = leb128size(object::ID_text) + leb128size(Editing + 1);
     if (available(hdrsize+1) < hdrsize+1)
@@ -598,6 +720,7 @@ size_t runtime::edit(utf8 buf, size_t len)
 {
     gcutf8 buffer = buf;        // Need to keep track of GC movements
 
+    gap_purge();
     if (available(len) < len)
     {
         record(editor, "Insufficent memory for %u bytes", len);
@@ -612,6 +735,7 @@ size_t runtime::edit(utf8 buf, size_t len)
 
     memcpy((byte *) Temporaries, (byte *) buffer, len);
     Editing = len;
+    GapOffset = len;
     return len;
 }
 
@@ -638,7 +762,7 @@ byte *runtime::allocate(size_t sz)
 {
     if (available(sz) >= sz)
     {
-        byte *scratch = editor() + Editing + Scratch;
+        byte *scratch = scratchpad();
         Scratch += sz;
         return scratch;
     }
@@ -671,7 +795,7 @@ object_p runtime::clone(object_p source)
         return nullptr;
     object_p result = Temporaries;
     Temporaries = object_p((byte *) Temporaries + size);
-    move(Temporaries, result, Editing + Scratch, true);
+    move(Temporaries, result, Editing + Gap + Scratch, true);
     memmove((void *) result, source, size);
     return result;
 }
@@ -925,6 +1049,47 @@ bool runtime::drop(uint count)
 }
 
 
+static void reverse(object_p *first, object_p *last)
+// ----------------------------------------------------------------------------
+//   Reverse a range of stack items
+// ----------------------------------------------------------------------------
+{
+    while (first < last)
+    {
+        object_p tmp = *first;
+        *first++ = *--last;
+        *last = tmp;
+    }
+}
+
+
+bool runtime::splice(uint level, uint removed, uint inserted)
+// ----------------------------------------------------------------------------
+//   Replace `removed` items at `level` with the `inserted` items on top
+// ----------------------------------------------------------------------------
+//   On entry, the stack contains the inserted items, then `level` items
+//   that are preserved, then the `removed` items.
+//   On exit, it contains the `level` items, then the inserted items.
+//   This does not allocate memory, so it can be used during rewrites.
+{
+    if (inserted + level + removed > depth())
+    {
+        missing_argument_error();
+        return false;
+    }
+
+    // Rotate inserted items below the preserved ones
+    reverse(Stack, Stack + inserted);
+    reverse(Stack + inserted, Stack + inserted + level);
+    reverse(Stack, Stack + inserted + level);
+
+    // Close the gap left by the removed items
+    memmove(Stack + removed, Stack, (inserted + level) * sizeof(*Stack));
+    Stack += removed;
+    return true;
+}
+
+
 
 // ============================================================================
 //
@@ -1051,6 +1216,9 @@ bool runtime::enter(directory_p dir)
     // Update directory
     *Directories = dir;
 
+    // Memoized rewrites may depend on variables in the current directory
+    equation::memo_purge();
+
     return true;
 }
 
@@ -1078,6 +1246,9 @@ bool runtime::updir(size_t count)
     for (size_t i = 0; i < moving; i++)
         *(--newp) = *(--oldp);
 
+    // Memoized rewrites may depend on variables in the current directory
+    equation::memo_purge();
+
     return true;
 }
 
@@ -1138,3 +1309,10 @@ runtime &runtime::name##_error()                \
     return error(msg);                          \
 }
 #include "errors.tbl"
+
+#define ERROR(name, msg)                        \
+bool runtime::is_##name##_error() const         \
+{                                               \
+    return Error && !strcmp(cstring(Error), msg); \
+}
+#include "errors.tbl"
@@ -59,7 +59,9 @@
 //      Scratch         Binary scratch pad (to assemble objects like lists)
 //        [Scratchpad allocated area]
 //      Editor          The text editor
-//        [Text editor contents]
+//        [Text editor contents after the gap]
+//        [Gap where the last edit happened]
+//        [Text editor contents before the gap]
 //      Temporaries     Temporaries, allocated up
 //        [Previously allocated temporary objects, can be garbage collected]
 //      Globals         End of global named RPL objects
@@ -190,14 +192,23 @@ struct runtime
     //
     // ========================================================================
 
-    byte *editor()
+    byte *editor(size_t contiguous = ~0U);
     // ------------------------------------------------------------------------
-    //   Return the buffer for the editor
+    //   Return the buffer for the editor, contiguous up to given size
     // ------------------------------------------------------------------------
-    //   This must be called each time a GC could have happened
+    //   This must be called each time a GC or edit could have happened
+    //   The editor is a gap buffer, with the gap where the last edit was.
+    //   Asking for a contiguous editor moves the gap past the given size.
+
+
+    utf8 editor_at(size_t offset)
+    // ------------------------------------------------------------------------
+    //   Return a pointer to the given editor offset, skipping the gap
+    // ------------------------------------------------------------------------
+    //   This lets hot code read the editor without moving the gap
     {
         byte *ed = (byte *) Temporaries;
-        return ed;
+        return ed + offset + (offset < GapOffset ? 0 : Gap);
     }
 
 
@@ -233,6 +244,8 @@ struct runtime
     // ------------------------------------------------------------------------
     {
         Editing = 0;
+        Gap = 0;
+        GapOffset = 0;
     }
 
 
@@ -266,6 +279,27 @@ struct runtime
     // ------------------------------------------------------------------------
 
 
+    bool gap_purge();
+    // ------------------------------------------------------------------------
+    //   Release the editor gap, return true if this freed some memory
+    // ------------------------------------------------------------------------
+
+
+protected:
+    void gap_move(size_t offset);
+    // ------------------------------------------------------------------------
+    //   Move the editor gap to the given offset
+    // ------------------------------------------------------------------------
+
+
+    bool gap_grow(size_t size);
+    // ------------------------------------------------------------------------
+    //   Make sure the gap is large enough to insert the given size
+    // ------------------------------------------------------------------------
+
+public:
+
+
 
     // ========================================================================
     //
@@ -391,7 +425,7 @@ struct runtime
     // ------------------------------------------------------------------------
     //   This must be called each time a GC could have happened
     {
-        byte *scratch = (byte *) Temporaries + Editing + Scratch;
+        byte *scratch = (byte *) Temporaries + Editing + Gap + Scratch;
         return scratch;
     }
 
@@ -445,7 +479,7 @@ struct runtime
     //   Make a temporary from the scratchpad
     // ------------------------------------------------------------------------
     {
-        if (Editing == 0)
+        if (Editing + Gap == 0)
         {
             object_p result = Temporaries;
             Temporaries = (object_p) ((byte *) Temporaries + Scratch);
@@ -526,6 +560,11 @@ struct runtime
     //   Pop the top-level object from the stack, or return NULL
     // ------------------------------------------------------------------------
 
+    bool splice(uint level, uint removed, uint inserted);
+    // ------------------------------------------------------------------------
+    //   Replace stack items at level with the items pushed on top
+    // ------------------------------------------------------------------------
+
     uint depth()
     // ------------------------------------------------------------------------
     //   Return the stack depth
@@ -734,6 +773,9 @@ struct runtime
 #define ERROR(name, msg)        runtime &name##_error();
 #include "errors.tbl"
 
+#define ERROR(name, msg)        bool is_##name##_error() const;
+#include "errors.tbl"
+
 
 protected:
     utf8      Error;        // Error message if any
@@ -745,6 +787,8 @@ protected:
     object_p  Globals;      // End of global objects
     object_p  Temporaries;  // Temporaries (must be valid objects)
     size_t    Editing;      // Text editor (utf8 encoded)
+    size_t    Gap;          // Size of the gap in the text editor
+    size_t    GapOffset;    // Offset of the gap in the text editor
     size_t    Scratch;      // Scratch pad (may be invalid objects)
     object_p *Stack;        // Top of user stack
     object_p *Undos;        // Start of Undos area, end of stack
@@ -824,7 +868,7 @@ const Obj *runtime::make(typename Obj::id type, const Args &... args)
     Temporaries = (object *) ((byte *) Temporaries + size);
 
     // Move the editor up (available() checked we have room)
-    move(Temporaries, (object_p) result, Editing + Scratch, true);
+    move(Temporaries, (object_p) result, Editing + Gap + Scratch, true);
 
     // Initialize the object in place
     new(result) Obj(args..., type);
@@ -30,6 +30,7 @@
 #include "settings.h"
 
 #include "arithmetic.h"
+#include "big_decimal.h"
 #include "command.h"
 #include "font.h"
 #include "functions.h"
@@ -174,6 +175,11 @@ void settings::save(renderer &out, bool show_defaults)
     else if (show_defaults)
         out.put("AutoSimplify\n");
 
+    if (hardware_fp)
+        out.put("HardwareFloatingPoint\n");
+    else if (show_defaults)
+        out.put("SoftwareFloatingPoint\n");
+
     if (maxbignum != Defaults.maxbignum || show_defaults)
         out.printf("%u MaxBigNumBits\n", maxbignum);
     if (maxrewrites != Defaults.maxrewrites || show_defaults)
@@ -583,7 +589,7 @@ SETTINGS_COMMAND_BODY(Precision, 0)
 //   Setting the precision
 // ----------------------------------------------------------------------------
 {
-    uint prec = integer_arg(0, BID128_MAXDIGITS);
+    uint prec = integer_arg(0, BIG_DECIMAL_MAXDIGITS);
     if (!rt.error())
     {
         Settings.precision = prec;
@@ -935,6 +941,26 @@ SETTINGS_COMMAND_NOLABEL(NoAutoSimplify, !Settings.auto_simplify)
 }
 
 
+SETTINGS_COMMAND_NOLABEL(HardwareFloatingPoint, Settings.hardware_fp)
+// ----------------------------------------------------------------------------
+//   Compute with hardware floating-point when precision allows it
+// ----------------------------------------------------------------------------
+{
+    Settings.hardware_fp = true;
+    return OK;
+}
+
+
+SETTINGS_COMMAND_NOLABEL(SoftwareFloatingPoint, !Settings.hardware_fp)
+// ----------------------------------------------------------------------------
+//   Always compute with decimal floating-point
+// ----------------------------------------------------------------------------
+{
+    Settings.hardware_fp = false;
+    return OK;
+}
+
+
 SETTINGS_COMMAND_BODY(MaxBigNumBits, false)
 // ----------------------------------------------------------------------------
 //   Select maximum size for big numbers
@@ -0,0 +1,278 @@
+// ****************************************************************************
+//  solve.cc                                                      DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Numerical root finding
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+
+#include "solve.h"
+
+#include "compiled.h"
+#include "list.h"
+#include "program.h"
+#include "recorder.h"
+#include "settings.h"
+
+
+RECORDER(solve, 16, "Numerical root finding");
+
+
+// Number of attempts to bracket a root from the initial guesses
+static const uint SOLVE_MAX_EXPAND      = 60;
+
+// Maximum number of iterations of Brent's method
+static const uint SOLVE_MAX_ITERATIONS  = 400;
+
+
+bool solve(const object_g &eq, symbol_r name,
+           bid128 a, bid128 b, bid128 &root)
+// ----------------------------------------------------------------------------
+//   Find a root of the equation for the given variable
+// ----------------------------------------------------------------------------
+{
+    compiled fn;
+    if (!fn.prepare(eq, name))
+        return false;
+
+    // Tolerance is derived from the precision, which bid128 caps at 34 digits
+    uint   digits = Settings.precision;
+    if (digits > BID128_MAXDIGITS)
+        digits = BID128_MAXDIGITS;
+    bid128 eps    = compiled::epsilon(digits);
+    bid128 tiny   = compiled::epsilon(2 * digits);
+    bid128 zero   = compiled::integer(0);
+    bid128 one    = compiled::integer(1);
+    bid128 two    = compiled::integer(2);
+    bid128 three  = compiled::integer(3);
+    bid128 half   = one / two;
+
+    // With a single guess, start from a small interval around it
+    if (a == b)
+    {
+        bid128 step = compiled::abs(a) / compiled::integer(100);
+        if (step == zero)
+            step = one / compiled::integer(100);
+        b = a + step;
+    }
+
+    bid128 fa, fb;
+    if (!fn.evaluate(a, fa) || !fn.evaluate(b, fb))
+        return false;
+
+    // Expand the interval until the function changes sign
+    bid128 growth = compiled::integer(16) / compiled::integer(10);
+    for (uint i = 0; ; i++)
+    {
+        if (fa == zero)
+        {
+            root = a;
+            return true;
+        }
+        if (fb == zero)
+        {
+            root = b;
+            return true;
+        }
+        if (compiled::is_negative(fa) != compiled::is_negative(fb))
+            break;
+        if (i >= SOLVE_MAX_EXPAND)
+        {
+            rt.no_solution_error();
+            return false;
+        }
+        if (program::interrupted())
+        {
+            rt.interrupted_error();
+            return false;
+        }
+
+        // Move the end where the function is closest to zero further away
+        bid128 width = growth * (b - a);
+        if (compiled::abs(fa) < compiled::abs(fb))
+        {
+            a = a - width;
+            if (!fn.evaluate(a, fa))
+                return false;
+        }
+        else
+        {
+            b = b + width;
+            if (!fn.evaluate(b, fb))
+                return false;
+        }
+    }
+    record(solve, "Bracketed root, compiled=%d", fn.is_compiled());
+
+    // Brent's method
+    bid128 c = b, fc = fb;
+    bid128 d = b - a, e = d;
+    for (uint iter = 0; iter < SOLVE_MAX_ITERATIONS; iter++)
+    {
+        if (program::interrupted())
+        {
+            rt.interrupted_error();
+            return false;
+        }
+
+        // Keep the root between b and c, with b the best estimate
+        if (compiled::is_negative(fb) == compiled::is_negative(fc))
+        {
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (compiled::abs(fc) < compiled::abs(fb))
+        {
+            a = b;
+            b = c;
+            c = a;
+            fa = fb;
+            fb = fc;
+            fc = fa;
+        }
+
+        bid128 tol = two * eps * compiled::abs(b) + half * tiny;
+        bid128 xm  = half * (c - b);
+        if (!(tol < compiled::abs(xm)) || fb == zero)
+        {
+            record(solve, "Converged after %u iterations", iter);
+            root = b;
+            return true;
+        }
+
+        if (!(compiled::abs(e) < tol) &&
+            compiled::abs(fb) < compiled::abs(fa))
+        {
+            // Attempt inverse quadratic interpolation or a secant step
+            bid128 s = fb / fa;
+            bid128 p, q;
+            if (a == c)
+            {
+                p = two * xm * s;
+                q = one - s;
+            }
+            else
+            {
+                q = fa / fc;
+                bid128 r = fb / fc;
+                p = s * (two * xm * q * (q - r) - (b - a) * (r - one));
+                q = (q - one) * (r - one) * (s - one);
+            }
+            if (!compiled::is_negative(p))
+                q = -q;
+            p = compiled::abs(p);
+
+            // Accept interpolation only if it falls within the bounds
+            bid128 min1 = three * xm * q - compiled::abs(tol * q);
+            bid128 min2 = compiled::abs(e * q);
+            if (two * p < (min1 < min2 ? min1 : min2))
+            {
+                e = d;
+                d = p / q;
+            }
+            else
+            {
+                d = xm;
+                e = d;
+            }
+        }
+        else
+        {
+            // Bounds decreasing too slowly, use bisection
+            d = xm;
+            e = d;
+        }
+
+        a = b;
+        fa = fb;
+        if (tol < compiled::abs(d))
+            b = b + d;
+        else if (compiled::is_negative(xm))
+            b = b - tol;
+        else
+            b = b + tol;
+        if (!fn.evaluate(b, fb))
+            return false;
+    }
+
+    // Return the best estimate we have
+    record(solve, "No convergence after %u iterations", SOLVE_MAX_ITERATIONS);
+    root = b;
+    return true;
+}
+
+
+COMMAND_BODY(Root)
+// ----------------------------------------------------------------------------
+//   Numerical solver: 'Eq' 'Name' Guess ▶ Root
+// ----------------------------------------------------------------------------
+//   The guess can be a single value or a list with two values
+{
+    object_g eq    = rt.stack(2);
+    object_g name  = rt.stack(1);
+    object_g guess = rt.stack(0);
+    if (!eq || !name || !guess)
+        return ERROR;
+
+    symbol_g var = name->as_quoted<symbol>();
+    if (!var)
+    {
+        rt.type_error();
+        return ERROR;
+    }
+
+    bid128 low, high;
+    if (list_g bracket = guess->as<list>())
+    {
+        if (bracket->at(2) ||
+            !compiled::to_bid128(bracket->at(0), low) ||
+            !compiled::to_bid128(bracket->at(1), high))
+        {
+            rt.value_error();
+            return ERROR;
+        }
+    }
+    else if (compiled::to_bid128(guess, low))
+    {
+        high = low;
+    }
+    else
+    {
+        rt.type_error();
+        return ERROR;
+    }
+
+    bid128 root;
+    if (!solve(eq, var, low, high, root))
+        return ERROR;
+
+    // As on HP calculators, the root is also stored in the variable
+    algebraic_g value = compiled::to_real(root);
+    if (!value || !var->store(object_p(value.Safe())))
+        return ERROR;
+    if (!rt.drop(2) || !rt.top(value.Safe()))
+        return ERROR;
+    return OK;
+}
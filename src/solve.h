@@ -0,0 +1,50 @@
+#ifndef SOLVE_H
+#define SOLVE_H
+// ****************************************************************************
+//  solve.h                                                       DB48X project
+// ****************************************************************************
+//
+//   File Description:
+//
+//      Numerical root finding
+//
+//
+//
+//
+//
+//
+//
+//
+// ****************************************************************************
+//   (C) 2023 Christophe de Dinechin <christophe@dinechin.org>
+//   This software is licensed under the terms outlined in LICENSE.txt
+// ****************************************************************************
+//   This file is part of DB48X.
+//
+//   DB48X is free software: you can redistribute it and/or modify
+//   it under the terms outlined in the LICENSE.txt file
+//
+//   DB48X is distributed in the hope that it will be useful,
+//   but WITHOUT ANY WARRANTY; without even the implied warranty of
+//   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+// ****************************************************************************
+//
+//   The solver evaluates the equation through a compiled program, so that
+//   each iteration works on bid128 registers and does not allocate.
+//   It first looks for a sign change around the guess, then uses Brent's
+//   method, which combines inverse quadratic interpolation, secant steps
+//   and bisection to guarantee convergence once the root is bracketed.
+
+#include "algebraic.h"
+#include "command.h"
+#include "symbol.h"
+#include "types.h"
+
+
+// Find a root between two guesses, which are identical for a single guess
+bool solve(const object_g &eq, symbol_r name,
+           bid128 low, bid128 high, bid128 &root);
+
+COMMAND_DECLARE(Root);
+
+#endif // SOLVE_H
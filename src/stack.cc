@@ -34,6 +34,7 @@
 #include "runtime.h"
 #include "settings.h"
 #include "target.h"
+#include "text.h"
 #include "user_interface.h"
 
 #include <dmcp.h>
@@ -46,6 +47,7 @@ using size  = blitter::size;
 
 
 RECORDER(tests, 16, "Information about tests");
+RECORDER(stack_cache, 16, "Cache of rendered stack levels");
 
 stack::stack()
 // ----------------------------------------------------------------------------
@@ -70,6 +72,197 @@ static inline uint countDigits(uint value)
 }
 
 
+// ============================================================================
+//
+//    Cache of rendered stack levels
+//
+// ============================================================================
+//
+//    Most stack redraws only change level 1, e.g. after DROP, + or ENTER.
+//    Rendering the other levels again is costly for large objects, so we keep
+//    the rendered text for recently displayed objects, along with its width.
+//    Entries are keyed by object pointer: the cache holds GC-safe pointers,
+//    so an object cannot be recycled while cached and stays identified
+//    after GC moves it. A hash of the settings detects display changes.
+//    Directories are modified in place by STO and PURGE, which purge the
+//    cache, and the object size is checked as well in case of other changes.
+//    The cache is purged when memory runs low, see runtime::available().
+
+struct rendering
+// ----------------------------------------------------------------------------
+//   An entry in the stack rendering cache
+// ----------------------------------------------------------------------------
+{
+    object_g    object;         // Object that was rendered
+    size_t      osize;          // Size of the object when rendered
+    text_g      text;           // Rendered text (head and tail if truncated)
+    size_t      split;          // Start of the tail in text, 0 if complete
+    font_p      font;           // Font used to compute the width
+    uint32_t    settings;       // Hash of the settings when rendered
+    size        width;          // Width of the (tail of the) text in font
+    uint        used;           // Last time this entry was used
+};
+
+static const uint STACK_CACHE_ENTRIES = 16;
+static const uint STACK_RENDER_BUDGET = LCD_W;  // Bytes for head and tail
+static rendering  stack_cache[STACK_CACHE_ENTRIES];
+static uint       stack_cache_clock  = 0;
+static uint       stack_cache_hits   = 0;
+static uint       stack_cache_misses = 0;
+
+
+static uint32_t settings_hash()
+// ----------------------------------------------------------------------------
+//   Compute a FNV-1a hash of the settings, which may change rendering
+// ----------------------------------------------------------------------------
+{
+    uint32_t hash = 2166136261u;
+    byte_p   p    = byte_p(&Settings);
+    size_t   size = sizeof(Settings);
+    while (size--)
+        hash = (hash ^ *p++) * 16777619u;
+    return hash;
+}
+
+
+static size_t complete_utf8(utf8 text, size_t len)
+// ----------------------------------------------------------------------------
+//   Remove a partial UTF-8 sequence at the end of a truncated head
+// ----------------------------------------------------------------------------
+{
+    size_t last = len;
+    while (last && (text[last-1] & 0xC0) == 0x80)
+        last--;
+    if (!last)
+        return 0;
+    byte lead = text[last-1];
+    size_t need = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+    return len - (last - 1) < need ? last - 1 : len;
+}
+
+
+#ifdef SIMULATOR
+bool stack::cached(object_p obj, std::string &head, std::string &tail)
+// ----------------------------------------------------------------------------
+//   Return the cached rendering for an object, for testing purpose
+// ----------------------------------------------------------------------------
+{
+    for (rendering &e : stack_cache)
+    {
+        if (e.object.Safe() == obj && e.text)
+        {
+            size_t len = 0;
+            utf8   txt = e.text->value(&len);
+            head = std::string(cstring(txt), e.split);
+            tail = std::string(cstring(txt) + e.split, len - e.split);
+            return true;
+        }
+    }
+    return false;
+}
+#endif // SIMULATOR
+
+
+static bool cached_rendering(object_g obj, font_p font,
+                             renderer &head, renderer &tail,
+                             utf8 &out, size_t &len, size_t &split,
+                             size &width)
+// ----------------------------------------------------------------------------
+//   Render an object for the stack, reusing earlier renderings if possible
+// ----------------------------------------------------------------------------
+//   The head renderer is bounded, so that large objects stop rendering once
+//   the screen is full. In that case, the tail renderer only renders the end
+//   of the object. The output is the head, then the tail starting at split.
+//   The width is that of the tail, and split is 0 if the object fits.
+//   If the rendering cannot be cached, the output is left in the renderers.
+{
+    uint32_t   key    = settings_hash();
+    size_t     osize  = obj->size();
+    rendering *oldest = stack_cache;
+    for (rendering &e : stack_cache)
+    {
+        if (e.object.Safe() == obj.Safe() && e.osize == osize &&
+            e.settings == key && e.text)
+        {
+            out = e.text->value(&len);
+            split = e.split;
+            if (e.font != font)
+            {
+                e.font = font;
+                e.width = font->width(out + split, len - split);
+            }
+            width = e.width;
+            e.used = ++stack_cache_clock;
+            stack_cache_hits++;
+            return true;
+        }
+        if (e.used < oldest->used)
+            oldest = &e;
+    }
+
+    stack_cache_misses++;
+    record(stack_cache, "Miss for %+s, %u hits %u misses",
+           obj->name(), stack_cache_hits, stack_cache_misses);
+    obj->render(head);
+    len = head.size();
+    split = 0;
+    out = head.text();
+    if (head.truncated())
+    {
+        // The tail is rendered in the scratchpad right after the head.
+        // Since text() is relative to the scratchpad, which just grew,
+        // locate the head from the start of the tail
+        size_t hlen = rt.scratchpad() - (byte_p) out;
+        split = complete_utf8(out, len);
+        obj->render(tail);
+        utf8 ttext = tail.text();
+        out = ttext - hlen;
+
+        // Drop the partial UTF-8 sequence between head and tail, if any
+        memmove((byte *) out + split, ttext, tail.size());
+        len = split + tail.size();
+    }
+    width = font->width(out + split, len - split);
+
+    // Only cache if this does not require a garbage collection
+    if (rt.available() < 2 * len + 16)
+        return false;
+    text_g txt = text::make(out, len);
+    if (!txt)
+        return false;
+    oldest->object = obj;
+    oldest->osize = osize;
+    oldest->text = txt;
+    oldest->font = font;
+    oldest->settings = key;
+    oldest->split = split;
+    oldest->width = width;
+    oldest->used = ++stack_cache_clock;
+    out = txt->value(&len);
+    return true;
+}
+
+
+bool stack::cache_purge()
+// ----------------------------------------------------------------------------
+//   Purge the rendering cache, return true if this may free some memory
+// ----------------------------------------------------------------------------
+{
+    bool purged = false;
+    for (rendering &e : stack_cache)
+    {
+        if (e.object || e.text)
+            purged = true;
+        e.object = nullptr;
+        e.text = nullptr;
+    }
+    if (purged)
+        record(stack_cache, "Purged, %u hits %u misses",
+               stack_cache_hits, stack_cache_misses);
+    return purged;
+}
+
+
 void stack::draw_stack()
 // ----------------------------------------------------------------------------
 //   Draw the stack on screen
@@ -120,21 +313,27 @@ void stack::draw_stack()
         Screen.text(hdrx - w, y + idxOffset, utf8(buf), idxfont);
 
         object_g obj = rt.stack(level);
-        renderer r(nullptr, ~0U, true);
-        size_t   len = obj->render(r);
-        utf8     out = r.text();
 #ifdef SIMULATOR
+        // Tests need the full rendering even for very large objects
+        renderer full(nullptr, ~0U, true);
         if (level == 0)
         {
-            output(last_key, obj->type(), out, len);
+            size_t flen = obj->render(full);
+            utf8   fout = full.text();
+            output(last_key, obj->type(), fout, flen);
             record(tests,
                    "Key %d X-reg %+s size %u %s",
-                   last_key, object::name(obj->type()), len, out);
+                   last_key, object::name(obj->type()), flen, fout);
         }
 #endif
+        renderer head(nullptr, STACK_RENDER_BUDGET, true);
+        renderer tail(nullptr, STACK_RENDER_BUDGET, true, true);
+        size_t   len  = 0;
+        size_t   tpos = 0;
+        utf8     out  = nullptr;
+        cached_rendering(obj, font, head, tail, out, len, tpos, w);
 
-        w = font->width(out, len);
-        if (w > avail)
+        if (w > avail || tpos)
         {
             unicode sep   = L'…';
             coord   x     = hdrx + 5;
@@ -143,11 +342,11 @@ void stack::draw_stack()
             size    offs  = lineHeight / 5;
 
             Screen.clip(x, ytop, split, yb);
-            Screen.text(x, y, out, len, font);
+            Screen.text(x, y, out, tpos ? tpos : len, font);
             Screen.clip(split, ytop, split + skip, yb);
             Screen.glyph(split + skip/8, y - offs, sep, font, pattern::gray50);
             Screen.clip(split+skip, y, LCD_W, yb);
-            Screen.text(LCD_W - w, y, out, len, font);
+            Screen.text(LCD_W - w, y, out + tpos, len - tpos, font);
         }
         else
         {
@@ -44,8 +44,14 @@ struct stack
 
     void draw_stack();
 
+    // Drop cached renderings, return true if this may free some memory
+    static bool cache_purge();
+
 #if SIMULATOR
 public:
+    // Cached rendering of an object, split in head and tail if truncated
+    static bool cached(object_p obj, std::string &head, std::string &tail);
+
     struct data
     // ------------------------------------------------------------------------
     //   Record the output of the stack for testing purpose
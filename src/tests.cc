@@ -30,9 +30,11 @@
 #include "tests.h"
 
 #include "dmcp.h"
+#include "equation.h"
 #include "recorder.h"
 #include "settings.h"
 #include "stack.h"
+#include "sysmenu.h"
 #include "user_interface.h"
 
 #include <regex.h>
@@ -85,6 +87,9 @@ void tests::run(bool onlyCurrent)
         text_functions();
         rewrite_engine();
         expand_collect_simplify();
+        numerical_solvers();
+        symbolic_differentiation();
+        plotting();
         regression_checks();
     }
     summary();
@@ -264,11 +269,31 @@ void tests::keyboard_entry()
     cstring seps2auto = "{ } ( ) []";
     test(CLEAR, seps2).editor(seps2auto).wait(500);
 
+    step("Editing in the middle of the command line");
+    test(CLEAR, "ABCDEF", UP, UP, "XY").editor("ABCDXYEF");
+    test(BSP).editor("ABCDXEF");
+    test(DOWN, "Z").editor("ABCDXEZF");
+    test(UP, UP, UP, BSP, BSP).editor("ABXEZF");
+
+    step("Editing across multiple lines");
+    test(CLEAR, "AB\nCD\nEF").editor("AB\nCD\nEF");
+    test(UP, UP, BSP).editor("AB\nCDEF");
+    test("\n").editor("AB\nCD\nEF");
+    test(DOWN, DOWN, "G").editor("AB\nCD\nEFG");
+
     step("Key repeat");
     test(CLEAR, LONGPRESS, SHIFT, LONGPRESS, A)
         .wait(1000)
         .test(RELEASE)
         .check(ui.cursor > 4);
+
+    step("Refresh only sends lines that changed");
+    uint sent = 0, skipped = 0, sent2 = 0, skipped2 = 0;
+    test(CLEAR, "1 2", ENTER).noerr();
+    refresh_counts(sent, skipped);
+    test(SWAP).expect("1");
+    refresh_counts(sent2, skipped2);
+    check(sent2 > sent).check(skipped2 > skipped);
 }
 
 
@@ -672,6 +697,8 @@ void tests::global_variables()
     test(CLEAR, "DirTest path", ENTER).expect("{ HomeDirectory DirTest }");
     step("Current directory content");
     test(CLEAR, "CurrentDirectory", ENTER).expect("Directory { }");
+    step("Directory on the stack shows stored variables");
+    test("242 'Foo' STO", ENTER).match("Directory.*Foo.*242");
     step("Store in subdirectory");
     test(CLEAR, "242 'Foo' STO", ENTER).noerr();
     step("Recall from subdirectory");
@@ -1486,6 +1513,75 @@ void tests::decimal_numerical_functions()
     step("hypot")
         .test(CLEAR, "3.21 1.23 hypot", ENTER)
         .expect("3.43758 63625 51492 32");
+
+    step("Functions follow the precision setting")
+        .test(CLEAR, "16 Precision", ENTER).noerr()
+        .test(CLEAR, "0.321 sin", ENTER)
+        .type(object::ID_decimal64)
+        .expect("3.15515 63859 27271⁳⁻¹")
+        .test(CLEAR, "2 sqrt", ENTER)
+        .type(object::ID_decimal64)
+        .test(CLEAR, "7 Precision", ENTER).noerr()
+        .test(CLEAR, "0.321 sqrt", ENTER)
+        .type(object::ID_decimal32)
+        .expect("5.66568 6⁳⁻¹")
+        .test(CLEAR, "34 Precision", ENTER).noerr()
+        .test(CLEAR, "0.321 sqrt", ENTER)
+        .type(object::ID_decimal128);
+
+    step("Variable-precision decimals")
+        .test(CLEAR, "50 Precision", ENTER).noerr()
+        .test(CLEAR, "2 sqrt", ENTER)
+        .type(object::ID_big_decimal)
+        .test("1.4142135623730950488016887242096980785696718753769", ENTER)
+        .type(object::ID_big_decimal)
+        .test(SUB)
+        .expect("0.")
+        .test(CLEAR, "1. 3 / 3 * 1 -", ENTER)
+        .type(object::ID_big_decimal)
+        .expect("-1.⁳⁻⁵⁰")
+        .test(CLEAR, "34 Precision", ENTER).noerr();
+
+    step("Variable-precision decimals do not change MaxBigNumBits")
+        .test(CLEAR, "128 MaxBigNumBits 100 Precision", ENTER).noerr()
+        .test(CLEAR, "2 sqrt", ENTER)
+        .type(object::ID_big_decimal)
+        .check(Settings.maxbignum == 128)
+        .test(CLEAR, "1E90 7 mod", ENTER)
+        .expect("1.")
+        .test(CLEAR, "1E1000 7 mod", ENTER)
+        .error("Number is too big")
+        .check(Settings.maxbignum == 128)
+        .test(CLEAR, "2 200 ^", ENTER)
+        .error("Number is too big")
+        .test(CLEAR, "1024 MaxBigNumBits 34 Precision", ENTER).noerr();
+
+    step("Hardware floating-point")
+        .test(CLEAR, "16 Precision HardwareFloatingPoint", ENTER).noerr()
+        .test(CLEAR, "0.5 0.25 +", ENTER)
+        .type(object::ID_hwdouble)
+        .expect("0.75")
+        .test(CLEAR, "2 sqrt", ENTER)
+        .type(object::ID_hwdouble)
+        .expect("1.41421 35623 73095 1")
+        .test(CLEAR, "0.1 →Num", ENTER)
+        .type(object::ID_decimal64)
+        .expect("0.1")
+        .test(CLEAR, "DecimalComma", ENTER).noerr()
+        .test(CLEAR, "0,5 0,25 +", ENTER)
+        .type(object::ID_hwdouble)
+        .expect("0,75")
+        .test(CLEAR, "DecimalDot", ENTER).noerr()
+        .test(CLEAR, "1E300 1E300 *", ENTER)
+        .error("Argument outside domain")
+        .test(CLEAR, "2048 MaxBigNumBits", ENTER).noerr()
+        .test(CLEAR, "2 1100 ^ 3 690 ^ / 1. *", ENTER)
+        .type(object::ID_hwdouble)
+        .expect("83.04805 65601 2616")
+        .test(CLEAR, "1024 MaxBigNumBits", ENTER).noerr()
+        .test(CLEAR, "SoftwareFloatingPoint 34 Precision", ENTER).noerr()
+        .test(CLEAR, "0.1", ENTER)
+        .type(object::ID_decimal32);
 }
 
 
@@ -1796,6 +1892,49 @@ void tests::complex_arithmetic()
     step("Do not promote symbols to complex");
     test(CLEAR, "2+3ⅈ 'A' +", ENTER)
         .expect("'(2+3ⅈ)+A'");
+
+    step("Packed decimal complex arithmetic");
+    test(CLEAR, "1.5+2.5ⅈ", ENTER, "0.5-1.5ⅈ", ADD)
+        .type(object::ID_rectangular).expect("2.+1.ⅈ");
+    test("1.5+2.5ⅈ", MUL)
+        .type(object::ID_rectangular).expect("0.5+6.5ⅈ");
+    test("1.5+2.5ⅈ", DIV)
+        .type(object::ID_rectangular).expect("2.+1.ⅈ");
+    test("0.5+1.5ⅈ", SUB)
+        .type(object::ID_rectangular).expect("1.5-0.5ⅈ");
+    test(CHS)
+        .type(object::ID_rectangular).expect("-1.5+0.5ⅈ");
+    test(CLEAR, "3.+4.ⅈ ABS", ENTER)
+        .type(object::ID_decimal128).expect("5.");
+
+    step("Packed complex parts follow precision");
+    test(CLEAR, "7 Precision", ENTER).noerr();
+    test(CLEAR, "1.5+2.5ⅈ 0.5-1.5ⅈ *", ENTER)
+        .type(object::ID_rectangular).expect("4.5-1.ⅈ");
+    test("RE", ENTER)
+        .type(object::ID_decimal32).expect("4.5");
+    test(CLEAR, "3.+4.ⅈ ABS", ENTER)
+        .type(object::ID_decimal32).expect("5.");
+    test(CLEAR, "16 Precision", ENTER).noerr();
+    test(CLEAR, "1.5+2.5ⅈ 0.5-1.5ⅈ /", ENTER)
+        .type(object::ID_rectangular).expect("-1.2+1.4ⅈ");
+    test("IM", ENTER)
+        .type(object::ID_decimal64).expect("1.4");
+    test(CLEAR, "1.5+2.5ⅈ 0.5-1.5ⅈ -", ENTER)
+        .type(object::ID_rectangular).expect("1.+4.ⅈ");
+    test("RE", ENTER)
+        .type(object::ID_decimal64).expect("1.");
+    test(CLEAR, "34 Precision", ENTER).noerr();
+    test(CLEAR, "1.5+2.5ⅈ 0.5-1.5ⅈ +", ENTER)
+        .type(object::ID_rectangular).expect("2.+1.ⅈ");
+    test("RE", ENTER)
+        .type(object::ID_decimal128).expect("2.");
+    test(CLEAR, "40 Precision", ENTER).noerr();
+    test(CLEAR, "1.5+2.5ⅈ 3", ENTER, DIV)
+        .type(object::ID_rectangular);
+    test("RE", ENTER)
+        .type(object::ID_big_decimal).expect("0.5");
+    test(CLEAR, "34 Precision", ENTER).noerr();
 }
 
 
@@ -2134,6 +2273,40 @@ void tests::vector_functions()
         .expect("3.74165 73867 73941 3856");
     test(CLEAR, "[1 2 3] NORM", ENTER)
         .expect("3.74165 73867 73941 3856");
+    test(CLEAR, "[3 4] ABS", ENTER)
+        .expect("5.");
+    test(CLEAR, "[3. 4] ABS", ENTER)
+        .expect("5.");
+
+    step("Dot product");
+    test(CLEAR, "[1 2 3] [4 5 6] DOT", ENTER)
+        .expect("32");
+    test(CLEAR, "[1 -2 3] [4 5 -6] DOT", ENTER)
+        .expect("-24");
+    test(CLEAR, "[1.5 2 3] [4 5 6] DOT", ENTER)
+        .expect("34.");
+    test(CLEAR, "[a b c] [d e f] DOT", ENTER)
+        .expect("'a×d+b×e+c×f'");
+    test(CLEAR, "[1 2 3] [4 5] DOT", ENTER)
+        .error("Invalid dimension");
+    test(CLEAR, "[1 2 3] 4 DOT", ENTER)
+        .error("Bad argument type");
+
+    step("Scaled vector addition");
+    test(CLEAR, "2 [1 2 3] [4 5 6] AXPY", ENTER)
+        .expect("[ 6 9 12 ]");
+    test(CLEAR, "-3 [1 2 3] [4 5 6] AXPY", ENTER)
+        .expect("[ 1 -1 -3 ]");
+    test(CLEAR, "1.5 [1 2 3] [4 5 6] AXPY", ENTER)
+        .expect("[ 5.5 8. 10.5 ]");
+    test(CLEAR, "2 [[1 2][3 4]] [[1 1][1 1]] AXPY", ENTER)
+        .expect("[[ 3 5 ]\n  [ 7 9 ]]");
+    test(CLEAR, "k [a b] [c d] AXPY", ENTER)
+        .expect("[ 'k×a+c' 'k×b+d' ]");
+    test(CLEAR, "2 [1 2 3] [4 5] AXPY", ENTER)
+        .error("Invalid dimension");
+    test(CLEAR, "2 [1 2 3] 4 AXPY", ENTER)
+        .error("Bad argument type");
 
     step("Component-wise application of functions");
     test(CLEAR, "[a b c] SIN", ENTER)
@@ -2404,6 +2577,21 @@ void tests::rewrite_engine()
         .expect("'2×A+B'");
     test(CLEAR, "'(A+A+A)' 'X+U+X' '2*X+U' rewrite", ENTER)
         .expect("'A+A+A'");
+
+    step("Innermost first, revisiting replacements");
+    test(CLEAR, "'A*(B*(C*D))' 'X*(Y*Z)' 'X*Y*Z' rewrite", ENTER)
+        .expect("'A×B×C×D'");
+    test(CLEAR, "'sin(A*(B*C))+cos(D*(E*F))' 'X*(Y*Z)' 'X*Y*Z' rewrite",
+         ENTER)
+        .expect("'sin(A×B×C)+cos(D×E×F)'");
+
+    step("List of rules");
+    test(CLEAR, "'A*1+A*1' { 'X*1' 'X' 'X+X' '2*X' } rewrite", ENTER)
+        .expect("'2×A'");
+    test(CLEAR, "'sin(B*1)+C' { 'X*1' 'X' 'cos X' 'sin X' } rewrite", ENTER)
+        .expect("'sin B+C'");
+    test(CLEAR, "'A+B' { 'X+Y' } rewrite", ENTER)
+        .error("Bad argument value").clear();
 }
 
 
@@ -2443,10 +2631,175 @@ void tests::expand_collect_simplify()
         .expect("'2×(B↑2×A)+(2×(A↑2×B)+A↑3+B↑2×A+A↑2×B)+B↑3'");
     // .expect("'(A+B)³'");
 
+    step("Expand univariate polynomial");
+    test(CLEAR, "'(X+1)^3' expand ", ENTER)
+        .expect("'X↑3+3×X↑2+3×X+1'");
+    step("Collect univariate polynomial");
+    test(CLEAR, "'(X-1)*(X+1)+2*X' collect ", ENTER)
+        .expect("'X↑2+2×X-1'");
+    step("Exact polynomial division");
+    test(CLEAR, "'(X^3-1)/(X-1)' expand ", ENTER)
+        .expect("'X↑2+X+1'");
+    step("Polynomial cancelling to zero");
+    test(CLEAR, "'2*X-(X+X)' expand ", ENTER)
+        .expect("0");
+
+    step("Memoized simplification");
+    test(CLEAR, "'A*1+0' simplify 'A*1+0' simplify", ENTER)
+        .expect("'A'");
+    test(CLEAR, "'(A+B)*C' expand '(A+B)*C' expand ==", ENTER)
+        .expect("True");
+    step("Memoized results purged by GarbageCollect");
+    test(CLEAR, "'X*1+0' simplify", ENTER)
+        .expect("'X'")
+        .check(equation::memo_entries() > 0);
+    test(CLEAR, "GarbageCollect DROP", ENTER)
+        .noerr()
+        .check(equation::memo_entries() == 0);
+    test(CLEAR, "'X*1+0' simplify", ENTER)
+        .expect("'X'");
+    step("Equations with local variables are not memoized");
+    test(CLEAR, "GarbageCollect DROP 2 → A « 'A*1+0' simplify »", ENTER)
+        .expect("'A'")
+        .check(equation::memo_entries() == 0);
+    step("Memoized results purged when the current directory changes");
+    test(CLEAR, "'MemoDir' pgdir", ENTER);
+    test(CLEAR, "'MemoDir' crdir 'X*1+0' simplify", ENTER)
+        .expect("'X'")
+        .check(equation::memo_entries() > 0);
+    test(CLEAR, "MemoDir", ENTER)
+        .noerr()
+        .check(equation::memo_entries() == 0);
+    test(CLEAR, "'X*1+0' simplify", ENTER)
+        .expect("'X'")
+        .check(equation::memo_entries() > 0);
+    test(CLEAR, "UpDir", ENTER)
+        .noerr()
+        .check(equation::memo_entries() == 0);
+    test(CLEAR, "'MemoDir' pgdir", ENTER)
+        .noerr();
 
 }
 
 
+void tests::numerical_solvers()
+// ----------------------------------------------------------------------------
+//   Test the numerical solvers
+// ----------------------------------------------------------------------------
+{
+    begin("Numerical solvers");
+
+    step("Root with a single guess");
+    test(CLEAR, "'X^2-2' 'X' 1 Root 2 sqrt - abs 1E-25 <", ENTER)
+        .expect("True");
+    step("Root stored in variable");
+    test(CLEAR, "X 2 sqrt - abs 1E-25 <", ENTER)
+        .expect("True");
+    step("Root with an interval");
+    test(CLEAR, "'cos(Y)=Y' 'Y' { 0 1 } Root DUP cos - abs 1E-25 <", ENTER)
+        .expect("True");
+    step("Root of a stored equation");
+    test(CLEAR, "'X^3-27' 'F' STO 'F' 'X' 1 Root 3 - abs 1E-25 <", ENTER)
+        .expect("True");
+    step("Root without a solution");
+    test(CLEAR, "'X^2+1' 'X' 1 Root", ENTER)
+        .error("No solution found");
+    test(CLEAR, "'F' PURGE 'X' PURGE 'Y' PURGE", ENTER)
+        .noerr();
+
+    step("Integrate polynomial");
+    test(CLEAR, "0 1 'X^2' 'X' Integrate 3 inv - abs 1E-15 <", ENTER)
+        .expect("True");
+    step("Integrate exponential");
+    test(CLEAR, "0 1 'exp(T)' 'T' Integrate 1 exp 1 - - abs 1E-15 <", ENTER)
+        .expect("True");
+    step("Integrate with reversed bounds");
+    test(CLEAR, "2 0 'X' 'X' Integrate -2 - abs 1E-15 <", ENTER)
+        .expect("True");
+    step("Integrate with non-numeric bounds");
+    test(CLEAR, "'A' 1 'X' 'X' Integrate", ENTER)
+        .error("Bad argument type");
+}
+
+
+void tests::symbolic_differentiation()
+// ----------------------------------------------------------------------------
+//   Test symbolic differentiation
+// ----------------------------------------------------------------------------
+{
+    begin("Symbolic differentiation");
+
+    step("Using radians");
+    test(CLEAR, "RAD", ENTER).noerr();
+    step("Derivative of a power");
+    test(CLEAR, "'X^3' 'X' Derivative", ENTER)
+        .expect("'3×X²'");
+    step("Derivative of a product");
+    test(CLEAR, "'sin(X)*X' 'X' Derivative", ENTER)
+        .expect("'cos X×X+sin X'");
+    step("Derivative of a constant");
+    test(CLEAR, "'Y^2+3' 'X' Derivative", ENTER)
+        .expect("0");
+    step("Derivative of a quotient, numerically");
+    test(CLEAR, "'(X^2+1)/(X-1)' 'X' Derivative 'X' 3 Root 1 2 sqrt + - "
+         "abs 1E-25 <", ENTER)
+        .expect("True");
+    test(CLEAR, "'X' PURGE", ENTER)
+        .noerr();
+    step("Derivative of an expression too large for the DAG");
+    std::string large = "'X";
+    for (uint i = 2; i <= 200; i++)
+        large += "+X^" + std::to_string(i);
+    large += "' 'X' Derivative";
+    test(CLEAR, large.c_str(), ENTER)
+        .error("Expression too complex");
+
+    step("Derivative of an unsupported function");
+    test(CLEAR, "'erf(X)' 'X' Derivative", ENTER)
+        .error("Not yet implemented");
+
+    step("Trigonometric derivatives in degrees");
+    test(CLEAR, "DEG", ENTER).noerr();
+    test(CLEAR, "60 'X' STO 'sin(X)' 'X' Derivative →Num "
+         "π 360 / →Num - abs 1E-25 <", ENTER)
+        .expect("True");
+    test(CLEAR, "0.5 'X' STO 'asin(X)' 'X' Derivative →Num "
+         "180 π / 0.75 sqrt / →Num - abs 1E-25 <", ENTER)
+        .expect("True");
+    test(CLEAR, "'X' PURGE RAD", ENTER)
+        .noerr();
+}
+
+void tests::plotting()
+// ----------------------------------------------------------------------------
+//   Test the plotting commands
+// ----------------------------------------------------------------------------
+{
+    begin("Plotting");
+
+    step("Function plot");
+    test(CLEAR, "'sin(X)*5' 'X' FunctionPlot", ENTER)
+        .noerr();
+    step("Function plot with range and undefined points");
+    test(CLEAR, "'sqrt(X)' { X -4 16 } FunctionPlot", ENTER)
+        .noerr();
+    test(CLEAR, "'1/X' 'X' FunctionPlot", ENTER)
+        .noerr();
+    step("Polar plot");
+    test(CLEAR, "'3*cos(2*T)' 'T' PolarPlot", ENTER)
+        .noerr();
+    step("Parametric plot");
+    test(CLEAR, "{ '5*cos(T)' '3*sin(3*T)' } 'T' ParametricPlot", ENTER)
+        .noerr();
+    step("Errors other than undefined points stop the plot");
+    test(CLEAR, "'sin(X)+PlotUndefined' 'X' FunctionPlot", ENTER)
+        .error("Bad argument type");
+    step("Parametric plot requires two expressions");
+    test(CLEAR, "'T' 'T' ParametricPlot", ENTER)
+        .error("Bad argument type");
+}
+
+
 void tests::regression_checks()
 // ----------------------------------------------------------------------------
 //   Checks for specific regressions
@@ -2493,6 +2846,31 @@ void tests::regression_checks()
 
     step("Bug 279: 0/0 should error out");
     test(CLEAR, "0 0 /", ENTER).error("Divide by zero");
+
+    step("Stack rendering of objects longer than the head buffer");
+    std::string big = "{";
+    for (uint i = 1; i <= 200; i++)
+        big += " " + std::to_string(i);
+    big += " }";
+    std::string head, tail;
+    for (uint level = 0; level < 2; level++)
+    {
+        if (level)
+            test("DUP", ENTER).expect(big.c_str());
+        else
+            test(CLEAR, big.c_str(), ENTER).expect(big.c_str());
+        test(NOKEYS)
+            .check(stack::cached(rt.stack(level), head, tail),
+                   "No cached rendering at level ", level + 1)
+            .check(head.length() && tail.length(),
+                   "Rendering was not truncated at level ", level + 1)
+            .check(big.compare(0, head.length(), head) == 0,
+                   "Bad head [", head, "]")
+            .check(big.length() >= tail.length() &&
+                   big.compare(big.length() - tail.length(),
+                               tail.length(), tail) == 0,
+                   "Bad tail [", tail, "]");
+    }
 }
 
 
@@ -81,6 +81,9 @@ struct tests
     void auto_simplification();
     void rewrite_engine();
     void expand_collect_simplify();
+    void numerical_solvers();
+    void symbolic_differentiation();
+    void plotting();
     void regression_checks();
 
     enum key
@@ -90,6 +90,11 @@ user_interface::user_interface()
       edRows(0),
       edRow(0),
       edColumn(0),
+      edKnown(0),
+      edIndexed(0),
+      edWidthFont(),
+      edLineStart(),
+      edLineWidth(),
       menuStack(),
       menuPage(),
       menuPages(),
@@ -164,13 +169,12 @@ void user_interface::edit(unicode c, modes m)
     case '"':  closing = '"';  m = TEXT;      break;
     case '\'': closing = '\''; m = ALGEBRAIC; break;
     case L'«': closing = L'»'; m = PROGRAM;   break;
-    case '\n': edRows = 0;                    break; // Recompute rows
     }
     if (closing)
     {
-        byte *ed = rt.editor();
+        utf8 ed = rt.editor_at(savec);
         if (mode == PROGRAM || mode == ALGEBRAIC || mode == DIRECT)
-            if (savec > 0 && ed[savec] != ' ')
+            if (savec > 0 && *ed != ' ')
                 cursor += rt.insert(savec, ' ');
         len = utf8_encode(closing, utf8buf);
         rt.insert(cursor, utf8buf, len);
@@ -189,7 +193,6 @@ object::result user_interface::edit(utf8 text, size_t len, modes m, int offset)
     dirtyEditor = true;
 
     bool editing = rt.editing();
-    byte *ed = rt.editor();
     bool skip = m == POSTFIX && mode == ALGEBRAIC;
 
     // Skip the x in postfix operators (x⁻¹, x², x³ or x!)
@@ -205,7 +208,7 @@ object::result user_interface::edit(utf8 text, size_t len, modes m, int offset)
         dirtyStack = true;
     }
     else if ((mode != ALGEBRAIC || m != ALGEBRAIC) &&
-             cursor > 0 && ed[cursor-1] != ' ')
+             cursor > 0 && *rt.editor_at(cursor-1) != ' ')
     {
         if (!skip && (mode != ALGEBRAIC || (m != INFIX && m != CONSTANT)))
             cursor += rt.insert(cursor, ' ');
@@ -263,7 +266,6 @@ bool user_interface::end_edit()
     if (edlen)
     {
         // Remove all additional decorative number spacing
-        byte   *ed   = rt.editor();
         size_t  o    = 0;
         bool    text = false;
         unicode nspc = Settings.space;
@@ -272,7 +274,7 @@ bool user_interface::end_edit()
         draw_busy_cursor();
         while (o < edlen)
         {
-            unicode cp = utf8_codepoint(ed + o);
+            unicode cp = utf8_codepoint(rt.editor_at(o));
             if (cp == '"')
             {
                 text = !text;
@@ -468,7 +470,7 @@ void user_interface::updateMode()
 //   Scan the command line to check what the state is at the cursor
 // ----------------------------------------------------------------------------
 {
-    utf8    ed    = rt.editor();
+    utf8    ed    = rt.editor(cursor);
     utf8    last  = ed + cursor;
     uint    progs = 0;
     uint    lists = 0;
@@ -592,7 +594,7 @@ void user_interface::updateMode()
 
             while (o < len && isnum)
             {
-                unicode code = utf8_codepoint(ed + o);
+                unicode code = utf8_codepoint(rt.editor_at(o));
 
                 // Remove all spacing in the range
                 if (code == nspc || code == hspc)
@@ -602,7 +604,6 @@ void user_interface::updateMode()
                     if (cursor > o)
                         cursor -= remove;
                     len -= remove;
-                    ed = rt.editor(); // Defensive coding (no move on remove)
                     continue;
                 }
 
@@ -896,7 +897,7 @@ void user_interface::draw_start(bool forceRedraw, uint refresh)
 //   Start a drawing cycle
 // ----------------------------------------------------------------------------
 {
-    dirty = rect();
+    draw_clean();
     force = forceRedraw;
     nextRefresh = refresh;
     userScreen = false;
@@ -927,10 +928,38 @@ void user_interface::draw_dirty(const rect &r)
 //   Indicates that a component dirtied a given area of the screen
 // ----------------------------------------------------------------------------
 {
-    if (dirty.empty())
-        dirty = r;
-    else
-        dirty |= r;
+    coord top    = r.y1 < 0 ? 0 : r.y1;
+    coord bottom = r.y2 < LCD_H ? r.y2 : LCD_H - 1;
+    for (coord y = top; y <= bottom; y++)
+        dirty[y / 32] |= 1U << (y % 32);
+}
+
+
+bool user_interface::draw_dirty_lines(coord &top, coord &bottom)
+// ----------------------------------------------------------------------------
+//   Find the next span of dirty lines starting at or after top
+// ----------------------------------------------------------------------------
+{
+    coord y = top < 0 ? 0 : top;
+    while (y < LCD_H && !(dirty[y / 32] & (1U << (y % 32))))
+        y = dirty[y / 32] >> (y % 32) ? y + 1 : (y / 32 + 1) * 32;
+    if (y >= LCD_H)
+        return false;
+    top = y;
+    while (y + 1 < LCD_H && (dirty[(y + 1) / 32] & (1U << ((y + 1) % 32))))
+        y++;
+    bottom = y;
+    return true;
+}
+
+
+void user_interface::draw_clean()
+// ----------------------------------------------------------------------------
+//   Mark all lines as clean after they were sent to the screen
+// ----------------------------------------------------------------------------
+{
+    for (uint w = 0; w < DIRTY_WORDS; w++)
+        dirty[w] = 0;
 }
 
 
@@ -1412,10 +1441,222 @@ bool user_interface::draw_idle()
 }
 
 
+void user_interface::editor_index()
+// ----------------------------------------------------------------------------
+//   Rebuild the index of editor lines if it does not match the editor
+// ----------------------------------------------------------------------------
+//   The index records where the first lines start and caches their width.
+//   It is normally maintained incrementally by editor_inserted() and
+//   editor_removing(). Setting edRows to 0 forces a rebuild.
+{
+    size_t len = rt.editing();
+    if (edRows && edIndexed == len)
+        return;
+
+    uint rows = 1;
+    edKnown = 1;
+    edLineStart[0] = 0;
+    edLineWidth[0] = -1;
+    for (size_t o = 0; o < len; o++)
+    {
+        if (*rt.editor_at(o) == '\n')
+        {
+            if (rows < EDITOR_LINES)
+            {
+                edLineStart[rows] = o + 1;
+                edLineWidth[rows] = -1;
+                edKnown = rows + 1;
+            }
+            rows++;
+        }
+    }
+    edRows = rows;
+    edIndexed = len;
+    record(text_editor, "Indexed %u rows, %u known", edRows, edKnown);
+}
+
+
+void user_interface::editor_inserted(size_t offset, size_t len)
+// ----------------------------------------------------------------------------
+//   Update the line index after text was inserted in the editor
+// ----------------------------------------------------------------------------
+{
+    if (!edRows || edIndexed + len != rt.editing())
+    {
+        edRows = 0;
+        return;
+    }
+
+    uint added = 0;
+    for (size_t o = offset; o < offset + len; o++)
+        if (*rt.editor_at(o) == '\n')
+            added++;
+
+    // Lines after the insertion point move, the current line changes width
+    uint line = editor_line(offset, false);
+    for (uint l = line + 1; l < edKnown; l++)
+        edLineStart[l] += len;
+    edLineWidth[line] = -1;
+
+    // Insert new lines in the index unless they are past the known lines
+    if (added && line + 1 < edKnown)
+    {
+        uint known = edKnown + added;
+        if (known > EDITOR_LINES)
+            known = EDITOR_LINES;
+        for (uint l = known; l-- > line + 1 + added; )
+        {
+            edLineStart[l] = edLineStart[l - added];
+            edLineWidth[l] = edLineWidth[l - added];
+        }
+        uint l = line + 1;
+        for (size_t o = offset; o < offset + len && l < known; o++)
+        {
+            if (*rt.editor_at(o) == '\n')
+            {
+                edLineStart[l] = o + 1;
+                edLineWidth[l] = -1;
+                l++;
+            }
+        }
+        edKnown = known;
+    }
+    edRows += added;
+    edIndexed += len;
+}
+
+
+void user_interface::editor_removing(size_t offset, size_t len)
+// ----------------------------------------------------------------------------
+//   Update the line index before text is removed from the editor
+// ----------------------------------------------------------------------------
+{
+    size_t edlen = rt.editing();
+    if (!edRows || edIndexed != edlen)
+    {
+        edRows = 0;
+        return;
+    }
+    if (offset > edlen)
+        offset = edlen;
+    if (len > edlen - offset)
+        len = edlen - offset;
+
+    uint removed = 0;
+    for (size_t o = offset; o < offset + len; o++)
+        if (*rt.editor_at(o) == '\n')
+            removed++;
+
+    // Known lines starting in the removed text go away, later ones move
+    uint line = editor_line(offset, false);
+    uint first = line + 1;
+    uint last = first;
+    while (last < edKnown && edLineStart[last] <= offset + len)
+        last++;
+    uint gone = last - first;
+    for (uint l = last; l < edKnown; l++)
+    {
+        edLineStart[l - gone] = edLineStart[l] - len;
+        edLineWidth[l - gone] = edLineWidth[l];
+    }
+    edKnown -= gone;
+    edLineWidth[line] = -1;
+    edRows -= removed;
+    edIndexed -= len;
+}
+
+
+size_t user_interface::editor_line_start(uint line)
+// ----------------------------------------------------------------------------
+//   Return the offset where the given line starts
+// ----------------------------------------------------------------------------
+//   Lines past the index are found from the last known line, which extends
+//   the index when there is room for it
+{
+    if (line < edKnown)
+        return edLineStart[line];
+
+    size_t len = rt.editing();
+    uint   l   = edKnown - 1;
+    size_t o   = edLineStart[l];
+    while (l < line && o < len)
+    {
+        if (*rt.editor_at(o++) == '\n')
+        {
+            l++;
+            if (l == edKnown && edKnown < EDITOR_LINES)
+            {
+                edLineStart[edKnown] = o;
+                edLineWidth[edKnown] = -1;
+                edKnown++;
+            }
+        }
+    }
+    return l == line ? o : len;
+}
+
+
+uint user_interface::editor_line(size_t offset, bool scan)
+// ----------------------------------------------------------------------------
+//   Return the line containing the given offset
+// ----------------------------------------------------------------------------
+//   Without scan, only return the last known line starting before offset
+{
+    uint lo = 0;
+    uint hi = edKnown;
+    while (hi - lo > 1)
+    {
+        uint mid = (lo + hi) / 2;
+        if (edLineStart[mid] <= offset)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    if (scan && lo + 1 == edKnown && edKnown < edRows)
+        for (size_t o = edLineStart[lo]; o < offset; o++)
+            if (*rt.editor_at(o) == '\n')
+                lo++;
+    return lo;
+}
+
+
+int user_interface::editor_line_width(uint line, font_p font)
+// ----------------------------------------------------------------------------
+//   Return the width of the given line in pixels, cached in the index
+// ----------------------------------------------------------------------------
+{
+    if (font != edWidthFont)
+    {
+        for (uint l = 0; l < edKnown; l++)
+            edLineWidth[l] = -1;
+        edWidthFont = font;
+    }
+    if (line < edKnown && edLineWidth[line] >= 0)
+        return edLineWidth[line];
+
+    size_t len   = rt.editing();
+    int    width = 0;
+    for (size_t o = editor_line_start(line); o < len; )
+    {
+        unicode cp = utf8_codepoint(rt.editor_at(o));
+        if (cp == '\n')
+            break;
+        width += font->width(cp);
+        o += utf8_size(cp);
+    }
+    if (line < edKnown)
+        edLineWidth[line] = width;
+    return width;
+}
+
+
 bool user_interface::draw_editor()
 // ----------------------------------------------------------------------------
 //   Draw the editor
 // ----------------------------------------------------------------------------
+//   The line index gives the cursor row and the visible lines directly,
+//   so that only the visible lines and the cursor row are scanned
 {
     if (!force && !dirtyEditor)
         return false;
@@ -1425,10 +1666,8 @@ bool user_interface::draw_editor()
            force ? "forced" : "lazy",
            cursor, xoffset, cx);
 
-    // Get the editor area
-    utf8   ed   = rt.editor();
+    // Get the editor area, which we read around the gap
     size_t len  = rt.editing();
-    utf8   last = ed + len;
     dirtyEditor = false;
 
     if (!len)
@@ -1443,110 +1682,43 @@ bool user_interface::draw_editor()
         return false;
     }
 
-    // Select font
-    font_p font = Settings.editor_font(false);
-
-    // Count rows and colums
-    int  rows   = 1;            // Number of rows in editor
-    int  cwidth = 0;            // Column width
-    int  edrow  = 0;            // Row number of line being edited
-    int  cursx  = 0;            // Cursor X position
-    bool found  = false;
-
-    byte *wed = (byte *) ed;
-    wed[len] = 0;               // Ensure utf8_next does not go into the woods
-
     // Count rows to check if we need to switch to stack font
-    if (!edRows)
-    {
-        for (utf8 p = ed; p < last; p = utf8_next(p))
-            if (*p == '\n')
-                rows++;
-        edRows = rows;
-
-        font = Settings.editor_font(rows > 2);
-
-        rows = 1;
-        for (utf8 p = ed; p < last; p = utf8_next(p))
-        {
-            if (p - ed == (int) cursor)
-            {
-                edrow = rows - 1;
-                cursx = cwidth;
-                found = true;
-            }
-
-            if (*p == '\n')
-            {
-                rows++;
-                cwidth = 0;
-            }
-            else
-            {
-                unicode cp  = utf8_codepoint(p);
-                cwidth     += font->width(cp);
-            }
-        }
-        if (!found)
-        {
-            edrow = rows - 1;
-            cursx = cwidth;
-        }
-
-        edRow = edrow;
-
-        record(text_editor, "Computed: row %d/%d cursx %d (%d+%d=%d)",
-               edrow, rows, cursx, cx, xoffset, cx+xoffset);
-    }
-    else
-    {
-        rows  = edRows;
-        edrow = edRow;
-        cursx = cx + xoffset;
-        font = Settings.editor_font(rows > 2);
-
-        record(text_editor, "Cached: row %d/%d cursx %d (%d+%d)",
-               edrow, rows, cursx, cx, xoffset, cx+xoffset);
-    }
+    editor_index();
+    int    rows  = edRows;
+    font_p font  = Settings.editor_font(rows > 2);
+    int    edrow = editor_line(cursor);
+    bool   moved = up || down;
 
     // Check if we want to move the cursor up or down
-    if (up || down)
+    if (moved)
     {
-        int   r    = 0;
-        coord c    = 0;
         int   tgt  = edrow - (up && edrow > 0) + down;
         bool  done = up && edrow == 0;
 
         record(text_editor,
-               "Moving %+s%+s edrow=%d target=%d curs=%d cursx=%d edcx=%d",
+               "Moving %+s%+s edrow=%d target=%d curs=%d edcx=%d",
                up ? "up" : "", down ? "down" : "",
-               edrow, tgt, cursor, cursx, edColumn);
+               edrow, tgt, cursor, edColumn);
 
-        for (utf8 p   = ed; p < last && !done; p = utf8_next(p))
+        if (!done && tgt < rows)
         {
-            if (*p == '\n')
-            {
-                r++;
-                if (r > tgt)
-                {
-                    cursor = p - ed;
-                    edrow  = tgt;
-                    done   = true;
-                }
-            }
-            else if (r == tgt)
+            // Find the column in the target line
+            coord c = 0;
+            size_t o = editor_line_start(tgt);
+            while (o < len)
             {
-                unicode cp = utf8_codepoint(p);
+                unicode cp = utf8_codepoint(rt.editor_at(o));
+                if (cp == '\n')
+                    break;
                 c += font->width(cp);
                 if (c > edColumn)
-                {
-                    cursor = p - ed;
-                    edrow = r;
-                    done = true;
-                }
+                    break;
+                o += utf8_size(cp);
             }
+            cursor = o;
+            edrow = tgt;
         }
-        if (!done && down)
+        else if (!done && down)
         {
             cursor = len;
             edrow = rows - 1;
@@ -1557,12 +1729,28 @@ bool user_interface::draw_editor()
 
         up   = false;
         down = false;
-        edRow = edrow;
+    }
+
+    // Compute cursor position in the cursor row
+    size_t lstart = editor_line_start(edrow);
+    int    cursx  = 0;
+    if (cursor >= len || *rt.editor_at(cursor) == '\n')
+    {
+        cursx = editor_line_width(edrow, font);
     }
     else
     {
-        edColumn = cursx;
+        for (size_t o = lstart; o < cursor; )
+        {
+            unicode cp = utf8_codepoint(rt.editor_at(o));
+            cursx += font->width(cp);
+            o += utf8_size(cp);
+        }
     }
+    edRow = edrow;
+    if (!moved)
+        edColumn = cursx;
+    record(text_editor, "Computed: row %d/%d cursx %d", edrow, rows, cursx);
 
     // Draw the area that fits on the screen
     int   lineHeight      = font->height();
@@ -1572,7 +1760,7 @@ bool user_interface::draw_editor()
     int   availableHeight = bottom - top;
     int   fullRows        = availableHeight / lineHeight;
     int   clippedRows     = (availableHeight + lineHeight - 1) / lineHeight;
-    utf8  display         = ed;
+    int   skip            = 0;
     coord y               = bottom - rows * lineHeight;
 
     blitter::rect clip = Screen.clip();
@@ -1582,26 +1770,15 @@ bool user_interface::draw_editor()
     {
         // Skip rows to show the cursor
         int half = fullRows / 2;
-        int skip = edrow < half         ? 0
-                 : edrow >= rows - half ? rows - fullRows
-                                        : edrow - half;
+        skip = edrow < half         ? 0
+             : edrow >= rows - half ? rows - fullRows
+                                    : edrow - half;
         record(text_editor,
                "Available %d, ed %d, displaying %d, skipping %d",
                fullRows,
                edrow,
                clippedRows,
                skip);
-
-        for (int r = 0; r < skip; r++)
-        {
-            do
-                display = utf8_next(display);
-            while (*display != '\n');
-        }
-        if (skip)
-            display = utf8_next(display);
-        record(text_editor, "Truncated from %d to %d, text=%s",
-               rows, clippedRows, display);
         rows = clippedRows;
         y = top;
     }
@@ -1615,9 +1792,6 @@ bool user_interface::draw_editor()
     else if (xoffset + LCD_W - cursw < cursx)
         xoffset = cursx - LCD_W + cursw + hskip;
 
-    coord x = -xoffset;
-    int   r = 0;
-
     if (y < top)
         y = top;
     if (stack != y)
@@ -1628,36 +1802,34 @@ bool user_interface::draw_editor()
     Screen.fill(0, stack, LCD_W, bottom, pattern::white);
     draw_dirty(0, stack, LCD_W, bottom);
 
-    while (r < rows && display <= last)
+    for (int r = 0; r < rows && uint(skip + r) < edRows; r++)
     {
-        bool atCursor = display == ed + cursor;
-        if (atCursor)
+        uint line  = skip + r;
+        bool isCur = (int) line == edrow;
+        if (isCur)
         {
-            cx = x;
+            cx = cursx - xoffset;
             cy = y;
         }
-        if (display >= last)
-            break;
 
-        unicode c = utf8_codepoint(display);
-        display = utf8_next(display);
-        if (c == '\n')
+        // Lines entirely on the left of the screen need no drawing
+        if (isCur || editor_line_width(line, font) > xoffset)
         {
-            y += lineHeight;
-            x  = -xoffset;
-            r++;
-            continue;
+            coord x = -xoffset;
+            for (size_t o = editor_line_start(line); o < len && x < LCD_W; )
+            {
+                unicode c = utf8_codepoint(rt.editor_at(o));
+                if (c == '\n')
+                    break;
+                o += utf8_size(c);
+                int cw = font->width(c);
+                if (x + cw >= 0)
+                    x = Screen.glyph(x, y, c, font);
+                else
+                    x += cw;
+            }
         }
-        int cw = font->width(c);
-        if (x + cw >= 0 && x < LCD_W)
-            x = Screen.glyph(x, y, c, font);
-        else
-            x += cw;
-    }
-    if (cursor >= len)
-    {
-        cx = x;
-        cy = y;
+        y += lineHeight;
     }
 
     Screen.clip(clip);
@@ -1688,11 +1860,9 @@ bool user_interface::draw_cursor(int show)
 
     // Select editor font
     bool   ml         = edRows > 2;
-    utf8   ed         = rt.editor();
     font_p edFont     = Settings.editor_font(ml);
     font_p cursorFont = Settings.cursor_font(ml);
     size_t len        = rt.editing();
-    utf8   last       = ed + len;
 
     // Select cursor character
     unicode cursorChar = mode == DIRECT      ? 'D'
@@ -1707,7 +1877,7 @@ bool user_interface::draw_cursor(int show)
     size    ch         = edFont->height();
 
     coord   x          = cx;
-    utf8    p          = ed + cursor;
+    size_t  o          = cursor;
     rect    clip       = Screen.clip();
     coord   ytop       = HeaderFont->height() + 2;
     coord   ybot       = LCD_H - menuHeight;
@@ -1716,7 +1886,9 @@ bool user_interface::draw_cursor(int show)
     bool spaces = false;
     while (x <= cx + csrw + 1)
     {
-        unicode cchar  = p < last ? utf8_codepoint(p) : ' ';
+        unicode cchar  = o < len ? utf8_codepoint(rt.editor_at(o)) : ' ';
+        if (o < len)
+            o += utf8_size(cchar);
         if (cchar     == '\n')
             spaces = true;
         if (spaces)
@@ -1729,8 +1901,6 @@ bool user_interface::draw_cursor(int show)
 
         // Write the character under the cursor
         x = Screen.glyph(x, cy, cchar, edFont);
-        if (p < last)
-            p = utf8_next(p);
     }
 
     if (blink)
@@ -2885,10 +3055,8 @@ bool user_interface::handle_editing(int key)
             if (shift && cursor < editing)
             {
                 // Shift + Backspace = Delete to right of cursor
-                utf8 ed              = rt.editor();
-                uint after           = utf8_next(ed, cursor, editing);
-                if (utf8_codepoint(ed + cursor) == '\n')
-                    edRows = 0;
+                unicode cp           = utf8_codepoint(rt.editor_at(cursor));
+                uint after           = cursor + utf8_size(cp);
                 rt.remove(cursor, after - cursor);
                 dirtyEditor = true;
                 adjustSeps = true;
@@ -2896,11 +3064,9 @@ bool user_interface::handle_editing(int key)
             else if (!shift && cursor > 0)
             {
                 // Backspace = Erase on left of cursor
-                utf8 ed      = rt.editor();
+                utf8 ed      = rt.editor(cursor);
                 uint before  = cursor;
                 cursor       = utf8_previous(ed, cursor);
-                if (utf8_codepoint(ed + cursor) == '\n')
-                    edRows = 0;
                 rt.remove(cursor, before - cursor);
                 dirtyEditor = true;
                 adjustSeps = true;
@@ -2959,13 +3125,12 @@ bool user_interface::handle_editing(int key)
             else if (xshift)
             {
                 cursor = 0;
-                edRows = 0;
                 dirtyEditor = true;
             }
             else if (cursor > 0)
             {
                 font_p edFont = Settings.editor_font(edRows > 2);
-                utf8 ed = rt.editor();
+                utf8 ed = rt.editor(cursor);
                 uint pcursor  = utf8_previous(ed, cursor);
                 unicode cp = utf8_codepoint(ed + pcursor);
                 if (cp != '\n')
@@ -2981,7 +3146,6 @@ bool user_interface::handle_editing(int key)
                 else
                 {
                     cursor = pcursor;
-                    edRows = 0;
                     dirtyEditor = true;
                 }
             }
@@ -3001,15 +3165,13 @@ bool user_interface::handle_editing(int key)
             else if (xshift)
             {
                 cursor = editing;
-                edRows = 0;
                 dirtyEditor = true;
             }
             else if (cursor < editing)
             {
                 font_p edFont = Settings.editor_font(edRows > 2);
-                utf8 ed = rt.editor();
-                unicode cp = utf8_codepoint(ed + cursor);
-                uint ncursor = utf8_next(ed, cursor, editing);
+                unicode cp = utf8_codepoint(rt.editor_at(cursor));
+                uint ncursor = cursor + utf8_size(cp);
                 if (cp != '\n')
                 {
                     draw_cursor(-1);
@@ -3023,7 +3185,6 @@ bool user_interface::handle_editing(int key)
                 else
                 {
                     cursor = ncursor;
-                    edRows = 0;
                     dirtyEditor = true;
                 }
             }
@@ -34,6 +34,7 @@
 #include "file.h"
 #include "object.h"
 #include "runtime.h"
+#include "target.h"
 #include "types.h"
 
 #include <string>
@@ -115,8 +116,8 @@ struct user_interface
     void        draw_dirty(const rect &r);
     void        draw_dirty(coord x1, coord y1, coord x2, coord y2);
     uint        draw_refresh()          { return nextRefresh; }
-    rect        draw_dirty()            { return dirty; }
-    void        draw_clean()            { dirty = rect(); }
+    bool        draw_dirty_lines(coord &top, coord &bottom);
+    void        draw_clean();
     void        draw_user_screen()      { userScreen = true; }
 
     bool        draw_header();
@@ -166,6 +167,14 @@ protected:
     bool        handle_digits(int key);
     bool        noHelpForKey(int key);
 
+    // Index of the editor lines, maintained as the editor changes
+    void        editor_index();
+    void        editor_inserted(size_t offset, size_t len);
+    void        editor_removing(size_t offset, size_t len);
+    size_t      editor_line_start(uint line);
+    uint        editor_line(size_t offset, bool scan = true);
+    int         editor_line_width(uint line, font_p font);
+
 public:
     int      evaluating;        // Key being evaluated
 
@@ -185,13 +194,20 @@ protected:
     uint     edRows;            // Editor rows
     int      edRow;             // Current editor row
     int      edColumn;          // Current editor column (in pixels)
+    enum { EDITOR_LINES = 128 };// Size of the editor line index
+    uint     edKnown;           // Number of line starts known in the index
+    size_t   edIndexed;         // Size of the editor the index describes
+    font_p   edWidthFont;       // Font used to compute the line widths
+    uint     edLineStart[EDITOR_LINES]; // Offset of the first editor lines
+    int      edLineWidth[EDITOR_LINES]; // Width of lines in pixels, or -1
     id       menuStack[HISTORY];// Current and past menus
     uint     menuPage;          // Current menu page
     uint     menuPages;         // Number of menu pages
     uint     menuHeight;        // Height of the menu
     uint     busy;              // Busy counter
     uint     nextRefresh;       // Time for next refresh
-    rect     dirty;             // Dirty rectangles
+    enum { DIRTY_WORDS = (LCD_H + 31) / 32 };
+    uint32_t dirty[DIRTY_WORDS];// Dirty screen lines, one bit per line
     object_g editing;           // Object being edited if any
     bool     shift        : 1;  // Normal shift active
     bool     xshift       : 1;  // Extended shift active (simulate Right)
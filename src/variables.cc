@@ -30,11 +30,13 @@
 #include "variables.h"
 
 #include "command.h"
+#include "equation.h"
 #include "integer.h"
 #include "list.h"
 #include "locals.h"
 #include "parser.h"
 #include "renderer.h"
+#include "stack.h"
 
 
 RECORDER(directory,       16, "Directories");
@@ -159,6 +161,11 @@ bool directory::store(object_g name, object_g value)
     int         delta   = 0;                    // Change in directory size
     directory_g thisdir = this;                 // Can move because of GC
 
+    // Memoized rewrites may depend on the value of variables, and cached
+    // stack renderings on the contents of this directory
+    equation::memo_purge();
+    stack::cache_purge();
+
     if (object_g existing = lookup(name))
     {
         // Replace an existing entry
@@ -303,6 +310,8 @@ size_t directory::purge(object_p ref)
 // ----------------------------------------------------------------------------
 {
     directory_g thisdir = this;
+    equation::memo_purge();
+    stack::cache_purge();
 
     if (object_g name = lookup(ref))
     {
@@ -48,6 +48,7 @@ typedef unsigned char byte;
 typedef unsigned uint;
 typedef std::vector<byte> bytes;
 typedef std::vector<int>  ints;
+typedef std::vector<uint32_t> offsets;
 
 int verbose = 0;
 int ascenderPct = 100;
@@ -128,6 +129,93 @@ T *calloc(size_t sz)
 }
 
 
+void emitData(FILE *output, cstring fontName, cstring kind, bytes &data)
+// ----------------------------------------------------------------------------
+//   Emit font data, with the type ID in symbolic form
+// ----------------------------------------------------------------------------
+//   The type is emitted as FONT_TYPE_ID(object::ID_xxx_font), so that the
+//   generated files remain valid when IDs are added before the font IDs.
+//   The two-byte encoding is checked by a static_assert.
+{
+    size_t size = data.size();
+    fprintf(output,
+            "extern const unsigned char %s_%s_font_data[];\n"
+            "static_assert(object::ID_%s_font >= 0x80 &&\n"
+            "              object::ID_%s_font < 0x4000,\n"
+            "              \"Font type ID must be encoded on two bytes\");\n"
+            "const unsigned char %s_%s_font_data[%zu] FONT_QSPI =\n"
+            "{\n"
+            "\n"
+            "    FONT_TYPE_ID(object::ID_%s_font),",
+            fontName, kind, kind, kind, fontName, kind, size, kind);
+    for (uint b = 2; b < size; b++)
+        fprintf(output, "%s0x%02X,",
+                b % 16 == 0 ? "\n    " : " ",
+                data[b]);
+    fprintf(output, "\n};\n");
+}
+
+
+void emitOffsets(FILE   *output,
+                 cstring fontName,
+                 cstring kind,
+                 ints   &rangesFirst,
+                 ints   &rangesCount,
+                 offsets &glyphs)
+// ----------------------------------------------------------------------------
+//   Emit the offsets table used for direct access to glyphs
+// ----------------------------------------------------------------------------
+{
+    uint numRanges = rangesFirst.size();
+    uint numGlyphs = glyphs.size();
+
+    fprintf(output,
+            "\n"
+            "static const font_offsets::range %s_%s_font_ranges[%u] FONT_QSPI ="
+            "\n{\n",
+            fontName, kind, numRanges);
+    uint index = 0;
+    for (uint r = 0; r < numRanges; r++)
+    {
+        // font_offsets::range stores code points and counts on 16 bits
+        if (rangesFirst[r] + rangesCount[r] > 0x10000)
+        {
+            fprintf(stderr,
+                    "Glyph range 0x%04X..0x%04X is beyond 0xFFFF, "
+                    "unsupported in font offsets\n",
+                    rangesFirst[r], rangesFirst[r] + rangesCount[r] - 1);
+            exit(1);
+        }
+        fprintf(output, "    { %u, %u, %u },\n",
+                rangesFirst[r], rangesCount[r], index);
+        index += rangesCount[r];
+    }
+    fprintf(output, "};\n");
+
+    fprintf(output,
+            "\n"
+            "static const uint32_t %s_%s_font_glyphs[%u] FONT_QSPI =\n"
+            "{",
+            fontName, kind, numGlyphs);
+    for (uint g = 0; g < numGlyphs; g++)
+        fprintf(output, "%s%u,", g % 8 == 0 ? "\n    " : " ", glyphs[g]);
+    fprintf(output, "\n};\n");
+
+    fprintf(output,
+            "\n"
+            "extern const font_offsets %s_%s_font_offsets;\n"
+            "const font_offsets %s_%s_font_offsets =\n"
+            "{\n"
+            "    %s_%s_font_ranges, %u,\n"
+            "    %s_%s_font_glyphs, %u\n"
+            "};\n",
+            fontName, kind,
+            fontName, kind,
+            fontName, kind, numRanges,
+            fontName, kind, numGlyphs);
+}
+
+
 void processFont(cstring fontName,
                  cstring ttfName,
                  cstring cSourceName,
@@ -174,9 +262,15 @@ void processFont(cstring fontName,
  *
  * The formats are designed to make it possible to store it efficiently as a
  * dynamic and moveable RPL object. The downside is that some linear scanning is
- * required when displaying characters. This is mitigated in the text display
- * code by keeping a cache for the current range, with the assumption that in
- * most cases, consecutive characters tend to be in the same range.
+ * required when displaying characters. For the built-in fonts, this is avoided
+ * by emitting a companion offsets table with fixed-width entries:
+ * - For each range, the first code point, number of code points, and index
+ *   of the first glyph in the glyph table
+ * - For each glyph, in the sparse format, the offset of the glyph data
+ *   (starting with its X offset) from the beginning of the font object
+ * - For each glyph, in the dense format, the X position in the bitmap,
+ *   followed by a final entry with the total width of glyphs.
+ * Other fonts rely on a cache of glyph metrics in the text display code.
  *
  * The tool computes the total size of font data in either case, to let you pick
  * the representation that uses the least data.
@@ -318,6 +412,10 @@ void processFont(cstring fontName,
     ints     rangesFirst;
     ints     rangesCount;
 
+    // Offsets of each glyph for direct access
+    offsets  sparseOffsets;
+    offsets  denseOffsets;
+
     // Loop on all glyphs
     for (uint g = 0; g < glyphCount; g++)
     {
@@ -368,6 +466,9 @@ void processFont(cstring fontName,
         // Loop on all glyphs in range
         for (uint g = firstCode; g < lastCode; g++)
         {
+            sparseOffsets.push_back(sparse.size());
+            denseOffsets.push_back(denseBitMapX);
+
             FT_ULong charCode   = charCodes[glyph++];
             FT_UInt  glyphIndex = FT_Get_Char_Index(face, charCode);
             if (glyphIndex == 0)
@@ -522,6 +623,9 @@ void processFont(cstring fontName,
         } // Loop on codes
     } // Loop on ranges
 
+    // Final dense entry gives the width of the last glyph
+    denseOffsets.push_back(denseBitMapX);
+
     // Insert terminating 0 code point to mark end of ranges
     dense += 0;
     dense += 0;
@@ -550,6 +654,8 @@ void processFont(cstring fontName,
     sparseHeader += unsigned(ID_sparse_font);
     sparseHeader += sparse.size();
     sparse.insert(sparse.begin(), sparseHeader.begin(), sparseHeader.end());
+    for (uint32_t &offset : sparseOffsets)
+        offset += sparseHeader.size();
 
     bytes denseHeader;
     denseHeader.clear();
@@ -574,36 +680,16 @@ void processFont(cstring fontName,
 
     if (denseSize < sparseSize || verbose)
     {
-        fprintf(output,
-                "extern const unsigned char %s_dense_font_data[];\n",
-                fontName);
-        fprintf(output,
-                "const unsigned char %s_dense_font_data[%zu] FONT_QSPI =\n"
-                "{\n",
-                fontName, denseSize);
-
-            for (uint b = 0; b < denseSize; b++)
-                fprintf(output, "%s0x%02X,",
-                        b % 16 == 0 ? "\n    " : " ",
-                        dense[b]);
-            fprintf(output, "\n};\n");
+        emitData(output, fontName, "dense", dense);
+        emitOffsets(output, fontName, "dense",
+                    rangesFirst, rangesCount, denseOffsets);
     }
 
     if (sparseSize <= denseSize || verbose)
     {
-        fprintf(output,
-                "extern const unsigned char %s_sparse_font_data[];\n",
-                fontName);
-        fprintf(output,
-                "const unsigned char %s_sparse_font_data[%zu] FONT_QSPI =\n"
-                "{\n",
-                fontName, sparseSize);
-
-            for (uint b = 0; b < sparseSize; b++)
-                fprintf(output, "%s0x%02X,",
-                        b % 16 == 0 ? "\n    " : " ",
-                        sparse[b]);
-            fprintf(output, "\n};\n");
+        emitData(output, fontName, "sparse", sparse);
+        emitOffsets(output, fontName, "sparse",
+                    rangesFirst, rangesCount, sparseOffsets);
     }
 
     fclose(output);